@@ -24,6 +24,8 @@
  */
 
 #include <cstdlib>
+#include <cmath>
+#include <algorithm>
 #include <fstream>
 
 #include <boost/test/unit_test.hpp>
@@ -81,4 +83,33 @@ namespace mapp{
         delete [] ref_rhs;
         delete [] ref_d;
     }
+
+    /** helper to compare the data of two runs */
+    void helper_check_data(std::string const& name, std::string const& reference, std::string const& path){
+        NrnThread * nt = (NrnThread *) storage_get (name.c_str(),
+                                                    make_nrnthread, (void*)path.c_str(), free_nrnthread);
+        NrnThread * ref = (NrnThread *) storage_get (reference.c_str(),
+                                                     make_nrnthread, (void*)path.c_str(), free_nrnthread);
+
+        BOOST_REQUIRE_EQUAL(nt->_ndata, ref->_ndata);
+        BOOST_REQUIRE_EQUAL(nt->nmech, ref->nmech);
+
+        for(int m=0; m < nt->nmech; ++m){
+            const Mechanism& ml = nt->ml[m];
+            const double* data = ml.data;
+            const double* ref_data = ref->ml[m].data;
+            int mismatch = 0;
+            for(int i=0; i < ml.szp*ml.nodecount; ++i)
+                if(std::fabs(data[i] - ref_data[i]) > 1e-10*std::max(1., std::fabs(ref_data[i])))
+                    ++mismatch;
+            BOOST_CHECK_MESSAGE(mismatch == 0, "mechanism type " << ml.type << ": "
+                                << mismatch << " entries differ");
+        }
+
+        int mismatch = 0;
+        for(int i=0; i < nt->_ndata; ++i)
+            if(std::fabs(nt->_data[i] - ref->_data[i]) > 1e-10*std::max(1., std::fabs(ref->_data[i])))
+                ++mismatch;
+        BOOST_CHECK_MESSAGE(mismatch == 0, "_data: " << mismatch << " entries differ");
+    }
 }
@@ -56,6 +56,9 @@ namespace mapp{
 
     /** helper to compare to debug solution */
     void helper_check(std::string const& name, std::string const& mechanism, std::string const& path);
+
+    /** helper to compare the data of every mechanism, and all of _data, to another run */
+    void helper_check_data(std::string const& name, std::string const& reference, std::string const& path);
 }
 
 #endif
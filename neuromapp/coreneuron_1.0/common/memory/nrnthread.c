@@ -48,8 +48,15 @@ int nrnthread_dealloc(NrnThread *nt) {
     free(nt->_v_parent_index);
     nt->_v_parent_index = NULL;
 
+    free(nt->_permute);
+    nt->_permute = NULL;
+
     for (i=nt->nmech-1; i>=0; --i) {
         Mechanism *ml = &nt->ml[i];
+        if (ml->block)
+            free(ml->data);
+        ml->data = NULL;
+
         free(ml->pdata);
         ml->pdata = NULL;
 
@@ -80,6 +87,7 @@ int nrnthread_copy(const NrnThread *p, NrnThread *nt){
     int ne;
 
     nt->_dt = p->_dt;
+    nt->_t = p->_t;
     nt->_ndata = p->_ndata;
 
     nt->_data = memcpy_align(p->_data, 64, sizeof(double) * nt->_ndata);
@@ -116,6 +124,13 @@ int nrnthread_copy(const NrnThread *p, NrnThread *nt){
         ml->data = nt->_data + offset;
         offset += ml->nodecount * ml->szp;
 
+        if (pml->block) {
+            ml->block = pml->block;
+            ml->soa_data = ml->data;
+            ml->data = memcpy_align(pml->data, NRN_SOA_BYTE_ALIGN, sizeof(double) *
+                                    soa_padded_size(ml->block, ml->nodecount, 0) * ml->szp);
+        }
+
         if ( nt->max_nodecount < ml->nodecount_pad)
             nt->max_nodecount = ml->nodecount_pad;
 
@@ -132,6 +147,11 @@ int nrnthread_copy(const NrnThread *p, NrnThread *nt){
     /* parent indexes for linear algebra */
     nt->_v_parent_index=memcpy_align(p->_v_parent_index, NRN_SOA_BYTE_ALIGN, sizeof(int) * ne);
 
+    /* renumbering of the compartments, if any */
+    nt->_permute = NULL;
+    if (p->_permute)
+        nt->_permute = memcpy_align(p->_permute, NRN_SOA_BYTE_ALIGN, sizeof(int) * p->end);
+
     /* no of cells in the dataset */
     nt->ncell = p->ncell;
 
@@ -141,6 +161,73 @@ int nrnthread_copy(const NrnThread *p, NrnThread *nt){
     return MAPP_OK;
 }
 
+int mechanism_block(Mechanism *ml, int block) {
+    int i, k, n = ml->nodecount, szp = ml->szp;
+    double *soa, *aosoa;
+
+    if (block != 0 && block != 4 && block != 8 && block != 16)
+        return MAPP_BAD_ARG;
+
+    if (ml->block == block)
+        return MAPP_OK;
+
+    /* always go through the SoA layout */
+    if (ml->block) {
+        soa = ml->soa_data;
+        aosoa = ml->data;
+        for (k=0; k<szp; ++k)
+            for (i=0; i<n; ++i)
+                soa[k*n + i] = aosoa[NRN_AOSOA_INDEX(k, i, ml->block, szp)];
+        free(aosoa);
+        ml->data = soa;
+        ml->soa_data = NULL;
+        ml->block = 0;
+    }
+
+    if (block) {
+        soa = ml->data;
+        aosoa = (double*)ecalloc_align(soa_padded_size(block, n, 0) * szp, NRN_SOA_BYTE_ALIGN, sizeof(double));
+        for (k=0; k<szp; ++k)
+            for (i=0; i<n; ++i)
+                aosoa[NRN_AOSOA_INDEX(k, i, block, szp)] = soa[k*n + i];
+        ml->soa_data = soa;
+        ml->data = aosoa;
+        ml->block = block;
+    }
+
+    return MAPP_OK;
+}
+
+/** /brief Whether the pdata of another mechanism point in the data of ml (the ions) */
+static int mechanism_referenced(const NrnThread *nt, int m) {
+    const Mechanism *ml = &nt->ml[m];
+    const long begin = (ml->block ? ml->soa_data : ml->data) - nt->_data;
+    const long end = begin + (long)ml->szp * ml->nodecount;
+    int i, j;
+    for (j=0; j<nt->nmech; ++j) {
+        const Mechanism *other = &nt->ml[j];
+        if (j == m || other->pdata == NULL)
+            continue;
+        for (i=0; i<other->nodecount_pad*other->szdp; ++i)
+            if (other->pdata[i] >= begin && other->pdata[i] < end)
+                return 1;
+    }
+    return 0;
+}
+
+int nrnthread_block(NrnThread *nt, int block) {
+    int i, error;
+    for (i=0; i<nt->nmech; ++i) {
+        /* the kernels write the ions through pdata, in the SoA layout */
+        if (block && mechanism_referenced(nt, i))
+            continue;
+        error = mechanism_block(&nt->ml[i], block);
+        if (error != MAPP_OK)
+            return error;
+    }
+    return MAPP_OK;
+}
+
 /** /brief Scan and discard up to and including next newline. */
 static void skip_line(FILE *hFile) {
     int c;
@@ -194,6 +281,7 @@ int nrnthread_read(FILE *hFile, NrnThread *nt) {
         return MAPP_BAD_DATA; // the input does not exists stop;
 
     nt->_dt = 0.025;
+    nt->_t = 0.;
 
     fscanf(hFile, "%d\n", &nt->_ndata);
     nt->_data =  (double*)ecalloc_align(nt->_ndata, NRN_SOA_BYTE_ALIGN, sizeof(double));
@@ -247,6 +335,7 @@ int nrnthread_read(FILE *hFile, NrnThread *nt) {
     /* parent indexes for linear algebra */
     nt->_v_parent_index = (int*)ecalloc_align(ne, NRN_SOA_BYTE_ALIGN, sizeof(int));;
     read_nrnthread_iarray(hFile, nt->_v_parent_index, ne);
+    nt->_permute = NULL;
 
     /* no of cells in the dataset */
     fscanf(hFile, "%d\n", &nt->ncell);
@@ -262,6 +351,10 @@ int nrnthread_write(FILE *hFile, const NrnThread *nt) {
     long int offset;
     int ne;
 
+    for (i=0; i<nt->nmech; i++)
+        if (nt->ml[i].block)
+            return MAPP_BAD_DATA; // only the SoA layout is serialized
+
     fprintf(hFile, "%d\n", nt->_ndata);
     write_nrnthread_darray(hFile, nt->_data, nt->_ndata);
 
@@ -290,4 +383,200 @@ int nrnthread_write(FILE *hFile, const NrnThread *nt) {
   return MAPP_OK;
 }
 
+/** /brief Fixed size header of the binary NrnThread format */
+typedef struct nrnthread_binary_header {
+    char magic[8];
+    int version;
+    int _ndata;
+    int end;
+    int end_pad;
+    int nmech;
+    int ncell;
+    double _dt;
+} nrnthread_binary_header;
+
+/** /brief Read n elements of the given size, return non-zero if the file is truncated */
+static int read_binary_array(FILE *hFile, void *data, size_t size, size_t n) {
+    return fread(data, size, n, hFile) != n;
+}
+
+/** /brief Number of bytes between the position and the end of the file, -1 if unknown */
+static long binary_remaining(FILE *hFile) {
+    long pos = ftell(hFile);
+    long end;
+    if (pos < 0 || fseek(hFile, 0, SEEK_END) != 0)
+        return -1;
+    end = ftell(hFile);
+    fseek(hFile, pos, SEEK_SET);
+    return end - pos;
+}
+
+/** /brief Non-zero if n elements of the given size do not fit in the rest of the file */
+static int binary_exceeds(FILE *hFile, long long size, long long n) {
+    return n < 0 || size*n > binary_remaining(hFile);
+}
+
+int nrnthread_is_binary(FILE *hFile) {
+    char magic[8];
+    long pos;
+    size_t n;
+
+    if (!hFile)
+        return 0;
+
+    pos = ftell(hFile);
+    n = fread(magic, 1, sizeof(magic), hFile);
+    fseek(hFile, pos, SEEK_SET);
+
+    return (n == sizeof(magic)) && (memcmp(magic, NRN_BINARY_MAGIC, sizeof(magic)) == 0);
+}
+
+int nrnthread_read_binary(FILE *hFile, NrnThread *nt) {
+    int i;
+    long int offset;
+    int ne;
+    int error = 0;
+    nrnthread_binary_header h;
+
+    if (!hFile)
+        return MAPP_BAD_DATA;
+
+    memset(nt, 0, sizeof(NrnThread));
+
+    if (read_binary_array(hFile, &h, sizeof(h), 1))
+        return MAPP_BAD_DATA;
+
+    if (memcmp(h.magic, NRN_BINARY_MAGIC, sizeof(h.magic)) != 0 || h.version != NRN_BINARY_VERSION)
+        return MAPP_BAD_DATA;
+
+    /* the sizes of a truncated or foreign file must not reach the allocations */
+    if (h.end < 0 || h.end_pad < h.end || h.nmech < 0 || h.ncell < 0
+        || 6LL*h.end_pad > h._ndata
+        || binary_exceeds(hFile, sizeof(double), h._ndata)
+        || binary_exceeds(hFile, 6*sizeof(int) + sizeof(long), h.nmech))
+        return MAPP_BAD_DATA;
+
+    nt->_dt = h._dt;
+    nt->_ndata = h._ndata;
+    nt->end = h.end;
+    nt->end_pad = h.end_pad;
+    nt->nmech = h.nmech;
+    nt->ncell = h.ncell;
+
+    nt->_data = (double*)ecalloc_align(nt->_ndata, NRN_SOA_BYTE_ALIGN, sizeof(double));
+    error |= read_binary_array(hFile, nt->_data, sizeof(double), nt->_ndata);
+
+    ne = nt->end_pad;
+
+    nt->_actual_rhs = nt->_data + 0*ne;
+    nt->_actual_d = nt->_data + 1*ne;
+    nt->_actual_a = nt->_data + 2*ne;
+    nt->_actual_b = nt->_data + 3*ne;
+    nt->_actual_v = nt->_data + 4*ne;
+    nt->_actual_area = nt->_data + 5*ne;
+
+    offset = 6*ne;
+
+    nt->ml = (Mechanism *)ecalloc_align(nt->nmech, NRN_SOA_BYTE_ALIGN, sizeof(Mechanism));
+    nt->max_nodecount = 0;
+
+    for (i=0; i<nt->nmech && !error; i++) {
+        Mechanism *ml = &nt->ml[i];
+        int meta[6];
+
+        error |= read_binary_array(hFile, meta, sizeof(int), 6);
+        error |= read_binary_array(hFile, &ml->offset, sizeof(long), 1);
+        if (error)
+            break;
+        ml->type = meta[0];
+        ml->is_art = meta[1];
+        ml->nodecount = meta[2];
+        ml->nodecount_pad = meta[3];
+        ml->szp = meta[4];
+        ml->szdp = meta[5];
+
+        /* the data of the mechanism in _data, its indices in the rest of the file */
+        if (ml->nodecount < 0 || ml->nodecount_pad < ml->nodecount || ml->szp < 0 || ml->szdp < 0
+            || offset + (long long)ml->nodecount_pad*ml->szp > nt->_ndata
+            || binary_exceeds(hFile, sizeof(int),
+                   (ml->is_art ? 0 : ml->nodecount_pad) + (long long)ml->nodecount_pad*ml->szdp)) {
+            error = 1;
+            break;
+        }
+
+        ml->data = nt->_data + offset;
+        offset += ml->nodecount_pad * ml->szp;
+
+        if ( nt->max_nodecount < ml->nodecount_pad)
+            nt->max_nodecount = ml->nodecount_pad;
+
+        if (!ml->is_art){
+            ml->nodeindices = (int*)ecalloc_align(ml->nodecount_pad, NRN_SOA_BYTE_ALIGN, sizeof(int));
+            error |= read_binary_array(hFile, ml->nodeindices, sizeof(int), ml->nodecount_pad);
+        }
+
+        if (ml->szdp){
+            ml->pdata = (int*)ecalloc_align(ml->nodecount_pad*ml->szdp, NRN_SOA_BYTE_ALIGN, sizeof(int));
+            error |= read_binary_array(hFile, ml->pdata, sizeof(int), ml->nodecount_pad*ml->szdp);
+        }
+    }
+
+    if (error)
+        return MAPP_BAD_DATA;
+
+    /* parent indexes for linear algebra */
+    if (binary_exceeds(hFile, sizeof(int), ne))
+        return MAPP_BAD_DATA;
+    nt->_v_parent_index = (int*)ecalloc_align(ne, NRN_SOA_BYTE_ALIGN, sizeof(int));
+    error |= read_binary_array(hFile, nt->_v_parent_index, sizeof(int), ne);
+
+    nt->_shadow_rhs = (double*)ecalloc_align(nrn_soa_padded_size(nt->max_nodecount,0),NRN_SOA_BYTE_ALIGN, sizeof(double));
+    nt->_shadow_d = (double*)ecalloc_align(nrn_soa_padded_size(nt->max_nodecount,0),NRN_SOA_BYTE_ALIGN, sizeof(double));
+
+    return error ? MAPP_BAD_DATA : MAPP_OK;
+}
+
+int nrnthread_write_binary(FILE *hFile, const NrnThread *nt) {
+    int i;
+    int error = 0;
+    nrnthread_binary_header h;
+
+    if (!hFile)
+        return MAPP_BAD_DATA;
+
+    for (i=0; i<nt->nmech; i++)
+        if (nt->ml[i].block)
+            return MAPP_BAD_DATA; // only the SoA layout is serialized
 
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, NRN_BINARY_MAGIC, sizeof(h.magic));
+    h.version = NRN_BINARY_VERSION;
+    h._ndata = nt->_ndata;
+    h.end = nt->end;
+    h.end_pad = nt->end_pad;
+    h.nmech = nt->nmech;
+    h.ncell = nt->ncell;
+    h._dt = nt->_dt;
+
+    error |= fwrite(&h, sizeof(h), 1, hFile) != 1;
+    error |= fwrite(nt->_data, sizeof(double), nt->_ndata, hFile) != (size_t)nt->_ndata;
+
+    for (i=0; i<nt->nmech; i++) {
+        const Mechanism *ml = &nt->ml[i];
+        int meta[6] = {ml->type, ml->is_art, ml->nodecount, ml->nodecount_pad, ml->szp, ml->szdp};
+
+        error |= fwrite(meta, sizeof(int), 6, hFile) != 6;
+        error |= fwrite(&ml->offset, sizeof(long), 1, hFile) != 1;
+
+        if (!ml->is_art)
+            error |= fwrite(ml->nodeindices, sizeof(int), ml->nodecount_pad, hFile) != (size_t)ml->nodecount_pad;
+
+        if (ml->szdp)
+            error |= fwrite(ml->pdata, sizeof(int), ml->nodecount_pad*ml->szdp, hFile)
+                     != (size_t)(ml->nodecount_pad*ml->szdp);
+    }
+
+    error |= fwrite(nt->_v_parent_index, sizeof(int), nt->end_pad, hFile) != (size_t)nt->end_pad;
+
+    return error ? MAPP_BAD_DATA : MAPP_OK;
+}
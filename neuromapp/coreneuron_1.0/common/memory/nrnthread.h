@@ -51,8 +51,17 @@ typedef struct Mechanism {
     /** Data of the channels */
     double *data;
     int *nodeindices;
+    /** 0 for the SoA layout, else number of instances per block of the AoSoA layout,
+        see nrnthread_block() */
+    int block;
+    /** SoA location of the data inside NrnThread::_data while the mechanism is blocked */
+    double *soa_data;
 } Mechanism;
 
+/** Position of the variable var of the instance i in the AoSoA layout, the blocks
+    store the szp variables of block consecutive instances */
+#define NRN_AOSOA_INDEX(var, i, block, szp) (((i)/(block))*(block)*(szp) + (var)*(block) + (i)%(block))
+
 /** \struct NrnThread
  *  \brief A dataset representing a group of cells, their compartments, mechanisms, etc,
  */
@@ -93,6 +102,8 @@ typedef struct NrnThread {
     Mechanism *ml;
     /** indexing of neuroni for linear algebra */
     int* _v_parent_index;
+    /** new index of the original compartment i, NULL if not renumbered, see nrnthread_permute() */
+    int* _permute;
 } NrnThread;
 
 /** \brief Construct NrnThread from file.
@@ -114,6 +125,53 @@ int nrnthread_read(FILE *fh, NrnThread *nt);
  */
 int nrnthread_write(FILE *fh, const NrnThread *nt);
 
+/** Magic string at the beginning of a binary NrnThread file */
+#define NRN_BINARY_MAGIC "NRNTHBIN"
+/** Version of the binary NrnThread format, bump it when the layout changes */
+#define NRN_BINARY_VERSION 1
+
+/** \brief Check whether a file holds a binary NrnThread dataset.
+ *  \param fh File handle, the position is restored after the check.
+ *  \return 1 if the file starts with NRN_BINARY_MAGIC, 0 otherwise.
+ */
+int nrnthread_is_binary(FILE *fh);
+
+/** \brief Construct NrnThread from a binary file.
+ *  \param fh File handle used for reading.
+ *  \param nt NrnThread structure to write to.
+ *  \return non-zero on error (bad magic, version or truncated file).
+ *
+ *  Every array is read with a single fread directly into its
+ *  NRN_SOA_BYTE_ALIGN aligned buffer, no parsing is involved.
+ *  The resulting NrnThread should be destroyed with nrnthread_dealloc().
+ */
+int nrnthread_read_binary(FILE *fh, NrnThread *nt);
+
+/** \brief Serialise NrnThread to a binary file.
+ *  \param fh File handle used for writing.
+ *  \param nt NrnThread structure to write.
+ *  \return non-zero on error.
+ *
+ *  The serialized data can be read with nrnthread_read_binary().
+ */
+int nrnthread_write_binary(FILE *fh, const NrnThread *nt);
+
+/** \brief Change the layout of the data of every mechanism.
+ *  \param nt The NrnThread object to transform.
+ *  \param block 4, 8 or 16 for the AoSoA layout with blocks of block instances,
+ *  0 to come back to the SoA layout.
+ *  \return MAPP_BAD_ARG for another block size, MAPP_OK otherwise.
+ *
+ *  The blocked data are allocated apart from _data (the last block is padded), the
+ *  SoA location is kept to transpose back. The writers only accept the SoA layout.
+ *  The mechanisms reached through the pdata of another mechanism (the ions) stay in
+ *  the SoA layout, pdata are offsets in _data.
+ */
+int nrnthread_block(NrnThread *nt, int block);
+
+/** \brief Change the layout of the data of a single mechanism, see nrnthread_block(). */
+int mechanism_block(Mechanism *ml, int block);
+
 /** \brief Copy NrnThread data to new NrnThread.
  *  \param p The NenThread object to copy.
  *  \param nt The target NrnThread.
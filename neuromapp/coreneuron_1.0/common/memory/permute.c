@@ -0,0 +1,261 @@
+/*
+ * Neuromapp - permute.c, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/common/memory/permute.c
+ * \brief Implements the cache-aware renumbering of the compartments of a NrnThread
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "coreneuron_1.0/common/memory/permute.h"
+#include "coreneuron_1.0/common/memory/memory.h"
+#include "coreneuron_1.0/common/util/simd.h"
+#include "utils/error.h"
+
+/** /brief Children of every node in increasing index, CSR like */
+static void build_children(const NrnThread *nt, int *first, int *children) {
+    int i, *pos;
+    const int *parent = nt->_v_parent_index;
+
+    memset(first, 0, sizeof(int) * (nt->end + 1));
+    for (i = nt->ncell; i < nt->end; ++i)
+        first[parent[i]+1]++;
+    for (i = 0; i < nt->end; ++i)
+        first[i+1] += first[i];
+
+    pos = (int *)malloc(sizeof(int) * nt->end);
+    memcpy(pos, first, sizeof(int) * nt->end);
+    for (i = nt->ncell; i < nt->end; ++i)
+        children[pos[parent[i]]++] = i;
+    free(pos);
+}
+
+/** /brief perm[old] = new, depth first inside every cell, the cells one after the other */
+static void permutation_cell(const NrnThread *nt, const int *first, const int *children, int *perm) {
+    int i, c, top, next = nt->ncell;
+    int *stack = (int *)malloc(sizeof(int) * nt->end);
+
+    for (c = 0; c < nt->ncell; ++c) {
+        perm[c] = c;
+        top = 0;
+        /* push the children reversed, the first child is numbered first */
+        for (i = first[c+1] - 1; i >= first[c]; --i)
+            stack[top++] = children[i];
+        while (top > 0) {
+            int node = stack[--top];
+            perm[node] = next++;
+            for (i = first[node+1] - 1; i >= first[node]; --i)
+                stack[top++] = children[i];
+        }
+    }
+    free(stack);
+}
+
+/** /brief perm[old] = new, breadth first from all the roots, the cells are interleaved */
+static void permutation_interleave(const NrnThread *nt, const int *first, const int *children, int *perm) {
+    int i, head = 0, tail = 0;
+    int *queue = (int *)malloc(sizeof(int) * nt->end);
+
+    for (i = 0; i < nt->ncell; ++i)
+        queue[tail++] = i;
+    while (head < tail) {
+        int node = queue[head];
+        perm[node] = head++;
+        for (i = first[node]; i < first[node+1]; ++i)
+            queue[tail++] = children[i];
+    }
+    free(queue);
+}
+
+/** /brief perm[old] = new, the cells are grouped by MAPP_SIMD_WIDTH (see nrnthread_cells), inside a
+    group the k-th compartments of the cells are consecutive, the holes of the short cells are skipped */
+static void permutation_lane(const NrnThread *nt, int *perm) {
+    int i, c, g, k, j, next = nt->ncell;
+    int w = MAPP_SIMD_WIDTH;
+    int *cell = (int *)malloc(sizeof(int) * nt->end);
+    int *order = (int *)malloc(sizeof(int) * nt->ncell);
+    int *first = (int *)calloc(nt->ncell + 1, sizeof(int));
+    int *nodes = (int *)malloc(sizeof(int) * nt->end);
+    int *pos = (int *)malloc(sizeof(int) * nt->ncell);
+
+    nrnthread_cells(nt, cell, order);
+
+    /* compartments of every cell in increasing index, the root first */
+    for (i = 0; i < nt->end; ++i)
+        first[cell[i]+1]++;
+    for (c = 0; c < nt->ncell; ++c)
+        first[c+1] += first[c];
+    memcpy(pos, first, sizeof(int) * nt->ncell);
+    for (i = 0; i < nt->end; ++i)
+        nodes[pos[cell[i]]++] = i;
+
+    for (c = 0; c < nt->ncell; ++c)
+        perm[c] = c;
+    for (g = 0; g < nt->ncell; g += w) {
+        int rows = first[order[g]+1] - first[order[g]];
+        for (k = 1; k < rows; ++k)
+            for (j = g; j < g + w && j < nt->ncell; ++j)
+                if (k < first[order[j]+1] - first[order[j]])
+                    perm[nodes[first[order[j]] + k]] = next++;
+    }
+
+    free(pos);
+    free(nodes);
+    free(first);
+    free(order);
+    free(cell);
+}
+
+/** /brief The slot 0 of pdata is the area of the point processes, pointer in the area column */
+static int is_area_pointer(const NrnThread *nt, const Mechanism *ml) {
+    int i, area = 5*nt->end_pad;
+    if (ml->is_art || ml->szdp == 0)
+        return 0;
+    for (i = 0; i < ml->nodecount; ++i)
+        if (ml->pdata[i] < area || ml->pdata[i] >= area + nt->end)
+            return 0;
+    return 1;
+}
+
+/** /brief Apply perm[old] = new to all the node based data */
+static void apply_permutation(NrnThread *nt, const int *perm) {
+    int i, k, ne = nt->end_pad, n = nt->end;
+    double *tmp = (double *)malloc(sizeof(double) * n);
+    int *parent = (int *)malloc(sizeof(int) * n);
+
+    /* rhs, d, a, b, v, area */
+    for (k = 0; k < 6; ++k) {
+        double *column = nt->_data + k*ne;
+        memcpy(tmp, column, sizeof(double) * n);
+        for (i = 0; i < n; ++i)
+            column[perm[i]] = tmp[i];
+    }
+
+    memcpy(parent, nt->_v_parent_index, sizeof(int) * n);
+    for (i = nt->ncell; i < n; ++i)
+        nt->_v_parent_index[perm[i]] = perm[parent[i]];
+
+    for (k = 0; k < nt->nmech; ++k) {
+        Mechanism *ml = &nt->ml[k];
+        if (ml->is_art)
+            continue;
+        if (is_area_pointer(nt, ml))
+            for (i = 0; i < ml->nodecount; ++i)
+                ml->pdata[i] = 5*ne + perm[ml->pdata[i] - 5*ne];
+        for (i = 0; i < ml->nodecount; ++i)
+            ml->nodeindices[i] = perm[ml->nodeindices[i]];
+    }
+
+    free(parent);
+    free(tmp);
+}
+
+int nrnthread_permute(NrnThread *nt, int kind) {
+    int *first, *children, *perm;
+
+    if (kind != NRN_PERMUTE_NONE && kind != NRN_PERMUTE_CELL && kind != NRN_PERMUTE_INTERLEAVE
+        && kind != NRN_PERMUTE_LANE)
+        return MAPP_BAD_ARG;
+
+    nrnthread_unpermute(nt);
+    if (kind == NRN_PERMUTE_NONE)
+        return MAPP_OK;
+
+    first = (int *)malloc(sizeof(int) * (nt->end + 1));
+    children = (int *)malloc(sizeof(int) * nt->end);
+    perm = (int *)ecalloc_align(nt->end, NRN_SOA_BYTE_ALIGN, sizeof(int));
+
+    build_children(nt, first, children);
+    if (kind == NRN_PERMUTE_CELL)
+        permutation_cell(nt, first, children, perm);
+    else if (kind == NRN_PERMUTE_INTERLEAVE)
+        permutation_interleave(nt, first, children, perm);
+    else
+        permutation_lane(nt, perm);
+
+    apply_permutation(nt, perm);
+    nt->_permute = perm;
+
+    free(children);
+    free(first);
+    return MAPP_OK;
+}
+
+int nrnthread_unpermute(NrnThread *nt) {
+    int i;
+    int *inverse;
+
+    if (nt->_permute == NULL)
+        return MAPP_OK;
+
+    inverse = (int *)malloc(sizeof(int) * nt->end);
+    for (i = 0; i < nt->end; ++i)
+        inverse[nt->_permute[i]] = i;
+    apply_permutation(nt, inverse);
+
+    free(inverse);
+    free(nt->_permute);
+    nt->_permute = NULL;
+    return MAPP_OK;
+}
+
+/** /brief Increasing keys */
+static int compare_key(const void *a, const void *b) {
+    long ka = *(const long *)a, kb = *(const long *)b;
+    return (ka > kb) - (ka < kb);
+}
+
+void nrnthread_cells(const NrnThread *nt, int *cell, int *order) {
+    int i;
+    int *size = (int *)calloc(nt->ncell, sizeof(int));
+    long *key = (long *)malloc(sizeof(long) * nt->ncell);
+
+    /* a parent is always numbered before its children */
+    for (i = 0; i < nt->ncell; ++i)
+        cell[i] = i;
+    for (i = nt->ncell; i < nt->end; ++i)
+        cell[i] = cell[nt->_v_parent_index[i]];
+
+    for (i = 0; i < nt->end; ++i)
+        size[cell[i]]++;
+    /* decreasing size, the index for the ties */
+    for (i = 0; i < nt->ncell; ++i)
+        key[i] = (long)(nt->end - size[i]) * nt->ncell + i;
+    qsort(key, nt->ncell, sizeof(long), compare_key);
+    for (i = 0; i < nt->ncell; ++i)
+        order[i] = (int)(key[i] % nt->ncell);
+
+    free(key);
+    free(size);
+}
+
+int nrnthread_permute_kind(const char *name) {
+    if (strcmp(name, "none") == 0)
+        return NRN_PERMUTE_NONE;
+    if (strcmp(name, "cell") == 0)
+        return NRN_PERMUTE_CELL;
+    if (strcmp(name, "interleave") == 0)
+        return NRN_PERMUTE_INTERLEAVE;
+    if (strcmp(name, "lane") == 0)
+        return NRN_PERMUTE_LANE;
+    return -1;
+}
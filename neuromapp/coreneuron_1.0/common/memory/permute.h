@@ -0,0 +1,88 @@
+/*
+ * Neuromapp - permute.h, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/common/memory/permute.h
+ * \brief Cache-aware renumbering of the compartments of a NrnThread
+ */
+
+#ifndef MAPP_PERMUTE_
+#define MAPP_PERMUTE_
+
+#include "coreneuron_1.0/common/memory/nrnthread.h"
+
+#ifdef __cplusplus
+     extern "C" {
+#endif
+
+/** \enum nrn_permutation
+ *  \brief The available renumbering of the compartments, the roots stay in [0, ncell)
+ *  and a parent is always numbered before its children
+ */
+enum nrn_permutation {
+    /** original numbering */
+    NRN_PERMUTE_NONE = 0,
+    /** the compartments of a cell are contiguous, depth first order */
+    NRN_PERMUTE_CELL = 1,
+    /** level order, the cells are interleaved inside a level */
+    NRN_PERMUTE_INTERLEAVE = 2,
+    /** groups of MAPP_SIMD_WIDTH cells of similar size, the compartments of the cells of a
+        group are interleaved, one cell per SIMD lane, see nrn_solve_cells() */
+    NRN_PERMUTE_LANE = 3
+};
+
+/** \fn nrnthread_permute(NrnThread *nt, int kind)
+    \brief Renumber the compartments of nt following kind (nrn_permutation).
+    The node columns of _data (rhs, d, a, b, v, area), _v_parent_index, the nodeindices of
+    every mechanism and the pdata pointing to the area column (point processes) are rewritten.
+    The children of a node keep their relative order, so the solver and the kernels give
+    exactly the same numbers. The permutation is kept in nt->_permute.
+    \param nt the data structure
+    \param kind the renumbering, a previous one is undone first
+    \return MAPP_BAD_ARG for an unknown kind, MAPP_OK otherwise
+ */
+int nrnthread_permute(NrnThread *nt, int kind);
+
+/** \fn nrnthread_unpermute(NrnThread *nt)
+    \brief Come back to the original numbering, e.g. before comparing or writing the output
+    \param nt the data structure
+    \return MAPP_OK
+ */
+int nrnthread_unpermute(NrnThread *nt);
+
+/** \fn nrnthread_cells(const NrnThread *nt, int *cell, int *order)
+    \brief Find the cell of every compartment and sort the cells by size
+    \param nt the data structure
+    \param cell the cell of the compartment i in cell[i], size nt->end
+    \param order the cells by decreasing number of compartments (ties by index), size nt->ncell
+ */
+void nrnthread_cells(const NrnThread *nt, int *cell, int *order);
+
+/** \fn nrnthread_permute_kind(const char *name)
+    \brief Convert "none", "cell", "interleave" or "lane" to nrn_permutation
+    \return the kind or -1 if the name is unknown
+ */
+int nrnthread_permute_kind(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
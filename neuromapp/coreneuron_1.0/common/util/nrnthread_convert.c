@@ -0,0 +1,65 @@
+/*
+ * Neuromapp - nrnthread_convert.c, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/common/util/nrnthread_convert.c
+ * \brief Convert a NrnThread dataset from the text to the binary format
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "coreneuron_1.0/common/memory/nrnthread.h"
+#include "coreneuron_1.0/common/util/nrnthread_handler.h"
+#include "utils/error.h"
+
+int main(int argc, char *argv[]) {
+    int error;
+    FILE *fh;
+    NrnThread *nt;
+
+    if (argc != 3) {
+        printf("Usage: nrnthread_convert [text input] [binary output]\n");
+        return MAPP_USAGE;
+    }
+
+    /* make_nrnthread accepts both formats, so a binary file is simply rewritten */
+    nt = (NrnThread *)make_nrnthread(argv[1]);
+    if (nt == NULL) {
+        printf("Error: unable to read %s\n", argv[1]);
+        return MAPP_BAD_DATA;
+    }
+
+    fh = fopen(argv[2], "wb");
+    if (!fh) {
+        printf("Error: unable to open %s\n", argv[2]);
+        free_nrnthread(nt);
+        return MAPP_BAD_DATA;
+    }
+
+    error = nrnthread_write_binary(fh, nt);
+    fclose(fh);
+    free_nrnthread(nt);
+
+    if (error != MAPP_OK)
+        printf("Error: unable to write %s\n", argv[2]);
+
+    return error;
+}
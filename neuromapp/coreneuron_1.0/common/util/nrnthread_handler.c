@@ -33,11 +33,15 @@
 
 void *make_nrnthread(void *filename) {
     int r;
-    FILE *fh = fopen((const char *)filename, "r");
+    FILE *fh = fopen((const char *)filename, "rb");
     if (!fh) return NULL;
 
     NrnThread *nt = malloc(sizeof(NrnThread));
-    r = nrnthread_read(fh, nt);
+    /* pick the format from the magic header, text otherwise */
+    if (nrnthread_is_binary(fh))
+        r = nrnthread_read_binary(fh, nt);
+    else
+        r = nrnthread_read(fh, nt);
     fclose(fh);
 
     if (r) { /* error in read */
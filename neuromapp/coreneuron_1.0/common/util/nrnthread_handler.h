@@ -40,7 +40,9 @@ extern "C" {
 
 /** \fn void *make_nrnthread(void *filename)
     \brief Allocate NrnThread object and load data from file
-    \param filename path (as void * context variable)
+    \param filename path (as void * context variable), the file can be
+           either in the text or in the binary format, it is detected
+           from the header
     \return Pointer to the constructed NrnThread object,
             or NULL on error.
 
@@ -0,0 +1,235 @@
+/*
+ * Neuromapp - simd.h, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/common/util/simd.h
+ * \brief Thin portable wrapper over the SIMD instruction sets used by the hand-vectorized kernels
+ *
+ * The backend is selected at compile time from the flags of the compiler
+ * (e.g. -march=native, -mavx2 or -mavx512f): AVX-512F (8 doubles), AVX2 (4 doubles),
+ * SSE2 (2 doubles) or plain scalar code (1 double). Every backend provides the
+ * same set of functions, the kernels are written once against mapp_simd_t.
+ * Loads and stores are unaligned, the chunks of the kernels start anywhere.
+ */
+
+#ifndef MAPP_SIMD_
+#define MAPP_SIMD_
+
+#include <stdint.h>
+
+#if defined(__AVX512F__)
+/* AVX-512F ------------------------------------------------------ */
+#include <immintrin.h>
+
+#define MAPP_SIMD_WIDTH 8
+#define MAPP_SIMD_NAME "AVX-512"
+
+typedef __m512d mapp_simd_t;
+typedef __m512i mapp_simd_int_t;
+
+static inline mapp_simd_t mapp_simd_set1(double a){ return _mm512_set1_pd(a); }
+static inline mapp_simd_t mapp_simd_load(const double* p){ return _mm512_loadu_pd(p); }
+static inline void mapp_simd_store(double* p, mapp_simd_t a){ _mm512_storeu_pd(p, a); }
+static inline mapp_simd_t mapp_simd_add(mapp_simd_t a, mapp_simd_t b){ return _mm512_add_pd(a, b); }
+static inline mapp_simd_t mapp_simd_sub(mapp_simd_t a, mapp_simd_t b){ return _mm512_sub_pd(a, b); }
+static inline mapp_simd_t mapp_simd_mul(mapp_simd_t a, mapp_simd_t b){ return _mm512_mul_pd(a, b); }
+static inline mapp_simd_t mapp_simd_div(mapp_simd_t a, mapp_simd_t b){ return _mm512_div_pd(a, b); }
+static inline mapp_simd_t mapp_simd_min(mapp_simd_t a, mapp_simd_t b){ return _mm512_min_pd(a, b); }
+static inline mapp_simd_t mapp_simd_max(mapp_simd_t a, mapp_simd_t b){ return _mm512_max_pd(a, b); }
+
+static inline mapp_simd_t mapp_simd_add_if_eq(mapp_simd_t a, double c, double delta){
+    __mmask8 m = _mm512_cmp_pd_mask(a, _mm512_set1_pd(c), _CMP_EQ_OQ);
+    return _mm512_mask_add_pd(a, m, a, _mm512_set1_pd(delta));
+}
+
+static inline mapp_simd_t mapp_simd_gather(const double* base, const int* idx){
+    return _mm512_i32gather_pd(_mm256_loadu_si256((const __m256i*)idx), base, 8);
+}
+
+static inline void mapp_simd_scatter(double* base, const int* idx, mapp_simd_t a){
+    _mm512_i32scatter_pd(base, _mm256_loadu_si256((const __m256i*)idx), a, 8);
+}
+
+static inline mapp_simd_int_t mapp_simd_cast_int(mapp_simd_t a){ return _mm512_castpd_si512(a); }
+static inline mapp_simd_t mapp_simd_cast_double(mapp_simd_int_t a){ return _mm512_castsi512_pd(a); }
+static inline mapp_simd_int_t mapp_simd_add_int(mapp_simd_int_t a, int64_t b){ return _mm512_add_epi64(a, _mm512_set1_epi64(b)); }
+static inline mapp_simd_int_t mapp_simd_shift_int(mapp_simd_int_t a, int b){ return _mm512_slli_epi64(a, b); }
+
+#elif defined(__AVX2__)
+/* AVX2 ---------------------------------------------------------- */
+#include <immintrin.h>
+
+#define MAPP_SIMD_WIDTH 4
+#define MAPP_SIMD_NAME "AVX2"
+
+typedef __m256d mapp_simd_t;
+typedef __m256i mapp_simd_int_t;
+
+static inline mapp_simd_t mapp_simd_set1(double a){ return _mm256_set1_pd(a); }
+static inline mapp_simd_t mapp_simd_load(const double* p){ return _mm256_loadu_pd(p); }
+static inline void mapp_simd_store(double* p, mapp_simd_t a){ _mm256_storeu_pd(p, a); }
+static inline mapp_simd_t mapp_simd_add(mapp_simd_t a, mapp_simd_t b){ return _mm256_add_pd(a, b); }
+static inline mapp_simd_t mapp_simd_sub(mapp_simd_t a, mapp_simd_t b){ return _mm256_sub_pd(a, b); }
+static inline mapp_simd_t mapp_simd_mul(mapp_simd_t a, mapp_simd_t b){ return _mm256_mul_pd(a, b); }
+static inline mapp_simd_t mapp_simd_div(mapp_simd_t a, mapp_simd_t b){ return _mm256_div_pd(a, b); }
+static inline mapp_simd_t mapp_simd_min(mapp_simd_t a, mapp_simd_t b){ return _mm256_min_pd(a, b); }
+static inline mapp_simd_t mapp_simd_max(mapp_simd_t a, mapp_simd_t b){ return _mm256_max_pd(a, b); }
+
+static inline mapp_simd_t mapp_simd_add_if_eq(mapp_simd_t a, double c, double delta){
+    __m256d m = _mm256_cmp_pd(a, _mm256_set1_pd(c), _CMP_EQ_OQ);
+    return _mm256_add_pd(a, _mm256_and_pd(m, _mm256_set1_pd(delta)));
+}
+
+static inline mapp_simd_t mapp_simd_gather(const double* base, const int* idx){
+    return _mm256_i32gather_pd(base, _mm_loadu_si128((const __m128i*)idx), 8);
+}
+
+/* no scatter instruction in AVX2 */
+static inline void mapp_simd_scatter(double* base, const int* idx, mapp_simd_t a){
+    double tmp[4];
+    _mm256_storeu_pd(tmp, a);
+    base[idx[0]] = tmp[0];
+    base[idx[1]] = tmp[1];
+    base[idx[2]] = tmp[2];
+    base[idx[3]] = tmp[3];
+}
+
+static inline mapp_simd_int_t mapp_simd_cast_int(mapp_simd_t a){ return _mm256_castpd_si256(a); }
+static inline mapp_simd_t mapp_simd_cast_double(mapp_simd_int_t a){ return _mm256_castsi256_pd(a); }
+static inline mapp_simd_int_t mapp_simd_add_int(mapp_simd_int_t a, int64_t b){ return _mm256_add_epi64(a, _mm256_set1_epi64x(b)); }
+static inline mapp_simd_int_t mapp_simd_shift_int(mapp_simd_int_t a, int b){ return _mm256_slli_epi64(a, b); }
+
+#elif defined(__SSE2__)
+/* SSE2 ---------------------------------------------------------- */
+#include <emmintrin.h>
+
+#define MAPP_SIMD_WIDTH 2
+#define MAPP_SIMD_NAME "SSE2"
+
+typedef __m128d mapp_simd_t;
+typedef __m128i mapp_simd_int_t;
+
+static inline mapp_simd_t mapp_simd_set1(double a){ return _mm_set1_pd(a); }
+static inline mapp_simd_t mapp_simd_load(const double* p){ return _mm_loadu_pd(p); }
+static inline void mapp_simd_store(double* p, mapp_simd_t a){ _mm_storeu_pd(p, a); }
+static inline mapp_simd_t mapp_simd_add(mapp_simd_t a, mapp_simd_t b){ return _mm_add_pd(a, b); }
+static inline mapp_simd_t mapp_simd_sub(mapp_simd_t a, mapp_simd_t b){ return _mm_sub_pd(a, b); }
+static inline mapp_simd_t mapp_simd_mul(mapp_simd_t a, mapp_simd_t b){ return _mm_mul_pd(a, b); }
+static inline mapp_simd_t mapp_simd_div(mapp_simd_t a, mapp_simd_t b){ return _mm_div_pd(a, b); }
+static inline mapp_simd_t mapp_simd_min(mapp_simd_t a, mapp_simd_t b){ return _mm_min_pd(a, b); }
+static inline mapp_simd_t mapp_simd_max(mapp_simd_t a, mapp_simd_t b){ return _mm_max_pd(a, b); }
+
+static inline mapp_simd_t mapp_simd_add_if_eq(mapp_simd_t a, double c, double delta){
+    __m128d m = _mm_cmpeq_pd(a, _mm_set1_pd(c));
+    return _mm_add_pd(a, _mm_and_pd(m, _mm_set1_pd(delta)));
+}
+
+/* no gather/scatter instruction in SSE2 */
+static inline mapp_simd_t mapp_simd_gather(const double* base, const int* idx){
+    return _mm_set_pd(base[idx[1]], base[idx[0]]);
+}
+
+static inline void mapp_simd_scatter(double* base, const int* idx, mapp_simd_t a){
+    _mm_storel_pd(&base[idx[0]], a);
+    _mm_storeh_pd(&base[idx[1]], a);
+}
+
+static inline mapp_simd_int_t mapp_simd_cast_int(mapp_simd_t a){ return _mm_castpd_si128(a); }
+static inline mapp_simd_t mapp_simd_cast_double(mapp_simd_int_t a){ return _mm_castsi128_pd(a); }
+static inline mapp_simd_int_t mapp_simd_add_int(mapp_simd_int_t a, int64_t b){ return _mm_add_epi64(a, _mm_set1_epi64x(b)); }
+static inline mapp_simd_int_t mapp_simd_shift_int(mapp_simd_int_t a, int b){ return _mm_slli_epi64(a, b); }
+
+#else
+/* scalar fallback ----------------------------------------------- */
+#define MAPP_SIMD_WIDTH 1
+#define MAPP_SIMD_NAME "scalar"
+
+typedef double mapp_simd_t;
+typedef uint64_t mapp_simd_int_t;
+
+static inline mapp_simd_t mapp_simd_set1(double a){ return a; }
+static inline mapp_simd_t mapp_simd_load(const double* p){ return *p; }
+static inline void mapp_simd_store(double* p, mapp_simd_t a){ *p = a; }
+static inline mapp_simd_t mapp_simd_add(mapp_simd_t a, mapp_simd_t b){ return a + b; }
+static inline mapp_simd_t mapp_simd_sub(mapp_simd_t a, mapp_simd_t b){ return a - b; }
+static inline mapp_simd_t mapp_simd_mul(mapp_simd_t a, mapp_simd_t b){ return a * b; }
+static inline mapp_simd_t mapp_simd_div(mapp_simd_t a, mapp_simd_t b){ return a / b; }
+static inline mapp_simd_t mapp_simd_min(mapp_simd_t a, mapp_simd_t b){ return a < b ? a : b; }
+static inline mapp_simd_t mapp_simd_max(mapp_simd_t a, mapp_simd_t b){ return a > b ? a : b; }
+static inline mapp_simd_t mapp_simd_add_if_eq(mapp_simd_t a, double c, double delta){ return a == c ? a + delta : a; }
+static inline mapp_simd_t mapp_simd_gather(const double* base, const int* idx){ return base[idx[0]]; }
+static inline void mapp_simd_scatter(double* base, const int* idx, mapp_simd_t a){ base[idx[0]] = a; }
+
+static inline mapp_simd_int_t mapp_simd_cast_int(mapp_simd_t a){
+    union { double d; uint64_t i; } u;
+    u.d = a;
+    return u.i;
+}
+
+static inline mapp_simd_t mapp_simd_cast_double(mapp_simd_int_t a){
+    union { double d; uint64_t i; } u;
+    u.i = a;
+    return u.d;
+}
+
+static inline mapp_simd_int_t mapp_simd_add_int(mapp_simd_int_t a, int64_t b){ return a + (uint64_t)b; }
+static inline mapp_simd_int_t mapp_simd_shift_int(mapp_simd_int_t a, int b){ return a << b; }
+
+#endif
+
+/** \fn mapp_simd_exp(mapp_simd_t x)
+    \brief vectorized exponential, Cephes range reduction and Pade approximant.
+    The relative error is below 1e-15 on the double range, the argument is clamped
+    to [-708, 709] so the result is never a denormal, an infinity or a NaN
+ */
+static inline mapp_simd_t mapp_simd_exp(mapp_simd_t x){
+    /* 1.5*2^52, x + magic rounds x to the nearest integer, stored in the low bits */
+    const double magic = 6755399441055744.0;
+    mapp_simd_t fx, r, rr, px, qx, t;
+    mapp_simd_int_t e;
+
+    x = mapp_simd_min(x, mapp_simd_set1(709.0));
+    x = mapp_simd_max(x, mapp_simd_set1(-708.0));
+
+    /* x = n*ln(2) + r, |r| <= ln(2)/2 */
+    t = mapp_simd_add(mapp_simd_mul(x, mapp_simd_set1(1.4426950408889634073599)), mapp_simd_set1(magic));
+    fx = mapp_simd_sub(t, mapp_simd_set1(magic));
+    r = mapp_simd_sub(x, mapp_simd_mul(fx, mapp_simd_set1(6.93145751953125E-1)));
+    r = mapp_simd_sub(r, mapp_simd_mul(fx, mapp_simd_set1(1.42860682030941723212E-6)));
+
+    /* exp(r) = 1 + 2r P(r^2)/(Q(r^2) - r P(r^2)) */
+    rr = mapp_simd_mul(r, r);
+    px = mapp_simd_set1(1.26177193074810590878E-4);
+    px = mapp_simd_add(mapp_simd_mul(px, rr), mapp_simd_set1(3.02994407707441961300E-2));
+    px = mapp_simd_add(mapp_simd_mul(px, rr), mapp_simd_set1(9.99999999999999999910E-1));
+    px = mapp_simd_mul(px, r);
+    qx = mapp_simd_set1(3.00198505138664455042E-6);
+    qx = mapp_simd_add(mapp_simd_mul(qx, rr), mapp_simd_set1(2.52448340349684104192E-3));
+    qx = mapp_simd_add(mapp_simd_mul(qx, rr), mapp_simd_set1(2.27265548208155028766E-1));
+    qx = mapp_simd_add(mapp_simd_mul(qx, rr), mapp_simd_set1(2.00000000000000000009E0));
+    r = mapp_simd_div(px, mapp_simd_sub(qx, px));
+    r = mapp_simd_add(mapp_simd_set1(1.0), mapp_simd_mul(mapp_simd_set1(2.0), r));
+
+    /* 2^n, the low bits of t hold 2^51 + n, the shift drops 2^51 */
+    e = mapp_simd_shift_int(mapp_simd_add_int(mapp_simd_cast_int(t), 1023), 52);
+    return mapp_simd_mul(r, mapp_simd_cast_double(e));
+}
+
+#endif
@@ -25,6 +25,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include "coreneuron_1.0/common/util/timer.h"
 
 /* Return 1 if the difference is negative, otherwise 0.  */
@@ -35,3 +36,23 @@ int timeval_subtract(struct timeval *result, struct timeval *t2, struct timeval
 
     return (diff<0);
 }
+
+double timeval_usec(struct timeval *t2, struct timeval *t1) {
+    return (double)(t2->tv_sec - t1->tv_sec) * 1e6 + (double)(t2->tv_usec - t1->tv_usec);
+}
+
+static int compare_double(const void *a, const void *b) {
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+void timer_statistics(double *samples, int n, double *min, double *median, double *max) {
+    if (n < 1) {
+        *min = *median = *max = 0.;
+        return;
+    }
+    qsort(samples, n, sizeof(double), compare_double);
+    *min = samples[0];
+    *max = samples[n-1];
+    *median = (n % 2) ? samples[n/2] : 0.5 * (samples[n/2-1] + samples[n/2]);
+}
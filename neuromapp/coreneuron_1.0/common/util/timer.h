@@ -44,4 +44,16 @@ struct timeval tvBegin, tvEnd, tvDiff;
  */
 int timeval_subtract(struct timeval *result, struct timeval *t2, struct timeval *t1);
 
+/** \fn timeval_usec(struct timeval *t2, struct timeval *t1)
+ \brief Compute the time difference t2-t1 in microseconds.
+ */
+double timeval_usec(struct timeval *t2, struct timeval *t1);
+
+/** \fn timer_statistics(double *samples, int n, double *min, double *median, double *max)
+ \brief Compute the minimum, median and maximum of n time samples.
+ \param samples The samples, they are sorted in place
+ \param n Number of samples, the results are zero if n < 1
+ */
+void timer_statistics(double *samples, int n, double *min, double *median, double *max);
+
 #endif
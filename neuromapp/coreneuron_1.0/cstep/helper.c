@@ -35,14 +35,22 @@
 #include <unistd.h>
 
 #include "coreneuron_1.0/cstep/helper.h"
+#include "coreneuron_1.0/common/memory/permute.h"
 #include "utils/error.h"
 
 int cstep_print_usage() {
-    printf("Usage: cstep --data <input path> [--numthread int] [--name string]\n");
+    printf("Usage: cstep --data <input path> [--numthread int] [--name string] [--simd] [--template] [--permute string] [--cells] [--steps int] [--warmup int] [--fused]\n");
     printf("Details: \n");
     printf("                 --data [path to the input]\n");
-    printf("                 --numthread <threadnumber>\n");
+    printf("                 --numthread <threadnumber, used by --cells>\n");
     printf("                 --name [to internally reference the data, default name coreneuron_1.0_cstep_data] \n");
+    printf("                 --simd [use the hand-vectorized kernels] \n");
+    printf("                 --template [use the C++ kernels specialized on the layout] \n");
+    printf("                 --permute [none, cell, interleave or lane, renumbering of the compartments, default none] \n");
+    printf("                 --cells [solve the cells independently, groups of cells on the SIMD lanes and the OMP threads] \n");
+    printf("                 --steps [number of timed steps, min/median/max per phase, default 1] \n");
+    printf("                 --warmup [number of untimed steps before, default 0] \n");
+    printf("                 --fused [state of a step and current of the next one in a single sweep] \n");
     return MAPP_USAGE;
 }
 
@@ -51,6 +59,13 @@ int cstep_help(int argc, char * const argv[], struct input_parameters * p)
   int c;
   p->d = "";
   p->th = 1; // one omp thread by default
+  p->simd = 0; // compiler vectorization by default
+  p->tmpl = 0; // C kernels by default
+  p->permute = NRN_PERMUTE_NONE; // original numbering by default
+  p->cells = 0; // single loop solver by default
+  p->steps = 1; // a single step by default
+  p->warmup = 0; // no warm-up by default
+  p->fused = 0; // separate current and state sweeps by default
   p->name = "coreneuron_1.0_cstep_data";
 
   optind = 0;
@@ -63,13 +78,20 @@ int cstep_help(int argc, char * const argv[], struct input_parameters * p)
           {"data",  required_argument,     0, 'd'},
           {"numthread",  required_argument,0, 't'},
           {"name",  required_argument,     0, 'n'},
+          {"simd",  no_argument,           0, 's'},
+          {"template",  no_argument,       0, 'p'},
+          {"permute",  required_argument,  0, 'r'},
+          {"cells",  no_argument,          0, 'c'},
+          {"steps",  required_argument,    0, 'i'},
+          {"warmup",  required_argument,   0, 'w'},
+          {"fused",  no_argument,          0, 'f'},
 
           {0, 0, 0, 0}
       };
       /* getopt_long stores the option index here. */
       int option_index = 0;
 
-      c = getopt_long (argc, argv, "d:t:n:",
+      c = getopt_long (argc, argv, "d:t:n:spr:ci:w:f",
                        long_options, &option_index);
       /* Detect the end of the options. */
       if (c == -1)
@@ -88,6 +110,33 @@ int cstep_help(int argc, char * const argv[], struct input_parameters * p)
           case 'n':
               p->name = optarg;
               break;
+          case 's':
+              p->simd = 1;
+              break;
+          case 'p':
+              p->tmpl = 1;
+              break;
+          case 'r':
+              p->permute = nrnthread_permute_kind(optarg);
+              if(p->permute < 0)
+                  return MAPP_BAD_ARG;
+              break;
+          case 'c':
+              p->cells = 1;
+              break;
+          case 'i':
+              p->steps = atoi(optarg);
+              if(p->steps < 1)
+                  return MAPP_BAD_ARG;
+              break;
+          case 'f':
+              p->fused = 1;
+              break;
+          case 'w':
+              p->warmup = atoi(optarg);
+              if(p->warmup < 0)
+                  return MAPP_BAD_ARG;
+              break;
           case 'h':
               return cstep_print_usage();
               break;
@@ -96,5 +145,9 @@ int cstep_help(int argc, char * const argv[], struct input_parameters * p)
               break;
       }
   }
+
+  if(p->simd && p->tmpl)
+      return MAPP_BAD_ARG;
+
   return 0 ;
 }
\ No newline at end of file
@@ -42,6 +42,34 @@ struct input_parameters{
      \warning The default value is 1 OMP thread
      */
     int th;
+    /** use the hand-vectorized kernels
+     \warning The default value is 0, the compiler vectorizes the kernels
+     */
+    int simd;
+    /** use the C++ template kernels specialized on the layout of the mechanism
+     \warning The default value is 0, --simd and --template are exclusive
+     */
+    int tmpl;
+    /** renumbering of the compartments (nrn_permutation)
+     \warning The default value is NRN_PERMUTE_NONE, the original numbering
+     */
+    int permute;
+    /** solve the cells independently on the SIMD lanes and the --numthread OMP threads
+     \warning The default value is 0, nrn_solve_minimal
+     */
+    int cells;
+    /** number of timed steps, _t is advanced by _dt after each step
+     \warning The default value is 1 step
+     */
+    int steps;
+    /** number of untimed steps before the timed ones
+     \warning The default value is 0, the data of the storage are advanced by the warm-up too
+     */
+    int warmup;
+    /** fuse the state of a step and the current of the next one in one sweep over the data
+     \warning The default value is 0, separate current and state sweeps
+     */
+    int fused;
     /** key for the storage library 
      \warning The default key name is cstep_storage_name_helper
      */
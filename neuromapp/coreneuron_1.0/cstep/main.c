@@ -37,18 +37,140 @@
 
 #include "coreneuron_1.0/kernel/kernel.h"
 #include "coreneuron_1.0/kernel/mechanism/mechanism.h"
+#include "coreneuron_1.0/kernel/mechanism/registry.h"
 
 #include "coreneuron_1.0/cstep/helper.h"
 #include "coreneuron_1.0/cstep/cstep.h"
 
 #include "coreneuron_1.0/common/memory/nrnthread.h"
+#include "coreneuron_1.0/common/memory/permute.h"
 #include "coreneuron_1.0/common/util/nrnthread_handler.h"
 #include "coreneuron_1.0/common/util/timer.h"
+#include "coreneuron_1.0/common/util/simd.h"
+#include "utils/omp/compatibility.h"
 
 #include "utils/error.h"
 
+/** \fn cstep_setup(NrnThread *nt, const double *rhs0, const double *d0)
+    \brief Setup phase, rhs and d start every step from the matrix of the input data, as nrn_rhs
+    and nrn_lhs set them up in CoreNEURON, else the currents would accumulate over the steps.
+    d is restored rather than zeroed, the capacitance and axial terms are not recomputed here
+ */
+static void cstep_setup(NrnThread *nt, const double *rhs0, const double *d0) {
+    memcpy(nt->_actual_rhs, rhs0, nt->end*sizeof(double));
+    memcpy(nt->_actual_d, d0, nt->end*sizeof(double));
+}
+
+/** \fn cstep_current(NrnThread *nt, struct input_parameters *p)
+    \brief Current phase, every mechanism of the registry contributes to rhs and d
+ */
+static void cstep_current(NrnThread *nt, struct input_parameters *p) {
+    int i;
+    for(i = 0; i < nt->nmech; ++i){
+        Mechanism *ml = &nt->ml[i];
+        const mech_kernels *k = mech_find(ml->type);
+        if(k == NULL)
+            continue;
+        if(p->simd){
+            k->current_simd_chunk(nt,ml,0,ml->nodecount);
+        }else if(p->tmpl){
+            k->current_template_chunk(nt,ml,0,ml->nodecount);
+            mech_shadow_update(nt,ml,0,ml->nodecount);
+        }else{
+            k->current(nt,ml);
+        }
+    }
+}
+
+/** \fn cstep_solve(NrnThread *nt, struct input_parameters *p, const HinesSchedule *schedule)
+    \brief Solve phase, Hines solver
+ */
+static void cstep_solve(NrnThread *nt, struct input_parameters *p, const HinesSchedule *schedule) {
+    if(p->cells)
+        nrn_solve_cells(nt, schedule);
+    else
+        nrn_solve_minimal(nt);
+}
+
+/** \fn cstep_state(NrnThread *nt, struct input_parameters *p)
+    \brief State phase, every mechanism of the registry updates its states from the new voltage
+ */
+static void cstep_state(NrnThread *nt, struct input_parameters *p) {
+    int i;
+    for(i = 0; i < nt->nmech; ++i){
+        Mechanism *ml = &nt->ml[i];
+        const mech_kernels *k = mech_find(ml->type);
+        if(k == NULL)
+            continue;
+        if(p->simd)
+            k->state_simd_chunk(nt,ml,0,ml->nodecount);
+        else if(p->tmpl)
+            k->state_template_chunk(nt,ml,0,ml->nodecount);
+        else
+            k->state(nt,ml);
+    }
+}
+
+/** \fn cstep_fused(NrnThread *nt, struct input_parameters *p)
+    \brief Fused phase, state of the previous step and current of this step in a single sweep
+    over the data of every mechanism (mech_fused_chunk), same results than cstep_state + cstep_current
+ */
+static void cstep_fused(NrnThread *nt, struct input_parameters *p) {
+    int i;
+    for(i = 0; i < nt->nmech; ++i){
+        Mechanism *ml = &nt->ml[i];
+        const mech_kernels *k = mech_find(ml->type);
+        if(k == NULL)
+            continue;
+        if(p->simd)
+            mech_fused_chunk(nt,ml,k->state_simd_chunk,k->current_simd_chunk,0,0,ml->nodecount);
+        else if(p->tmpl)
+            mech_fused_chunk(nt,ml,k->state_template_chunk,k->current_template_chunk,1,0,ml->nodecount);
+        else
+            mech_fused_chunk(nt,ml,k->state_chunk,k->current_chunk,1,0,ml->nodecount);
+    }
+}
+
+/** \fn cstep_step(NrnThread *nt, struct input_parameters *p, const HinesSchedule *schedule,
+                    const double *matrix, int pending, struct timeval tv[4])
+    \brief One time step, tv gets the time before/after the mechanism, solve and state phases,
+    the setup of the matrix is not timed. With --fused the state is delayed to the fused sweep
+    of the next step
+    \param matrix rhs then d of the input data, see cstep_setup
+    \param pending non zero if the state of the previous step is not done yet (--fused)
+ */
+static void cstep_step(NrnThread *nt, struct input_parameters *p, const HinesSchedule *schedule,
+                       const double *matrix, int pending, struct timeval tv[4]) {
+    cstep_setup(nt, matrix, matrix + nt->end);
+    gettimeofday(&tv[0], NULL);
+    if(p->fused && pending)
+        cstep_fused(nt, p);
+    else
+        cstep_current(nt, p);
+    gettimeofday(&tv[1], NULL);
+    cstep_solve(nt, p, schedule);
+    gettimeofday(&tv[2], NULL);
+    if(!p->fused)
+        cstep_state(nt, p);
+    gettimeofday(&tv[3], NULL);
+    nt->_t += nt->_dt;
+}
+
+/** \fn cstep_print_phase(const char *name, double *samples, int n)
+    \brief Print min/median/max of the samples of a phase, the samples are sorted
+ */
+static void cstep_print_phase(const char *name, double *samples, int n) {
+    double min, median, max;
+    timer_statistics(samples, n, &min, &median, &max);
+    printf("  %-8s min %10.0f  median %10.0f  max %10.0f [us]\n", name, min, median, max);
+}
+
 int coreneuron10_cstep_execute(int argc, char * const argv[]) {
     struct input_parameters p;
+    struct timeval tv[4];
+    double *samples;
+    double *matrix;
+    int i;
 
     int error = MAPP_OK;
     error = cstep_help(argc, argv, &p);
@@ -62,25 +184,56 @@ int coreneuron10_cstep_execute(int argc, char * const argv[]) {
         return MAPP_BAD_DATA;
     }
 
-    //Initial mechanisms set-up already done in the input date (no need to call mech_init_Ih, etc)
-    gettimeofday(&tvBegin, NULL);
+    //Renumber the compartments and group the cells, not timed, it is done once in a simulation
+    HinesSchedule schedule;
+    nrnthread_permute(nt, p.permute);
+    if(p.cells){
+        omp_set_num_threads(p.th);
+        nrn_schedule_build(nt, MAPP_SIMD_WIDTH, &schedule);
+    }
 
-    //Load mechanisms
-    mech_current_NaTs2_t(nt,&(nt->ml[17]));
-    mech_current_Ih(nt,&(nt->ml[10]));
-    mech_current_ProbAMPANMDA_EMS(nt,&(nt->ml[18]));
+    //The matrix every step starts from, in the renumbered order
+    matrix = (double*)malloc(2 * nt->end * sizeof(double));
+    memcpy(matrix, nt->_actual_rhs, nt->end*sizeof(double));
+    memcpy(matrix + nt->end, nt->_actual_d, nt->end*sizeof(double));
 
-    //Call solver
-    nrn_solve_minimal(nt);
+    //Initial mechanisms set-up already done in the input date (no need to call mech_init_Ih, etc)
+    //Warm-up, the first steps pay the page faults and the cold caches
+    for(i = 0; i < p.warmup; ++i)
+        cstep_step(nt, &p, &schedule, matrix, i > 0, tv);
 
-    //Update the states
-    mech_state_NaTs2_t(nt,&(nt->ml[17]));
-    mech_state_Ih(nt,&(nt->ml[10]));
-    mech_state_ProbAMPANMDA_EMS(nt,&(nt->ml[18]));
+    //One sample per step for the current, solve and state phases
+    samples = (double*)malloc(3 * p.steps * sizeof(double));
 
+    gettimeofday(&tvBegin, NULL);
+    for(i = 0; i < p.steps; ++i){
+        cstep_step(nt, &p, &schedule, matrix, p.warmup + i > 0, tv);
+        samples[i] = timeval_usec(&tv[1], &tv[0]);
+        samples[p.steps + i] = timeval_usec(&tv[2], &tv[1]);
+        samples[2*p.steps + i] = timeval_usec(&tv[3], &tv[2]);
+    }
+    //With --fused the state of the last step is still pending
+    if(p.fused)
+        cstep_state(nt, &p);
     gettimeofday(&tvEnd, NULL);
     timeval_subtract(&tvDiff, &tvEnd, &tvBegin);
-    
-    printf("\nTime for full computational step: %ld [s] %ld [us]\n", tvDiff.tv_sec, (long) tvDiff.tv_usec);
+
+    printf("\nTime for %d computational step(s), %d warm-up: %ld [s] %ld [us]\n",
+           p.steps, p.warmup, tvDiff.tv_sec, (long) tvDiff.tv_usec);
+    if(p.fused){
+        cstep_print_phase("fused", samples, p.steps);
+        cstep_print_phase("solve", samples + p.steps, p.steps);
+    }else{
+        cstep_print_phase("current", samples, p.steps);
+        cstep_print_phase("solve", samples + p.steps, p.steps);
+        cstep_print_phase("state", samples + 2*p.steps, p.steps);
+    }
+    free(samples);
+    free(matrix);
+
+    //Back to the original numbering for the user of the storage
+    if(p.cells)
+        nrn_schedule_free(&schedule);
+    nrnthread_unpermute(nt);
     return error;
 }
@@ -28,6 +28,7 @@
 #include <stdlib.h>
 #include <cassert>
 #include <sys/time.h>
+#include <string>
 
 #include "coreneuron_1.0/event_passing/queueing/queue.h"
 #include "coreneuron_1.0/event_passing/queueing/pool.h"
@@ -37,15 +38,86 @@
 #include "coreneuron_1.0/event_passing/environment/presyn_maker.h"
 #include "coreneuron_1.0/event_passing/spike/spike_interface.h"
 #include "coreneuron_1.0/event_passing/spike/algos.hpp"
+#include "coreneuron_1.0/event_passing/spike/nonblocking.hpp"
 #include "coreneuron_1.0/event_passing/spike/distributed.hpp"
+#include "coreneuron_1.0/event_passing/spike/compressed.hpp"
+#include "coreneuron_1.0/event_passing/drivers/drivers.h"
 #include "utils/storage/neuromapp_data.h"
 
 // Get OMP header if available
 #include "utils/omp/compatibility.h"
 
 
+/** \fn run(...)
+ *  \brief runs the simulation with the event container Q (queueing::queue, sptq_queue,
+ *  bin_queue or concurrent_bin_queue) and prints the run time
+ */
+template<class Q>
+void run(bool algebra, int ngroups, int mindelay, int rank, int simtime, bool fused,
+         bool lock_free, bool buffered, bool nonblocking, bool compressed, bool tasks, int ncells,
+         environment::event_generator& generator,
+         const environment::presyn_maker& presyns, spike::spike_interface& s_interface,
+         MPI_Datatype mpi_spike, MPI_Comm neighborhood){
+    struct timeval start, end;
+    queueing::basic_pool<Q> pl(algebra, ngroups, mindelay, rank, s_interface, fused, lock_free,
+        buffered, tasks);
+    gettimeofday(&start, NULL);
+    nonblocking_exchange<spike::spike_interface> exchange(s_interface, mpi_spike, neighborhood, true);
+    spike_codec codec(ncells, mindelay);
+    double exchange_time = 0.;
+    while(pl.get_time() <= simtime){
+        pl.fixed_step(generator, presyns);
+        double t0 = MPI_Wtime();
+        if(nonblocking)
+            exchange();
+        else if(compressed)
+            distributed_compressed_spike(s_interface, codec, pl.get_time() - mindelay, neighborhood);
+        else
+            distributed_spike(s_interface, mpi_spike, neighborhood);
+        exchange_time += MPI_Wtime() - t0;
+        pl.filter(presyns);
+        if(nonblocking){
+            //the counts arrived during the filter, the spikes overlap the next step
+            t0 = MPI_Wtime();
+            exchange.progress();
+            exchange_time += MPI_Wtime() - t0;
+        }
+    }
+    if(nonblocking){
+        exchange.flush();
+        pl.filter(presyns);
+    }
+    gettimeofday(&end, NULL);
+
+    long long diff_ms = (1000 * (end.tv_sec - start.tv_sec))
+        + ((end.tv_usec - start.tv_usec) / 1000);
+
+    if(rank == 0){
+        std::cout<<"run time: "<<diff_ms<<" ms"<<std::endl;
+    }
+
+    //summed over the ranks
+    int fallbacks = codec.fallbacks();
+    MPI_Reduce(rank == 0 ? MPI_IN_PLACE : &fallbacks, &fallbacks, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if(rank == 0){
+        std::cout<<"exchange time: "<<exchange_time*1000.<<" ms"<<std::endl;
+        if(nonblocking)
+            std::cout<<"exposed communication: "<<exchange.exposed()*1000.<<" ms, hidden behind "
+                <<exchange.overlapped()*1000.<<" ms of computation"<<std::endl;
+        if(compressed)
+            std::cout<<"compressed wire format: "<<codec.width()<<" bytes per spike instead of "
+                <<sizeof(spike_item)<<std::endl;
+        if(compressed && fallbacks > 0)
+            std::cout<<"uncompressed exchanges, a spike out of the window or off the steps: "<<fallbacks<<std::endl;
+        print_idle(pl.busy_times(), pl.idle_times(), tasks);
+    }
+
+    pl.accumulate_stats();
+}
+
 int main(int argc, char* argv[]) {
-    assert(argc == 8);
+    assert(argc == 19);
 
     MPI_Init(NULL, NULL);
     MPI_Datatype mpi_spike = create_spike_type();
@@ -60,10 +132,16 @@ int main(int argc, char* argv[]) {
     int nSpikes = atoi(argv[5]);
     int mindelay = atoi(argv[6]);
     bool algebra = atoi(argv[7]);
-
-    struct timeval start, end;
-
-    int cellsper = ncells / size;
+    bool fused = atoi(argv[8]);
+    bool lock_free = atoi(argv[9]);
+    std::string container(argv[10]);
+    bool buffered = atoi(argv[11]);
+    bool nonblocking = atoi(argv[12]);
+    bool compressed = atoi(argv[14]);
+    bool tasks = atoi(argv[15]);
+    std::string trace(argv[16]);
+    std::string trace_file(argv[17]);
+    double trace_dt = atof(argv[18]);
 
     //create environment
     environment::event_generator generator(ngroups);
@@ -73,32 +151,46 @@ int main(int argc, char* argv[]) {
 
     environment::continousdistribution neuro_dist(size, rank, ncells);
 
-    environment::generate_events_kai(generator.begin(),
-                              simtime, ngroups, rank, size, lambda, &neuro_dist);
+    //generate the events, or replay/import them with the connectivity of the record
+    double event_setup = MPI_Wtime();
+    unsigned seed = time(NULL);
+    int error = setup_events(generator, trace, trace_file, trace_dt,
+                             simtime, ngroups, rank, size, lambda, neuro_dist, seed);
+    if(error != mapp::MAPP_OK){
+        std::cerr<<"Rank: "<<rank<<" "<<trace<<" of the events of "<<trace_file<<" failed"<<std::endl;
+        MPI_Abort(MPI_COMM_WORLD, error);
+    }
+    event_setup = MPI_Wtime() - event_setup;
+    double max_event_setup;
+    MPI_Reduce(&event_setup, &max_event_setup, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    if(rank == 0)
+        std::cout<<"event setup time ("<<trace<<"): "<<max_event_setup*1000.<<" ms"<<std::endl;
 
     environment::presyn_maker presyns(fanin);
-    presyns(rank, &neuro_dist);
+    presyns(rank, &neuro_dist, seed);
     spike::spike_interface s_interface(size);
 
     //run simulation
-    MPI_Comm neighborhood = create_dist_graph(presyns, cellsper);
-    queueing::pool pl(algebra, ngroups, mindelay, rank, s_interface);
-    gettimeofday(&start, NULL);
-    while(pl.get_time() <= simtime){
-        pl.fixed_step(generator, presyns);
-        distributed_spike(s_interface, mpi_spike, neighborhood);
-        pl.filter(presyns);
-    }
-    gettimeofday(&end, NULL);
-
-    long long diff_ms = (1000 * (end.tv_sec - start.tv_sec))
-        + ((end.tv_usec - start.tv_usec) / 1000);
-
-    if(rank == 0){
-        std::cout<<"run time: "<<diff_ms<<" ms"<<std::endl;
-    }
-
-    pl.accumulate_stats();
+    double setup = MPI_Wtime();
+    MPI_Comm neighborhood = create_dist_graph(presyns, neuro_dist);
+    setup = MPI_Wtime() - setup;
+    double max_setup;
+    MPI_Reduce(&setup, &max_setup, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    if(rank == 0)
+        std::cout<<"graph setup time: "<<max_setup*1000.<<" ms"<<std::endl;
+    //the event container is a template parameter of the pool
+    if(container == "sptq")
+        run<queueing::sptq_queue>(algebra, ngroups, mindelay, rank, simtime, fused, lock_free,
+            buffered, nonblocking, compressed, tasks, ncells, generator, presyns, s_interface, mpi_spike, neighborhood);
+    else if(container == "bin")
+        run<queueing::bin_queue>(algebra, ngroups, mindelay, rank, simtime, fused, lock_free,
+            buffered, nonblocking, compressed, tasks, ncells, generator, presyns, s_interface, mpi_spike, neighborhood);
+    else if(container == "concurrent")
+        run<queueing::concurrent_bin_queue>(algebra, ngroups, mindelay, rank, simtime, fused, lock_free,
+            buffered, nonblocking, compressed, tasks, ncells, generator, presyns, s_interface, mpi_spike, neighborhood);
+    else
+        run<queueing::queue>(algebra, ngroups, mindelay, rank, simtime, fused, lock_free,
+            buffered, nonblocking, compressed, tasks, ncells, generator, presyns, s_interface, mpi_spike, neighborhood);
     accumulate_stats(s_interface);
 
     MPI_Comm_free(&neighborhood);
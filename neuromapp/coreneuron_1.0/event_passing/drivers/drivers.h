@@ -26,6 +26,15 @@
 #ifndef MAPP_EVENT_DRIVERS_H_
 #define MAPP_EVENT_DRIVERS_H_
 
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "coreneuron_1.0/event_passing/environment/generator.h"
+#include "coreneuron_1.0/event_passing/environment/event_generators.hpp"
+#include "coreneuron_1.0/event_passing/environment/trace.h"
+#include "utils/error.h"
+
 /** \fn spike_execute(int argc, char *const argv[])
     \brief Spike Exchange Miniapp
     \param argc number of argument from the command line
@@ -34,4 +43,50 @@
  */
 int event_execute(int argc, char* const argv[]);
 
+/** \fn print_idle(const std::vector<double>& busy, const std::vector<double>& idle, bool tasks)
+    \brief prints the time the threads ran cell groups and waited at the end of the fixed steps
+    \param busy the busy time (s) per thread, see basic_pool::busy_times()
+    \param idle the idle time (s) per thread, see basic_pool::idle_times()
+    \param tasks the cell groups ran as OMP tasks
+ */
+inline void print_idle(const std::vector<double>& busy, const std::vector<double>& idle, bool tasks){
+    double total_busy = 0., total_idle = 0., max_idle = 0.;
+    for(int i = 0; i < idle.size(); ++i){
+        total_busy += busy[i];
+        total_idle += idle[i];
+        max_idle = (idle[i] > max_idle) ? idle[i] : max_idle;
+    }
+    const double total = total_busy + total_idle;
+    std::cout<<(tasks ? "task" : "static")<<" schedule, "<<idle.size()<<" threads, idle time: "
+        <<total_idle*1000.<<" ms ("<<(total > 0. ? 100.*total_idle/total : 0.)
+        <<"% of the fixed steps), max per thread: "<<max_idle*1000.<<" ms"<<std::endl;
+}
+
+/** \fn setup_events(environment::event_generator& generator, const std::string& trace,
+        const std::string& file, double dt, int simtime, int ngroups, int rank, int nprocs,
+        double lambda, environment::neurondistribution& neuro_dist, unsigned& seed)
+    \brief fills the cell groups of generator with the events of the simulation
+    \param trace replay: reads the trace file.rank, csv or binary: imports the spike train
+    file (times in steps of dt), else generates the events (generate_events_kai) and, if
+    record, writes them in the trace file.rank
+    \param seed the seed of the connectivity (presyn_maker), recorded with the events and
+    set back to the recorded one on replay
+    \return MAPP_OK or the error of the trace
+ */
+inline int setup_events(environment::event_generator& generator, const std::string& trace,
+                        const std::string& file, double dt, int simtime, int ngroups, int rank,
+                        int nprocs, double lambda, environment::neurondistribution& neuro_dist,
+                        unsigned& seed){
+    if(trace == "replay")
+        return environment::read_trace(environment::trace_name(file, rank), generator, seed);
+    if(trace == "csv" || trace == "binary")
+        return environment::import_spikes(file, trace == "binary", dt, neuro_dist, generator);
+
+    environment::generate_events_kai(generator.begin(),
+                             simtime, ngroups, rank, nprocs, lambda, &neuro_dist);
+    if(trace == "record")
+        return environment::write_trace(environment::trace_name(file, rank), generator, seed);
+    return mapp::MAPP_OK;
+}
+
 #endif
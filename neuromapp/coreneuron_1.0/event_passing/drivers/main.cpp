@@ -65,7 +65,22 @@ int event_help(int argc, char* const argv[], po::variables_map& vm){
     ("mindelay", po::value<size_t>()->default_value(3),
     "the number of timesteps per fixed step function")
     ("distributed", "if set, use distributed graph implementation")
-    ("algebra","If set, perform linear algebra");
+    ("algebra","If set, perform linear algebra")
+    ("fused","If set with algebra, fuse the state and the next current sweeps of the channels")
+    ("lockfree","If set, the inter thread events go through lock-free inboxes instead of locks")
+    ("buffered","If set, the spikes and the inter thread events are buffered per thread, merged once per min delay")
+    ("nonblocking","If set, the spike exchange uses the non-blocking collectives, overlapped with the next fixed steps")
+    ("fixed","If set, the spike exchange sends fixed size buffers in a single collective, Allgatherv on overflow only")
+    ("compressed","If set, the spikes are packed in 4 or 8 bytes on the wire, gid and time step in the min delay window")
+    ("tasks","If set, the cell groups run as OMP tasks taken by the idle threads, else a static schedule")
+    ("queue", po::value<std::string>()->default_value("heap"),
+    "the event container of the cell groups: heap, sptq, bin or concurrent (bins filled by the senders)")
+    ("trace", po::value<std::string>()->default_value("none"),
+    "the events of the cell groups: none (generated), record (generated and written to the trace), replay (the events and the connectivity read from the trace), csv or binary (imported from the spike train tracefile)")
+    ("tracefile", po::value<std::string>()->default_value("events.trace"),
+    "the trace, one file tracefile.rank per process, or the spike train to import")
+    ("tracedt", po::value<double>()->default_value(1.0),
+    "the time step of the imported spike times");
 
     po::store(po::parse_command_line(argc, argv, desc), vm);
     po::notify(vm);
@@ -90,6 +105,39 @@ int event_help(int argc, char* const argv[], po::variables_map& vm){
 	return mapp::MAPP_BAD_ARG;
     }
 
+    std::string queue = vm["queue"].as<std::string>();
+    if(queue != "heap" && queue != "sptq" && queue != "bin" && queue != "concurrent"){
+	std::cout<<"the event container must be heap, sptq, bin or concurrent"<<std::endl;
+	return mapp::MAPP_BAD_ARG;
+    }
+
+    std::string trace = vm["trace"].as<std::string>();
+    if(trace != "none" && trace != "record" && trace != "replay" && trace != "csv" && trace != "binary"){
+	std::cout<<"the trace must be none, record, replay, csv or binary"<<std::endl;
+	return mapp::MAPP_BAD_ARG;
+    }
+
+    if(vm["tracedt"].as<double>() <= 0.){
+	std::cout<<"the time step of the spike times must be positive"<<std::endl;
+	return mapp::MAPP_BAD_ARG;
+    }
+
+    if(vm.count("fixed") && vm.count("nonblocking")){
+	std::cout<<"--fixed and --nonblocking are exclusive"<<std::endl;
+	return mapp::MAPP_BAD_ARG;
+    }
+
+    if(vm.count("compressed") && (vm.count("fixed") || vm.count("nonblocking"))){
+	std::cout<<"--compressed is exclusive with --fixed and --nonblocking"<<std::endl;
+	return mapp::MAPP_BAD_ARG;
+    }
+
+    // a rank only sees the counts of its neighbors, the fallback would not be collective
+    if(vm.count("fixed") && vm.count("distributed")){
+	std::cout<<"--fixed is not available with --distributed"<<std::endl;
+	return mapp::MAPP_BAD_ARG;
+    }
+
     return mapp::MAPP_OK;
 }
 
@@ -113,6 +161,17 @@ void event_content(po::variables_map const& vm){
     size_t nspike = vm["numspikes"].as<size_t>();
     size_t mindelay = vm["mindelay"].as<size_t>();
     size_t algebra = vm.count("algebra");
+    size_t fused = vm.count("fused");
+    size_t lockfree = vm.count("lockfree");
+    size_t buffered = vm.count("buffered");
+    size_t nonblocking = vm.count("nonblocking");
+    size_t fixed = vm.count("fixed");
+    size_t compressed = vm.count("compressed");
+    size_t tasks = vm.count("tasks");
+    std::string queue = vm["queue"].as<std::string>();
+    std::string trace = vm["trace"].as<std::string>();
+    std::string tracefile = vm["tracefile"].as<std::string>();
+    double tracedt = vm["tracedt"].as<double>();
     bool distributed = vm.count("distributed");
 
     std::string exec;
@@ -127,7 +186,8 @@ void event_content(po::variables_map const& vm){
         mpi_run <<" -n "<< nproc << " " << path << exec <<
         ngroup << " " << simtime << " " <<
         ncells << " " << fanin << " " <<
-        nspike << " " << mindelay << " " << algebra;
+        nspike << " " << mindelay << " " << algebra << " " << fused << " " << lockfree << " " << queue << " " << buffered << " " << nonblocking << " " << fixed << " " << compressed << " " << tasks << " " <<
+        trace << " " << tracefile << " " << tracedt;
 
     std::cout<< "Running command " << command.str() <<std::endl;
 	system(command.str().c_str());
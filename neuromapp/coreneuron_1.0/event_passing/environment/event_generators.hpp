@@ -34,6 +34,8 @@
 #include <boost/random.hpp>
 
 #include <cassert>
+#include <cmath>
+#include <algorithm>
 
 #include "coreneuron_1.0/event_passing/environment/generator.h"
 
@@ -1,5 +1,15 @@
 namespace environment {
 
+/** reserves the expected number of events of every cell group, plus three standard
+    deviations of a Poisson count, the generators push without reallocation */
+template< typename Iterator >
+void reserve_events(Iterator beg, int ngroups, double expected) {
+    const double mean = expected / ngroups;
+    const std::size_t n = static_cast<std::size_t>(mean + 3.0*std::sqrt(mean) + 1.0);
+    for(int i = 0; i < ngroups; ++i, ++beg)
+        beg->reserve(n);
+}
+
 template< typename Iterator >
 void generate_events_kai(Iterator beg, int simtime, int ngroups, int rank, int nprocs, double lambda, neurondistribution* neuron_dist ) {
 
@@ -19,6 +29,8 @@ void generate_events_kai(Iterator beg, int simtime, int ngroups, int rank, int n
     //generate local ids
     boost::random::uniform_int_distribution<> lid_d(0, neuron_dist->getlocalcells()-1);
 
+    reserve_events(beg, ngroups, simtime*neuron_dist->getglobalcells()*lambda/nprocs);
+
     double event_time = 0;
     Iterator it;
     //create events up until simulation end
@@ -67,6 +79,9 @@ void generate_poisson_events(Iterator beg, int simtime, int ngroups, int rank, i
     boost::random::poisson_distribution<int> event_d(neuron_dist->getglobalcells()*lambda/nprocs);
     boost::random::uniform_int_distribution<> lid_d(0, neuron_dist->getlocalcells()-1);
 
+    reserve_events(beg, ngroups, simtime*std::min(neuron_dist->getglobalcells()*lambda/nprocs,
+                                                  static_cast<double>(neuron_dist->getlocalcells())));
+
     double event_time = 0;
     Iterator it;
     int event_num;
@@ -108,6 +123,8 @@ void generate_poisson_events_net(Iterator beg, const int& seed,  const int& simt
     boost::random::poisson_distribution<int> event_d(net_firing_rate);
     boost::random::uniform_int_distribution<> gid_d(0, neuron_dist.getglobalcells()-1);
 
+    reserve_events(beg, 1, simtime*net_firing_rate*neuron_dist.getlocalcells()/neuron_dist.getglobalcells());
+
     double event_time = 0;
     Iterator it;
     int event_num;
@@ -139,6 +156,8 @@ void generate_poisson_events_neuron(Iterator beg, const int& seed,  const int& s
     boost::random::uniform_real_distribution<double> pick(0,1);
     boost::random::uniform_int_distribution<> gid_d(0, neuron_dist.getglobalcells()-1);
 
+    reserve_events(beg, 1, simtime*neuron_firing_rate*neuron_dist.getlocalcells());
+
     double event_time = 0;
     Iterator it;
     int event_num;
@@ -169,6 +188,8 @@ void generate_uniform_events(Iterator beg, int simtime, int ngroups, int firing_
     double event_time = 0;
     gen_event new_event;
 
+    reserve_events(beg, ngroups, ((simtime - 1)/firing_interval)*neuron_dist->getlocalcells());
+
     event_time = 0;
     Iterator it;
     //create events up until simulation end
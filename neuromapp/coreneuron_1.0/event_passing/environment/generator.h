@@ -2,8 +2,9 @@
 #define MAPP_GENERATOR_H
 
 #include <vector>
-#include <queue>
 #include <utility>
+#include <algorithm>
+#include <cstddef>
 
 #include "coreneuron_1.0/event_passing/environment/presyn_maker.h"
 #include "coreneuron_1.0/event_passing/queueing/queue.h"
@@ -14,19 +15,81 @@ namespace environment {
 //create a pair out of time and presyn
 typedef std::pair<int, double> gen_event;
 
+/** event_pool
+ *  \brief the events of a cell group, in a flat array read from a cursor (no deque
+ *  chunks). The generators push in time order, an event earlier than the last one
+ *  marks the pool unsorted: the pending events are then sorted (stable) at the
+ *  next read. The array is reset when the cursor reaches its end.
+ */
+class event_pool {
+private:
+    mutable std::vector<gen_event> events_;
+    mutable bool sorted_;
+    std::size_t cursor_;
+
+    static bool earlier(const gen_event& a, const gen_event& b){
+        return a.second < b.second;
+    }
+
+    void sort() const {
+        if(!sorted_){
+            std::stable_sort(events_.begin() + cursor_, events_.end(), earlier);
+            sorted_ = true;
+        }
+    }
+
+public:
+    typedef gen_event value_type;
+    typedef std::vector<gen_event>::const_iterator const_iterator;
+
+    event_pool():sorted_(true),cursor_(0){}
+
+    /** \fn reserve(std::size_t n)
+     *  \brief preallocates the array for n more events
+     */
+    void reserve(std::size_t n){ events_.reserve(events_.size() + n); }
+
+    void push(const gen_event& e){
+        if(sorted_ && events_.size() > cursor_ && e.second < events_.back().second)
+            sorted_ = false;
+        events_.push_back(e);
+    }
+
+    /** \fn front()
+     *  \return the earliest event
+     */
+    const gen_event& front() const { sort(); return events_[cursor_]; }
+
+    void pop(){
+        sort();
+        if(++cursor_ == events_.size()){
+            events_.clear();
+            cursor_ = 0;
+        }
+    }
+
+    bool empty() const { return cursor_ == events_.size(); }
+
+    std::size_t size() const { return events_.size() - cursor_; }
+
+    /** the pending events, in time order */
+    const_iterator begin() const { sort(); return events_.begin() + cursor_; }
+    const_iterator end() const { return events_.end(); }
+};
+
 /** event_generator
  *  /brief generates all events needed for the simulation and stores them
- *  in a queue per cell group. These events can be retrieved using
- *  the pop function.
+ *  in a time-sorted event_pool per cell group. These events can be retrieved
+ *  using the pop function.
  */
 class event_generator {
 private:
-    std::vector<std::queue<gen_event> > event_pool_;
+    std::vector<event_pool> event_pool_;
 
 public:
 
-    typedef std::vector<std::queue<gen_event> >::iterator iterator;
-    typedef std::vector<std::queue<gen_event> >::const_iterator const_iterator;
+    typedef std::vector<event_pool>::iterator iterator;
+    typedef std::vector<event_pool>::const_iterator const_iterator;
 
     iterator begin() {return event_pool_.begin();};
     const_iterator begin() const {return event_pool_.begin();};
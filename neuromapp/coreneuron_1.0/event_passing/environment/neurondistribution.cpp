@@ -9,7 +9,7 @@
 #include "coreneuron_1.0/event_passing/environment/neurondistribution.h"
 
 environment::continousdistribution::continousdistribution(size_t groups, size_t me, size_t cells):
-        global_number(cells)
+        global_number(cells), num_groups(groups), range_start(0), range_number(cells)
 {
     //neuron distribution
     const int offset = cells % groups;
@@ -22,7 +22,8 @@ environment::continousdistribution::continousdistribution(size_t groups, size_t
 }
 
 environment::continousdistribution::continousdistribution(size_t groups, size_t me, environment::continousdistribution* parent_distr):
-    global_number(parent_distr->getglobalcells())
+    global_number(parent_distr->getglobalcells()), num_groups(groups),
+    range_start(parent_distr->start), range_number(parent_distr->getlocalcells())
 {
     //neuron distribution
     const int offset = parent_distr->getlocalcells() % groups;
@@ -35,7 +36,7 @@ environment::continousdistribution::continousdistribution(size_t groups, size_t
 }
 
 environment::nestdistribution::nestdistribution(size_t groups, size_t me, size_t cells):
-        num_groups(groups), group_id(me), global_number(cells)
+        num_groups(groups), group_id(me), global_number(cells), parent_groups(1)
 {
     //keep it simple
     local_number = 0;
@@ -50,6 +51,7 @@ environment::nestdistribution::nestdistribution(size_t groups, size_t me, nestdi
 {
     num_groups = parent_distr->num_groups * groups;
     group_id = parent_distr->num_groups * me + parent_distr->group_id;
+    parent_groups = parent_distr->num_groups;
 
     //keep it simple
     local_number = 0;
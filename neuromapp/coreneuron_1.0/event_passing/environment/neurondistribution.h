@@ -38,6 +38,10 @@ namespace environment
          *  Maps local ids to global ids
          */
         virtual size_t local2global(size_t loc) const = 0;
+        /**
+         *  Maps global ids to the group storing them
+         */
+        virtual size_t owner(size_t glo) const = 0;
     };
 
     class continousdistribution : public neurondistribution {
@@ -80,11 +84,28 @@ namespace environment
 
             return start + loc;
         }
+        inline size_t owner(size_t glo) const
+        {
+            assert(glo>=range_start);
+            assert(glo<range_start+range_number);
+
+            //the first offset groups have one more cell
+            const size_t d = glo - range_start;
+            const size_t n = range_number / num_groups;
+            const size_t offset = range_number % num_groups;
+            if (d < offset * (n + 1))
+                return d / (n + 1);
+            return offset + (d - offset * (n + 1)) / n;
+        }
 
     private:
         const size_t global_number;
         size_t local_number;
         size_t start;
+        //the cells split between the groups
+        size_t num_groups;
+        size_t range_start;
+        size_t range_number;
     };
 
     class nestdistribution : public neurondistribution {
@@ -128,12 +149,19 @@ namespace environment
 
                 return loc * num_groups + group_id;
             }
+            inline size_t owner(size_t glo) const
+            {
+                assert(glo < global_number);
+
+                return suggest_group(glo) / parent_groups;
+            }
 
         private:
             const size_t global_number;
             size_t local_number;
             size_t num_groups;
             size_t group_id;
+            size_t parent_groups;
         };
 };
 
@@ -0,0 +1,140 @@
+/*
+ * Neuromapp - presyn_benchmark.cpp, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/environment/presyn_benchmark.cpp
+ * \brief Compare the lookups of the flat presyn tables with std::map
+ *
+ * The presyns of one rank out of nprocs are generated, then copied in std::map
+ * (the former storage of presyn_maker). The benchmark times the lookups done by
+ * pool::filter (find_input of every received spike, most of them miss) and by
+ * pool::send_events (find_output of the local spikes), in ns per lookup.
+ *
+ * usage: presyn_benchmark [ncells] [nprocs] [fanin] [nlookups]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <vector>
+#include <cstdlib>
+#include <sys/time.h>
+
+#include "coreneuron_1.0/event_passing/environment/presyn_maker.h"
+#include "coreneuron_1.0/event_passing/environment/neurondistribution.h"
+#include "utils/error.h"
+
+namespace {
+
+    typedef std::map<int, std::vector<int> > presyn_map;
+
+    double wtime(){
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        return tv.tv_sec + tv.tv_usec*1e-6;
+    }
+
+    /** copy the presyns of gids in a std::map */
+    template<class F>
+    void copy(const std::vector<int>& gids, F find, const environment::presyn_maker& p,
+              presyn_map& m){
+        for(std::size_t i = 0; i < gids.size(); ++i){
+            const environment::presyn* ps = (p.*find)(gids[i]);
+            m[gids[i]].assign(ps->begin(), ps->end());
+        }
+    }
+
+    /** time the lookups of keys in the map, returns ns per lookup */
+    double time_map(const presyn_map& m, const std::vector<int>& keys, long& checksum){
+        double t = wtime();
+        for(std::size_t i = 0; i < keys.size(); ++i){
+            presyn_map::const_iterator it = m.find(keys[i]);
+            if(it != m.end())
+                checksum += it->second.size();
+        }
+        return (wtime() - t)*1e9/keys.size();
+    }
+
+    /** time the lookups of keys in the presyn_maker, returns ns per lookup */
+    template<class F>
+    double time_table(F find, const environment::presyn_maker& p,
+                      const std::vector<int>& keys, long& checksum){
+        double t = wtime();
+        for(std::size_t i = 0; i < keys.size(); ++i){
+            const environment::presyn* ps = (p.*find)(keys[i]);
+            if(ps != NULL)
+                checksum += ps->size();
+        }
+        return (wtime() - t)*1e9/keys.size();
+    }
+
+} // end namespace
+
+int main(int argc, char* argv[]){
+    const int ncells = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+    const int nprocs = (argc > 2) ? std::atoi(argv[2]) : 64;
+    const int fanin = (argc > 3) ? std::atoi(argv[3]) : 1000;
+    const int nlookups = (argc > 4) ? std::atoi(argv[4]) : 10000000;
+    if(ncells < nprocs || nprocs < 1 || nlookups < 1){
+        std::cout << "usage: presyn_benchmark [ncells] [nprocs] [fanin] [nlookups]" << std::endl;
+        return mapp::MAPP_BAD_ARG;
+    }
+
+    typedef const environment::presyn* (environment::presyn_maker::*finder)(int) const;
+    const finder find_input = &environment::presyn_maker::find_input;
+    const finder find_output = &environment::presyn_maker::find_output;
+
+    environment::continousdistribution neuro_dist(nprocs, 0, ncells);
+    environment::presyn_maker presyns(fanin);
+    presyns(0, &neuro_dist);
+
+    presyn_map inputs, outputs;
+    copy(presyns.input_gids(), find_input, presyns, inputs);
+    copy(presyns.output_gids(), find_output, presyns, outputs);
+
+    std::cout << "gids: " << ncells << ", input presyns: " << inputs.size()
+              << ", output presyns: " << outputs.size() << std::endl;
+
+    //received spikes: any gid, local spikes: the local gids
+    std::vector<int> received(nlookups), local(nlookups);
+    srand(1);
+    for(int i = 0; i < nlookups; ++i){
+        received[i] = rand() % ncells;
+        local[i] = neuro_dist.local2global(rand() % neuro_dist.getlocalcells());
+    }
+
+    long map_sum = 0, table_sum = 0;
+    const double map_in = time_map(inputs, received, map_sum);
+    const double table_in = time_table(find_input, presyns, received, table_sum);
+    const double map_out = time_map(outputs, local, map_sum);
+    const double table_out = time_table(find_output, presyns, local, table_sum);
+    if(map_sum != table_sum){
+        std::cout << "Error: the lookups differ" << std::endl;
+        return mapp::MAPP_BAD_DATA;
+    }
+
+    std::cout << std::setw(14) << "lookup" << std::setw(14) << "map [ns]"
+              << std::setw(14) << "flat [ns]" << std::endl;
+    std::cout << std::setw(14) << "find_input" << std::setw(14) << map_in
+              << std::setw(14) << table_in << std::endl;
+    std::cout << std::setw(14) << "find_output" << std::setw(14) << map_out
+              << std::setw(14) << table_out << std::endl;
+    return mapp::MAPP_OK;
+}
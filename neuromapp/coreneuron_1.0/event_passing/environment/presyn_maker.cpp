@@ -12,16 +12,85 @@
 
 namespace environment {
 
+presyn_table::presyn_table(const presyn_table& other):
+    gids_(other.gids_), offsets_(other.offsets_), targets_(other.targets_),
+    first_(other.first_), stride_(other.stride_), slots_(other.slots_){
+    make_views();
+}
+
+presyn_table& presyn_table::operator=(const presyn_table& other){
+    if(this != &other){
+        gids_ = other.gids_;
+        offsets_ = other.offsets_;
+        targets_ = other.targets_;
+        first_ = other.first_;
+        stride_ = other.stride_;
+        slots_ = other.slots_;
+        make_views();
+    }
+    return *this;
+}
+
+void presyn_table::make_views(){
+    views_.resize(gids_.size());
+    for(size_t i = 0; i < gids_.size(); ++i)
+        views_[i] = presyn(targets_.empty() ? NULL : &targets_[0] + offsets_[i],
+                           offsets_[i+1] - offsets_[i]);
+}
+
+void presyn_table::build(const std::map<int, std::vector<int> >& m){
+    gids_.clear();
+    offsets_.assign(1, 0);
+    targets_.clear();
+    gids_.reserve(m.size());
+    offsets_.reserve(m.size() + 1);
+    for(std::map<int, std::vector<int> >::const_iterator it = m.begin(); it != m.end(); ++it){
+        gids_.push_back(it->first);
+        targets_.insert(targets_.end(), it->second.begin(), it->second.end());
+        offsets_.push_back(targets_.size());
+    }
+    make_views();
+
+    //the gids are sorted, an arithmetic progression is indexed directly
+    first_ = gids_.empty() ? 0 : gids_[0];
+    stride_ = gids_.size() < 2 ? 1 : gids_[1] - gids_[0];
+    for(size_t i = 2; i < gids_.size() && stride_ != 0; ++i)
+        if(gids_[i] - gids_[i-1] != stride_)
+            stride_ = 0;
+
+    slots_.clear();
+    if(stride_ == 0){
+        size_t n = 1;
+        while(n < 2*gids_.size())
+            n <<= 1;
+        slots_.assign(n, -1);
+        for(size_t i = 0; i < gids_.size(); ++i){
+            size_t s = hash(gids_[i]) & (n - 1);
+            while(slots_[s] >= 0)
+                s = (s + 1) & (n - 1);
+            slots_[s] = i;
+        }
+    }
+}
+
 void presyn_maker::operator()(int rank, neurondistribution* neuron_dist){
+    (*this)(rank, neuron_dist, time(NULL));
+}
+
+void presyn_maker::operator()(int rank, neurondistribution* neuron_dist, unsigned seed){
+    //built in maps, then flattened in the presyn tables
+    std::map<int, std::vector<int> > inputs;
+    std::map<int, std::vector<int> > outputs;
+
     //create local presyns with empty vectors
     for(int i = 0; i < neuron_dist->getlocalcells(); ++i){
         const int gid = neuron_dist->local2global(i);
-        outputs_[gid];
+        outputs[gid];
     }
 
     if (degree_==fixedindegree) {
         //used for random presyn and netcon selection
-        boost::mt19937 rng(time(NULL) + rank);
+        boost::mt19937 rng(seed + rank);
         boost::random::uniform_int_distribution<> uni_d(0, neuron_dist->getglobalcells()-1);
 
         //foreach gid, select srcs
@@ -32,13 +101,13 @@ void presyn_maker::operator()(int rank, neurondistribution* neuron_dist){
                 if(neuron_dist->isLocal(cur)){
                     //add self to src gid
                     const int g_i = neuron_dist->local2global(i);
-                    outputs_[cur].push_back(g_i);
+                    outputs[cur].push_back(g_i);
                 }
                 //remote GID
                 else{
                     //add self to input presyn for gid
                     const int g_i = neuron_dist->local2global(i);
-                    inputs_[cur].push_back(g_i);
+                    inputs[cur].push_back(g_i);
                 }
             }
         }
@@ -57,37 +126,20 @@ void presyn_maker::operator()(int rank, neurondistribution* neuron_dist){
                 if(neuron_dist->isLocal(picked)) {
                     if(neuron_dist->isLocal(cur)){
                         //add self to src gid
-                        outputs_[cur].push_back(picked);
+                        outputs[cur].push_back(picked);
                     }
                     //remote GID
                     else{
                         //add self to input presyn for gid
-                        inputs_[cur].push_back(picked);
+                        inputs[cur].push_back(picked);
                     }
                 }
             }
         }
     }
-}
 
-const presyn* presyn_maker::find_input(int key) const{
-    std::map<int, std::vector<int> >::const_iterator it = inputs_.begin();
-    const presyn* input_ptr = NULL;
-    it = inputs_.find(key);
-    if(it != inputs_.end()){
-        input_ptr = &(it->second);
-    }
-    return input_ptr;
-}
-
-const presyn* presyn_maker::find_output(int key) const{
-    std::map<int, std::vector<int> >::const_iterator it = outputs_.begin();
-    const presyn* output_ptr = NULL;
-    it = outputs_.find(key);
-    if(it != outputs_.end()){
-        output_ptr = &(it->second);
-    }
-    return output_ptr;
+    inputs_.build(inputs);
+    outputs_.build(outputs);
 }
 
 } //end of namespace
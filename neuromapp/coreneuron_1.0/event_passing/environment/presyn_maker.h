@@ -27,13 +27,107 @@
 #define MAPP_PRESYN_MAKER_H
 
 #include <map>
+#include <vector>
+#include <cstddef>
 
 #include "coreneuron_1.0/event_passing/environment/generator.h"
 #include "coreneuron_1.0/event_passing/environment/neurondistribution.h"
 
 namespace environment {
 
-typedef std::vector<int> presyn;
+/** \class presyn
+ *  \brief the targets of a gid, a view in the flat array of a presyn_table
+ */
+class presyn {
+private:
+    const int* data_;
+    size_t size_;
+public:
+    explicit presyn(const int* data = NULL, size_t size = 0): data_(data), size_(size) {}
+
+    /** \fn size()
+     *  \return the number of targets
+     */
+    size_t size() const {return size_;}
+
+    /** \fn empty()
+     *  \return true if the gid has no target
+     */
+    bool empty() const {return size_ == 0;}
+
+    /** \fn operator[](size_t i)
+     *  \return the gid of the target i
+     */
+    const int& operator[](size_t i) const {return data_[i];}
+
+    const int* begin() const {return data_;}
+    const int* end() const {return data_ + size_;}
+};
+
+/** \class presyn_table
+ *  \brief flat storage of the presyns of a set of gids.
+ *
+ *  The targets of all the gids are in a single array (CSR), the offsets are in
+ *  the order of the sorted gids. A lookup is an index computation when the gids
+ *  are an arithmetic progression (the local gids of a continous or a nest
+ *  distribution), else a probe of an open addressing hash table (linear probing,
+ *  load factor <= 1/2). No tree, no allocation per gid.
+ */
+class presyn_table {
+private:
+    std::vector<int> gids_;
+    std::vector<int> offsets_;
+    std::vector<int> targets_;
+    std::vector<presyn> views_;
+    /// arithmetic progression first_ + i*stride_, stride_ is 0 for the hash table
+    int first_;
+    int stride_;
+    /// index in gids_ of the gid hashed there, -1 if empty
+    std::vector<int> slots_;
+
+    static size_t hash(int gid){
+        unsigned int h = static_cast<unsigned int>(gid) * 2654435761u;
+        return h ^ (h >> 16);
+    }
+
+    void make_views();
+
+public:
+    presyn_table(): first_(0), stride_(0) {}
+    presyn_table(const presyn_table& other);
+    presyn_table& operator=(const presyn_table& other);
+
+    /** \fn build(const std::map<int, std::vector<int> >& m)
+     *  \brief replaces the content by the presyns of m, gid -> targets
+     */
+    void build(const std::map<int, std::vector<int> >& m);
+
+    /** \fn find(int gid)
+     *  \return the presyn of gid, NULL if gid is not in the table
+     */
+    inline const presyn* find(int gid) const {
+        if(stride_ != 0){
+            const int d = gid - first_;
+            if(d < 0 || d % stride_ != 0)
+                return NULL;
+            const size_t i = d / stride_;
+            return i < views_.size() ? &views_[i] : NULL;
+        }
+        if(slots_.empty())
+            return NULL;
+        const size_t mask = slots_.size() - 1;
+        for(size_t s = hash(gid) & mask; slots_[s] >= 0; s = (s + 1) & mask)
+            if(gids_[slots_[s]] == gid)
+                return &views_[slots_[s]];
+        return NULL;
+    }
+
+    /** \fn gids()
+     *  \return the sorted gids of the table
+     */
+    const std::vector<int>& gids() const {return gids_;}
+};
+
 enum degree {fixedindegree, fixedoutdegree};
 /** presyn_maker
  * creates input and output presyns required for spike exchange
@@ -42,8 +136,8 @@ class presyn_maker {
 private:
     int fan_;
     degree degree_;
-    std::map<int, presyn> inputs_;
-    std::map<int, presyn> outputs_;
+    presyn_table inputs_;
+    presyn_table outputs_;
 public:
     /** \fn presyn_maker(int ncells, int fanin)
      *  \brief creates the presyn_maker and sets member variables
@@ -61,6 +155,15 @@ public:
      */
     void operator()(int rank, neurondistribution* neuron_dist);
 
+    /** \fn void operator()(int rank, neurondistribution* neuron_dist, unsigned seed)
+     *  \brief generates both the input and output presyns, the fixed in degree
+     *  connectivity is drawn from seed + rank: a run is reproduced with its seed
+     *  \param rank the rank of the current process
+     *  \param neuron_dist the distribution of the cells
+     *  \param seed the seed of the connectivity, time(NULL) by default
+     */
+    void operator()(int rank, neurondistribution* neuron_dist, unsigned seed);
+
 //GETTERS
 
     /** \fn find_input(int id, presyn& ps)
@@ -71,7 +174,7 @@ public:
      *  only valid if find_input returns true.
      *  \return true if matching presyn is found, else false
      */
-    const presyn* find_input(int key) const;
+    const presyn* find_input(int key) const {return inputs_.find(key);}
 
     /** \fn find_output(int key, presyn& ps)
      *  \brief searches for an out presyn(OP) matching the parameter key. If
@@ -81,7 +184,17 @@ public:
      *  only valid if find_output returns true.
      *  \return true if matching presyn is found, else false
      */
-    const presyn* find_output(int key) const;
+    const presyn* find_output(int key) const {return outputs_.find(key);}
+
+    /** \fn input_gids()
+     *  \return the sorted gids of the input presyns
+     */
+    const std::vector<int>& input_gids() const {return inputs_.gids();}
+
+    /** \fn output_gids()
+     *  \return the sorted gids of the output presyns, the local gids
+     */
+    const std::vector<int>& output_gids() const {return outputs_.gids();}
 };
 
 } //end of namespace
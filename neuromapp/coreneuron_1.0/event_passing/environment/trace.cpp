@@ -0,0 +1,218 @@
+/*
+ * Neuromapp - trace.cpp, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/environment/trace.cpp
+ * \brief Records and replays the events of an event_generator, imports spike trains
+ */
+
+#include <stdint.h>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <vector>
+
+#include "coreneuron_1.0/event_passing/environment/trace.h"
+#include "utils/error.h"
+
+namespace environment {
+
+namespace {
+
+    const char magic[4] = {'N', 'M', 'T', 'R'};
+    const uint32_t version = 2;
+
+    /** appends the n bytes of v, little endian */
+    void put(std::vector<unsigned char>& out, uint64_t v, int n){
+        for(int i = 0; i < n; ++i)
+            out.push_back(static_cast<unsigned char>(v >> (8*i)));
+    }
+
+    /** reads the n bytes of a little endian integer, false at the end of the stream */
+    bool get(std::istream& in, uint64_t& v, int n){
+        unsigned char b[8];
+        if(!in.read(reinterpret_cast<char*>(b), n))
+            return false;
+        v = 0;
+        for(int i = 0; i < n; ++i)
+            v |= static_cast<uint64_t>(b[i]) << (8*i);
+        return true;
+    }
+
+    /** appends v as a LEB128 varint, 7 bits per byte */
+    void put_varint(std::vector<unsigned char>& out, uint64_t v){
+        while(v >= 0x80){
+            out.push_back(static_cast<unsigned char>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<unsigned char>(v));
+    }
+
+    /** reads a LEB128 varint from [p, end), false if truncated */
+    bool get_varint(const unsigned char*& p, const unsigned char* end, uint64_t& v){
+        v = 0;
+        for(int shift = 0; p != end && shift < 64; shift += 7){
+            const unsigned char b = *p++;
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if(!(b & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    bool earlier(const gen_event& a, const gen_event& b){
+        return a.second < b.second;
+    }
+
+} // end namespace
+
+std::string trace_name(const std::string& prefix, int rank){
+    std::stringstream name;
+    name << prefix << "." << rank;
+    return name.str();
+}
+
+int write_trace(const std::string& file, const event_generator& generator, unsigned seed){
+    const int ngroups = generator.end() - generator.begin();
+    std::vector<unsigned char> out(magic, magic + 4);
+    put(out, version, 4);
+    put(out, ngroups, 4);
+    put(out, seed, 4);
+
+    std::vector<unsigned char> events;
+    for(event_generator::const_iterator it = generator.begin(); it != generator.end(); ++it){
+        events.clear();
+        const uint64_t count = it->size();
+        long previous = 0;
+        for(event_pool::const_iterator e_it = it->begin(); e_it != it->end(); ++e_it){
+            const gen_event& e = *e_it;
+            const long step = static_cast<long>(e.second);
+            if(e.first < 0 || step != e.second || step < previous)
+                return mapp::MAPP_BAD_DATA;
+            put_varint(events, e.first);
+            put_varint(events, step - previous);
+            previous = step;
+        }
+        put(out, count, 8);
+        put(out, events.size(), 8);
+        out.insert(out.end(), events.begin(), events.end());
+    }
+
+    std::ofstream f(file.c_str(), std::ios::binary);
+    if(!f.write(reinterpret_cast<const char*>(&out[0]), out.size()))
+        return mapp::MAPP_BAD_ARG;
+    return mapp::MAPP_OK;
+}
+
+int read_trace(const std::string& file, event_generator& generator, unsigned& seed){
+    std::ifstream f(file.c_str(), std::ios::binary);
+    if(!f)
+        return mapp::MAPP_BAD_ARG;
+    f.seekg(0, std::ios::end);
+    const uint64_t size = f.tellg();
+    f.seekg(0, std::ios::beg);
+
+    char m[4];
+    uint64_t v, ngroups, s;
+    if(!f.read(m, 4) || std::memcmp(m, magic, 4) != 0 || !get(f, v, 4) || v != version
+       || !get(f, ngroups, 4) || ngroups != static_cast<uint64_t>(generator.end() - generator.begin())
+       || !get(f, s, 4))
+        return mapp::MAPP_BAD_DATA;
+    seed = static_cast<unsigned>(s);
+
+    std::vector<unsigned char> events;
+    for(event_generator::iterator it = generator.begin(); it != generator.end(); ++it){
+        uint64_t count, nbytes;
+        //an event takes 2 bytes at least, the sizes can not exceed the file
+        if(!get(f, count, 8) || !get(f, nbytes, 8)
+           || nbytes > size - static_cast<uint64_t>(f.tellg()) || count > nbytes/2)
+            return mapp::MAPP_BAD_DATA;
+        events.resize(nbytes + 1); // never an empty buffer
+        if(!f.read(reinterpret_cast<char*>(&events[0]), nbytes))
+            return mapp::MAPP_BAD_DATA;
+
+        const unsigned char* p = &events[0];
+        const unsigned char* end = p + nbytes;
+        uint64_t gid, delta;
+        long step = 0;
+        it->reserve(count);
+        for(uint64_t i = 0; i < count; ++i){
+            if(!get_varint(p, end, gid) || !get_varint(p, end, delta))
+                return mapp::MAPP_BAD_DATA;
+            step += delta;
+            it->push(gen_event(static_cast<int>(gid), static_cast<double>(step)));
+        }
+    }
+    return mapp::MAPP_OK;
+}
+
+int import_spikes(const std::string& file, bool binary, double dt,
+                  const neurondistribution& neuron_dist, event_generator& generator){
+    std::ifstream f(file.c_str(), binary ? std::ios::in | std::ios::binary : std::ios::in);
+    if(!f || dt <= 0.)
+        return mapp::MAPP_BAD_ARG;
+
+    const int ngroups = generator.end() - generator.begin();
+    std::vector<std::vector<gen_event> > groups(ngroups);
+    double t;
+    long gid;
+    for(;;){
+        if(binary){
+            uint64_t time_bits, gid_bits;
+            if(!get(f, time_bits, 8))
+                break;
+            if(!get(f, gid_bits, 4))
+                return mapp::MAPP_BAD_DATA;
+            std::memcpy(&t, &time_bits, sizeof(t));
+            gid = static_cast<int32_t>(gid_bits);
+        }
+        else{
+            std::string line;
+            if(!std::getline(f, line))
+                break;
+            std::replace(line.begin(), line.end(), ',', ' ');
+            const size_t first = line.find_first_not_of(" \t\r");
+            if(first == std::string::npos || line[first] == '#')
+                continue;
+            std::istringstream record(line);
+            if(!(record >> t >> gid))
+                return mapp::MAPP_BAD_DATA;
+        }
+        if(gid < 0 || t < 0.)
+            return mapp::MAPP_BAD_DATA;
+        if(gid < neuron_dist.getglobalcells() && neuron_dist.isLocal(gid))
+            groups[gid % ngroups].push_back(gen_event(gid, std::floor(t/dt + 0.5)));
+    }
+
+    event_generator::iterator it = generator.begin();
+    for(int i = 0; i < ngroups; ++i, ++it){
+        std::stable_sort(groups[i].begin(), groups[i].end(), earlier);
+        it->reserve(groups[i].size());
+        for(size_t j = 0; j < groups[i].size(); ++j)
+            it->push(groups[i][j]);
+    }
+    return mapp::MAPP_OK;
+}
+
+} //end of namespace
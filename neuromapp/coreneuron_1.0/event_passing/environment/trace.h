@@ -0,0 +1,83 @@
+/*
+ * Neuromapp - trace.h, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/environment/trace.h
+ * \brief Records and replays the events of an event_generator, imports spike trains
+ */
+
+#ifndef MAPP_TRACE_H
+#define MAPP_TRACE_H
+
+#include <string>
+
+#include "coreneuron_1.0/event_passing/environment/generator.h"
+#include "coreneuron_1.0/event_passing/environment/neurondistribution.h"
+
+namespace environment {
+
+/** Format of a trace, one file per rank (see trace_name), little endian:
+ *  - "NMTR", the version (uint32), the number of cell groups (uint32), the seed of the
+ *    connectivity (uint32, see presyn_maker)
+ *  - per cell group: the number of events (uint64), the number of bytes (uint64), then
+ *    per event the gid and the time step minus the previous one, as LEB128 varints
+ *
+ *  The times of a cell group are whole time steps, in increasing order (as generated),
+ *  an event costs 2 to 5 bytes instead of the 16 of a gen_event.
+ */
+
+/** \fn std::string trace_name(const std::string& prefix, int rank)
+ *  \return the file of the trace of a rank, prefix.rank
+ */
+std::string trace_name(const std::string& prefix, int rank);
+
+/** \fn int write_trace(const std::string& file, const event_generator& generator,
+ *      unsigned seed)
+ *  \brief records the events of every cell group of generator
+ *  \param seed the seed of the connectivity of the run
+ *  \return MAPP_OK, MAPP_BAD_ARG if the file can not be written, MAPP_BAD_DATA if the
+ *  times of a cell group are not whole steps in increasing order
+ */
+int write_trace(const std::string& file, const event_generator& generator, unsigned seed);
+
+/** \fn int read_trace(const std::string& file, event_generator& generator, unsigned& seed)
+ *  \brief replays a trace, its events are appended to the cell groups of generator
+ *  \param seed the seed of the connectivity of the recorded run
+ *  \return MAPP_OK, MAPP_BAD_ARG if the file can not be read, MAPP_BAD_DATA if it is not
+ *  a trace, if its number of cell groups differs or if a size exceeds the file
+ */
+int read_trace(const std::string& file, event_generator& generator, unsigned& seed);
+
+/** \fn int import_spikes(const std::string& file, bool binary, double dt,
+ *      const neurondistribution& neuron_dist, event_generator& generator)
+ *  \brief imports the spike train of a simulation, the spikes of the local gids go to the
+ *  cell group gid % ngroups, in time order
+ *  \param binary the records are float64 time and int32 gid (little endian), else a text
+ *  line "time gid" or "time,gid" per spike (out.dat), the lines starting with # are skipped
+ *  \param dt the time step of the spike times, the times are rounded to steps
+ *  \return MAPP_OK, MAPP_BAD_ARG if the file can not be read, MAPP_BAD_DATA if a record
+ *  is malformed
+ */
+int import_spikes(const std::string& file, bool binary, double dt,
+                  const neurondistribution& neuron_dist, event_generator& generator);
+
+} //end of namespace
+
+#endif
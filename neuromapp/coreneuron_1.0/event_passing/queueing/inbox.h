@@ -0,0 +1,159 @@
+/*
+ * Neuromapp - inbox.h, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/queueing/inbox.h
+ * \brief Contains the lock-free inbox class declaration.
+ */
+
+#ifndef MAPP_INBOX_H_
+#define MAPP_INBOX_H_
+
+#include <vector>
+#include <iterator>
+#include <new>
+#include <cstddef>
+
+#include "coreneuron_1.0/event_passing/queueing/queue.h"
+
+namespace queueing {
+
+/** \class inbox
+ *  \brief multi-producer/single-consumer list of batches of events without lock.
+ *
+ *  A sender copies its events for this inbox in a batch, a single allocation holding
+ *  the events inline, and publishes it on the head of a linked list with one
+ *  compare-and-swap. The owner takes the whole list at once with an atomic exchange.
+ *  The cost of the allocation and of the contended atomic operations is per batch, the
+ *  senders should gather their events per destination first (see basic_pool). The
+ *  atomic operations are the __sync builtins (GCC, Clang, Intel, XL), the code is C++98.
+ */
+class inbox {
+private:
+    /** the header of a batch, its events follow it in the same allocation */
+    struct batch {
+        batch* next_;
+        size_t size_;
+        event* events() {return reinterpret_cast<event*>(this + 1);}
+    };
+
+    batch* head_;
+    size_t size_;
+
+    static void release(batch* b){
+        for(size_t i = 0; i < b->size_; ++i)
+            b->events()[i].~event();
+        ::operator delete(b);
+    }
+
+public:
+    /** \fn inbox()
+     *  \brief creates an empty inbox
+     */
+    inbox(): head_(NULL), size_(0) {}
+
+    /** \fn inbox(const inbox&)
+     *  \brief the events are not copied, the copy is an empty inbox
+     */
+    inbox(const inbox&): head_(NULL), size_(0) {}
+
+    /** \fn operator=(const inbox&)
+     *  \brief the events are not copied, the inbox keeps its own events
+     */
+    inbox& operator=(const inbox&) {return *this;}
+
+    /** \fn ~inbox()
+     *  \brief frees the events never drained
+     */
+    ~inbox(){
+        while(head_ != NULL){
+            batch* b = head_;
+            head_ = b->next_;
+            release(b);
+        }
+    }
+
+    /** \fn void push(Iterator first, Iterator last)
+     *  \brief adds the events [first, last) as a single batch, may be called
+     *  concurrently by any number of threads
+     */
+    template<class Iterator>
+    void push(Iterator first, Iterator last){
+        const size_t n = std::distance(first, last);
+        if(n == 0)
+            return;
+        batch* b = static_cast<batch*>(::operator new(sizeof(batch) + n*sizeof(event)));
+        b->size_ = n;
+        event* e = b->events();
+        for(; first != last; ++first, ++e)
+            new (e) event(*first);
+        // counted first, the owner never removes more events than counted
+        __sync_fetch_and_add(&size_, n);
+        batch* old;
+        do {
+            old = head_;
+            b->next_ = old;
+        } while(!__sync_bool_compare_and_swap(&head_, old, b));
+    }
+
+    /** \fn void push(const event& ev)
+     *  \brief adds a single event, a batch of one
+     *  \param ev the event
+     */
+    void push(const event& ev){
+        push(&ev, &ev + 1);
+    }
+
+    /** \fn size_t drain(std::vector<event>& v)
+     *  \brief moves all the events to the end of v, the batches in their arrival
+     *  order, only the owner may call it, concurrently with the push
+     *  \param v receives the events
+     *  \return the number of events moved
+     */
+    size_t drain(std::vector<event>& v){
+        batch* b = __sync_lock_test_and_set(&head_, (batch*)NULL);
+        // the list is last in first out
+        batch* fifo = NULL;
+        while(b != NULL){
+            batch* next = b->next_;
+            b->next_ = fifo;
+            fifo = b;
+            b = next;
+        }
+        const size_t first = v.size();
+        while(fifo != NULL){
+            batch* next = fifo->next_;
+            v.insert(v.end(), fifo->events(), fifo->events() + fifo->size_);
+            release(fifo);
+            fifo = next;
+        }
+        const size_t count = v.size() - first;
+        __sync_fetch_and_sub(&size_, count);
+        return count;
+    }
+
+    /** \fn size_t size()
+     *  \return the number of events not drained, exact when no push is in progress
+     */
+    size_t size() const {return size_;}
+};
+
+} //end of namespace
+#endif
@@ -0,0 +1,132 @@
+/*
+ * Neuromapp - ite_benchmark.cpp, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/queueing/ite_benchmark.cpp
+ * \brief Compare the throughput of the inter thread events of the cell groups
+ *
+ * Every OMP thread owns a cell group. Every step, a group sends nevents events to random
+ * groups, with a delay of [1, maxdelay] steps, then enqueues its inter thread events and
+ * delivers the events due. The groups synchronize every mindelay steps, like the pool.
+ * The paths compared:
+ *  - locked: inter_thread_events_ protected by a lock, then the binary heap
+ *  - lockfree: a batch per destination and step in the lock-free inbox, then the binary heap
+ *  - concurrent: the senders insert in the bins of the concurrent_bin_queue
+ * The throughput is in millions of events per second (sent and delivered).
+ *
+ * usage: ite_benchmark [nevents] [nsteps] [mindelay] [maxdelay]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdlib>
+
+#include "coreneuron_1.0/event_passing/queueing/thread.h"
+#include "utils/omp/compatibility.h"
+#include "utils/error.h"
+
+namespace {
+
+    /** runs the steps on the groups, returns the throughput (M events/s) */
+    template<class Q>
+    double run(bool lock_free, int nevents, int nsteps, int mindelay, int maxdelay,
+               long& delivered){
+        const int ngroups = omp_get_max_threads();
+        std::vector<queueing::basic_nrn_thread_data<Q> > groups(ngroups,
+            queueing::basic_nrn_thread_data<Q>(lock_free));
+
+        // every event is delivered by the last steps
+        const int last = nsteps + maxdelay + mindelay;
+        const double start = omp_get_wtime();
+        #pragma omp parallel
+        {
+            const int id = omp_get_thread_num();
+            unsigned int seed = id + 1;
+            queueing::basic_nrn_thread_data<Q>& group = groups[id];
+            std::vector<std::vector<queueing::event> > outboxes(ngroups);
+            for(int step = 0; step < last; ++step){
+                const int t = group.get_time();
+                for(int i = 0; step < nsteps && i < nevents; ++i){
+                    const int dest = rand_r(&seed) % ngroups;
+                    const double tt = t + 1 + rand_r(&seed) % maxdelay;
+                    if(dest == id)
+                        group.self_send(i, tt);
+                    else if(lock_free)
+                        outboxes[dest].push_back(queueing::event(i, tt));
+                    else
+                        groups[dest].inter_thread_send(i, tt);
+                }
+                for(int d = 0; lock_free && d < ngroups; ++d){
+                    if(!outboxes[d].empty()){
+                        groups[d].inter_thread_publish(outboxes[d]);
+                        outboxes[d].clear();
+                    }
+                }
+                group.enqueue_my_events();
+                group.deliver_batch();
+                group.increment_time();
+                if((step + 1) % mindelay == 0){
+                    #pragma omp barrier
+                }
+            }
+        }
+        const double elapsed = omp_get_wtime() - start;
+
+        delivered = 0;
+        for(int i = 0; i < ngroups; ++i){
+            groups[i].enqueue_my_events();
+            delivered += groups[i].delivered_;
+        }
+        return static_cast<double>(nevents)*nsteps*ngroups/elapsed*1e-6;
+    }
+
+} // end namespace
+
+int main(int argc, char* argv[]){
+    const int nevents = (argc > 1) ? std::atoi(argv[1]) : 1000;
+    const int nsteps = (argc > 2) ? std::atoi(argv[2]) : 1000;
+    const int mindelay = (argc > 3) ? std::atoi(argv[3]) : 5;
+    const int maxdelay = (argc > 4) ? std::atoi(argv[4]) : 10;
+    if(nevents < 1 || nsteps < 1 || mindelay < 1 || maxdelay < mindelay){
+        std::cout << "usage: ite_benchmark [nevents] [nsteps] [mindelay] [maxdelay]" << std::endl;
+        return mapp::MAPP_BAD_ARG;
+    }
+
+    const long sent = static_cast<long>(nevents)*nsteps*omp_get_max_threads();
+    long delivered[3];
+    const double locked = run<queueing::queue>(false, nevents, nsteps, mindelay, maxdelay, delivered[0]);
+    const double lockfree = run<queueing::queue>(true, nevents, nsteps, mindelay, maxdelay, delivered[1]);
+    const double concurrent = run<queueing::concurrent_bin_queue>(false, nevents, nsteps, mindelay,
+                                                                  maxdelay, delivered[2]);
+    for(int i = 0; i < 3; ++i){
+        if(delivered[i] != sent){
+            std::cout << "Error: " << delivered[i] << " events delivered out of " << sent << std::endl;
+            return mapp::MAPP_BAD_DATA;
+        }
+    }
+
+    std::cout << "threads: " << omp_get_max_threads() << ", events: " << sent << std::endl;
+    std::cout << std::setw(14) << "locked" << std::setw(14) << "lockfree"
+              << std::setw(14) << "concurrent" << "  [M events/s]" << std::endl;
+    std::cout << std::setw(14) << locked << std::setw(14) << lockfree
+              << std::setw(14) << concurrent << std::endl;
+    return mapp::MAPP_OK;
+}
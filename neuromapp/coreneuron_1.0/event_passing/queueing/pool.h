@@ -20,7 +20,7 @@
 
 /**
  * @file neuromapp/coreneuron_1.0/event_passing/queueing/pool.h
- * \brief Contains pool class declaration.
+ * \brief Contains basic_pool class declaration.
  */
 
 #ifndef MAPP_POOL_H_
@@ -37,29 +37,82 @@
 
 namespace queueing {
 
-class pool {
+/** \class basic_pool
+ *  \brief the cell groups of a rank
+ *  \param Q the event container of the cell groups, see basic_nrn_thread_data
+ */
+template<class Q>
+class basic_pool {
 private:
     bool perform_algebra_;
+    bool fused_algebra_;
     int min_delay_;
     int time_;
     int rank_;
     spike::spike_interface& spike_;
-    std::vector<nrn_thread_data> thread_datas_;
+    std::vector<basic_nrn_thread_data<Q> > thread_datas_;
+    /// send the events through the thread local buffers, merged once per fixed_step
+    bool buffered_;
+    /// spikes of every cell group, merged in spike_.spikeout_
+    std::vector<std::vector<event> > spikeout_buffers_;
+    /// send the inter thread events of a step as one batch per destination (lock-free inboxes)
+    bool batched_;
+    /// inter thread events, ngroups*ngroups buffers indexed by sender*ngroups + destination
+    std::vector<std::vector<event> > ite_buffers_;
+    /// events of filter(), ngroups*ngroups buffers indexed by slice*ngroups + destination
+    std::vector<std::vector<event> > filter_buffers_;
+    /// run the cell groups as OMP tasks, else a static schedule
+    bool tasks_;
+    /// per thread time (s) running cell groups, during the last fixed_step and in total
+    std::vector<double> step_busy_;
+    std::vector<double> busy_;
+    /// per thread time (s) waiting at the end of the fixed steps
+    std::vector<double> idle_;
+
+    /** \fn merge_buffers()
+     *  \brief moves the content of the thread local buffers to spike_.spikeout_
+     *  (prefix sum of the sizes and parallel copy) and to the destination cell groups
+     */
+    void merge_buffers();
+
+    /** \fn run_group(int i, G& generator, const P& presyns)
+     *  \brief runs the min_delay_ time steps of the cell group i, the time is
+     *  added to step_busy_ of the calling thread
+     */
+    template <typename G, typename P>
+    void run_group(int i, G& generator, const P& presyns);
 
 public:
 
-    /** \fn pool(bool algebra, int ngroups, int min_delay, int rank,
-     * spike_interface& s_interface)
+    /** \fn basic_pool(bool algebra, int ngroups, int min_delay, int rank,
+     * spike_interface& s_interface, bool fused, bool lock_free, bool buffered)
      *  \brief initializes a pool with a thread_datas_ array of size ngroups.
      *  \param algebra determines whether to perform linear algebra calculations
      *  \param ngroups the number of cell groups per node
      *  \param s_interface the spike interface used to communicate
      *  with the spike exchange algos
+     *  \param fused use the fused sweeps in the linear algebra, see nrn_thread_data::l_algebra
+     *  \param lock_free the inter thread events go through the lock-free inboxes, the
+     *  events of a cell group for another one are published as a batch every time step
+     *  \param buffered the spikes and the inter thread events are kept in thread local
+     *  buffers, merged at the end of every fixed_step without lock. The inter thread events
+     *  are then enqueued at the beginning of the next fixed_step, min_delay_ later at most
+     *  \param tasks every cell group is an OMP task of fixed_step, the idle threads take
+     *  the waiting groups (work-stealing of the OMP runtime), else schedule(static,1)
      */
-    pool(bool algebra, int ngroups, int md, int rank,
-    spike::spike_interface& s_interface): perform_algebra_(algebra),
-    min_delay_(md), time_(0), rank_(rank), spike_(s_interface)
-    {thread_datas_.resize(ngroups);}
+    basic_pool(bool algebra, int ngroups, int md, int rank,
+    spike::spike_interface& s_interface, bool fused = false, bool lock_free = false,
+    bool buffered = false, bool tasks = false):
+    perform_algebra_(algebra), fused_algebra_(fused), min_delay_(md), time_(0), rank_(rank),
+    spike_(s_interface), buffered_(buffered),
+    batched_(lock_free && !buffered && !is_concurrent<Q>::value), tasks_(tasks) {
+        thread_datas_.resize(ngroups, basic_nrn_thread_data<Q>(lock_free));
+        filter_buffers_.resize(ngroups*ngroups);
+        if(buffered_)
+            spikeout_buffers_.resize(ngroups);
+        if(buffered_ || batched_)
+            ite_buffers_.resize(ngroups*ngroups);
+    }
 
     /** \fn send_events(const int myID, G& generator, const P& presyns)
      *  \brief sends event to it's destination
@@ -75,7 +128,7 @@ public:
      *  \brief performs (min_delay_) iterations of a timestep in which:
      *      - events are sent
      *      - events are enqueued
-     *      - events are delivered
+     *      - events are delivered, in a batch per time step
      *      - linear algebra is performed
      *  \param generator the event generator from which events are taken
      *  \precond generator has been initialized
@@ -89,7 +142,11 @@ public:
     /** \fn void filter(const P& presyns)
      *  \brief filters out relevent events(using the function matches()),
      *  and randomly selects a destination cellgroup, and delivers them
-     *  using a no-lock inter_thread_send
+     *  using a no-lock inter_thread_send.
+     *
+     *  Every thread scans a slice of spikein_ into one buffer per destination, then
+     *  every destination takes its buffers in the order of the slices: the cell groups
+     *  receive their events in the order of the serial scan, whatever the number of threads
      *  \param presyns the presyn maker from which input presyn information
      *  is taken (used to distribute spike events between cell groups).
      */
@@ -113,8 +170,31 @@ public:
      * \return the current time_ value for this pool
      */
     inline int get_time() const { return time_; }
+
+    /** \fn delivered()
+     * \return the number of events delivered by the cell groups
+     */
+    inline int delivered() const {
+        int n = 0;
+        for(int i = 0; i < thread_datas_.size(); ++i)
+            n += thread_datas_[i].delivered_;
+        return n;
+    }
+
+    /** \fn busy_times()
+     * \return the time (s) every thread spent running cell groups in fixed_step
+     */
+    inline const std::vector<double>& busy_times() const { return busy_; }
+
+    /** \fn idle_times()
+     * \return the time (s) every thread waited for the others at the end of the fixed steps
+     */
+    inline const std::vector<double>& idle_times() const { return idle_; }
 };
 
+/** the pool with the binary heap */
+typedef basic_pool<queue> pool;
+
 } //end of namespace
 
 #include "coreneuron_1.0/event_passing/queueing/pool.ipp"
@@ -29,14 +29,16 @@
 #include <fstream>
 #include <time.h>
 #include <ctime>
+#include <algorithm>
 
 #ifndef MAPP_POOL_IPP_
 #define MAPP_POOL_IPP_
 
 namespace queueing {
 
+template<class Q>
 template<typename G, typename P>
-void pool::send_events(const int myID, G& generator, const P& presyns){
+void basic_pool<Q>::send_events(const int myID, G& generator, const P& presyns){
     int curTime = thread_datas_[myID].get_time();
     int gid = 0;
     int dest;
@@ -51,17 +53,23 @@ void pool::send_events(const int myID, G& generator, const P& presyns){
                 std::cout<<"Rank: "<<rank_<<" Could not find gid: "<<gid<<std::endl;
                 assert(false);
             }
+            new_event.data_ = gid;
+            new_event.t_ = g.second;
             //send to all local destinations
             for(int i = 0; i < output->size(); ++i){
                 dest = (*output)[i] % thread_datas_.size();
                 if(dest == myID)
                     thread_datas_[myID].self_send(gid, g.second);
+                else if(buffered_ || batched_)
+                    ite_buffers_[myID*thread_datas_.size() + dest].push_back(new_event);
                 else
                     thread_datas_[dest].inter_thread_send(gid, g.second);
             }
             //send to spikeout_ buffer
-            new_event.data_ = gid;
-            new_event.t_ = g.second;
+            if(buffered_){
+                spikeout_buffers_[myID].push_back(new_event);
+                continue;
+            }
 
             spike_.lock_.lock();
             spike_.spikeout_.push_back(new_event);
@@ -72,61 +80,158 @@ void pool::send_events(const int myID, G& generator, const P& presyns){
     catch(const std::bad_alloc& e) {
         std::cout <<"send failed: "<<e.what()<<std::endl;
     }
+
+    //a single atomic operation per destination for the events of the step
+    if(batched_){
+        for(int i = 0; i < thread_datas_.size(); ++i){
+            std::vector<event>& buffer = ite_buffers_[myID*thread_datas_.size() + i];
+            if(!buffer.empty()){
+                thread_datas_[i].inter_thread_publish(buffer);
+                buffer.clear();
+            }
+        }
+    }
 }
 
-//PARALLEL FUNCTIONS
+template<class Q>
 template <typename G, typename P>
-void pool::fixed_step(G& generator, const P& presyns){
-    #pragma omp parallel for schedule(static,1)
-    for(int i = 0; i < thread_datas_.size(); ++i){
-        for(int j = 0; j < min_delay_; ++j){
-            send_events(i, generator, presyns);
-            //Have threads enqueue their interThreadEvents
-            thread_datas_[i].enqueue_my_events();
+void basic_pool<Q>::run_group(int i, G& generator, const P& presyns){
+    const double start = omp_get_wtime();
+    for(int j = 0; j < min_delay_; ++j){
+        send_events(i, generator, presyns);
+        //Have threads enqueue their interThreadEvents
+        thread_datas_[i].enqueue_my_events();
+
+        if(perform_algebra_)
+            thread_datas_[i].l_algebra(fused_algebra_);
 
-            if(perform_algebra_)
-                thread_datas_[i].l_algebra();
+        /// Deliver events
+        thread_datas_[i].deliver_batch();
 
-            /// Deliver events
-            while(thread_datas_[i].deliver());
+        thread_datas_[i].increment_time();
+    }
+    step_busy_[omp_get_thread_num()] += omp_get_wtime() - start;
+}
 
-            thread_datas_[i].increment_time();
+//PARALLEL FUNCTIONS
+template<class Q>
+template <typename G, typename P>
+void basic_pool<Q>::fixed_step(G& generator, const P& presyns){
+    const int nthreads = omp_get_max_threads();
+    if(step_busy_.size() != nthreads){
+        step_busy_.resize(nthreads);
+        busy_.resize(nthreads, 0.);
+        idle_.resize(nthreads, 0.);
+    }
+    std::fill(step_busy_.begin(), step_busy_.end(), 0.);
+
+    const double start = omp_get_wtime();
+    if(tasks_){
+        #pragma omp parallel
+        #pragma omp single
+        for(int i = 0; i < thread_datas_.size(); ++i){
+            #pragma omp task firstprivate(i)
+            run_group(i, generator, presyns);
         }
     }
+    else{
+        #pragma omp parallel for schedule(static,1)
+        for(int i = 0; i < thread_datas_.size(); ++i)
+            run_group(i, generator, presyns);
+    }
+    const double elapsed = omp_get_wtime() - start;
+
+    //a thread not running a cell group waits at the barrier
+    for(int t = 0; t < nthreads; ++t){
+        busy_[t] += step_busy_[t];
+        idle_[t] += std::max(0., elapsed - step_busy_[t]);
+    }
+
+    if(buffered_)
+        merge_buffers();
     time_ += min_delay_;
 }
 
+template<class Q>
+void basic_pool<Q>::merge_buffers(){
+    const int ngroups = thread_datas_.size();
+
+    //offset of every buffer in spikeout_
+    std::vector<size_t> offsets(ngroups + 1);
+    offsets[0] = spike_.spikeout_.size();
+    for(int i = 0; i < ngroups; ++i)
+        offsets[i+1] = offsets[i] + spikeout_buffers_[i].size();
+    spike_.spikeout_.resize(offsets[ngroups]);
+    spike_.spike_stats_ += offsets[ngroups] - offsets[0];
+
+    #pragma omp parallel for schedule(static,1)
+    for(int i = 0; i < ngroups; ++i){
+        std::copy(spikeout_buffers_[i].begin(), spikeout_buffers_[i].end(),
+                  spike_.spikeout_.begin() + offsets[i]);
+        spikeout_buffers_[i].clear();
+
+        //every destination gets the events of all the senders
+        for(int j = 0; j < ngroups; ++j){
+            std::vector<event>& buffer = ite_buffers_[j*ngroups + i];
+            thread_datas_[i].inter_thread_send_batch(buffer);
+            buffer.clear();
+        }
+    }
+}
+
+template<class Q>
 template <typename P>
-void pool::filter(const P& presyns){
-    double tt;
-    const environment::presyn* input = NULL;
-    int spike_gid;
-    int dest;
-    try{
-        spike_.received_spike_stats_ += spike_.spikein_.size();
-        for(int i = 0; i < spike_.spikein_.size(); ++i){
-            tt = spike_.spikein_[i].t_;
-            spike_gid = spike_.spikein_[i].data_;
-            if((input = presyns.find_input(spike_gid)) != NULL){
+void basic_pool<Q>::filter(const P& presyns){
+    const int ngroups = thread_datas_.size();
+    const int nspikes = spike_.spikein_.size();
+    int post_spikes = 0;
+    spike_.received_spike_stats_ += nspikes;
+
+    //the slice s of spikein_ goes to filter_buffers_[s*ngroups + dest]
+    #pragma omp parallel for schedule(static,1) reduction(+:post_spikes)
+    for(int s = 0; s < ngroups; ++s){
+        const int first = static_cast<long>(nspikes) * s / ngroups;
+        const int last = static_cast<long>(nspikes) * (s + 1) / ngroups;
+        int spike_gid = 0;
+        try{
+            for(int i = first; i < last; ++i){
+                const double tt = spike_.spikein_[i].t_;
+                spike_gid = spike_.spikein_[i].data_;
+                const environment::presyn* input = presyns.find_input(spike_gid);
+                if(input == NULL)
+                    continue;
                 for(size_t j = 0; j < input->size(); ++j){
-                    dest = (*input)[j] % thread_datas_.size();
-                    //send using non-mutex inter-thread send here
-                    thread_datas_[dest].inter_send_no_lock(dest, tt);
-                    ++(spike_.post_spike_stats_);
+                    const int dest = (*input)[j] % ngroups;
+                    filter_buffers_[s*ngroups + dest].push_back(event(dest, tt));
+                    ++post_spikes;
                 }
             }
         }
+        catch(const std::bad_alloc& e) {
+            std::cout<<"Rank: "<<rank_<<" failed receiving: "<<spike_gid<<std::endl;
+            std::cout <<"Filter failed: "<<e.what()<<std::endl;
+        }
     }
-    catch(const std::bad_alloc& e) {
-        std::cout<<"Rank: "<<rank_<<" failed receiving: "<<spike_gid<<std::endl;
-        std::cout <<"Filter failed: "<<e.what()<<std::endl;
+    spike_.post_spike_stats_ += post_spikes;
+
+    //every destination takes its events in the order of the slices
+    #pragma omp parallel for schedule(static,1)
+    for(int dest = 0; dest < ngroups; ++dest){
+        for(int s = 0; s < ngroups; ++s){
+            std::vector<event>& buffer = filter_buffers_[s*ngroups + dest];
+            //send using non-mutex inter-thread send here
+            for(size_t j = 0; j < buffer.size(); ++j)
+                thread_datas_[dest].inter_send_no_lock(dest, buffer[j].t_);
+            buffer.clear();
+        }
     }
 
     spike_.spikeout_.clear();
     spike_.spikein_.clear();
 }
 
-inline void pool::accumulate_stats(){
+template<class Q>
+void basic_pool<Q>::accumulate_stats(){
     int ite_stats = 0;
     int local_stats = 0;
     for(int i=0; i < thread_datas_.size(); ++i){
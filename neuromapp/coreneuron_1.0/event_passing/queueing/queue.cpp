@@ -28,6 +28,7 @@
 #include <string.h>
 #include <stdarg.h>
 #include <utility>
+#include <iterator>
 
 #include "coreneuron_1.0/event_passing/queueing/queue.h"
 
@@ -47,4 +48,98 @@ bool queue::atomic_dq(double tt, event& q) {
     return false;
 }
 
+size_t queue::batch_dq(double tt, std::vector<event>& v) {
+    size_t n = 0;
+    while(!pq_que.empty() && pq_que.top().t_ <= tt) {
+        v.push_back(pq_que.top());
+        pq_que.pop();
+        ++n;
+    }
+    return n;
+}
+
+void sptq_queue::insert(double tt, int d) {
+    q_.push(event(d,tt));
+}
+
+bool sptq_queue::atomic_dq(double tt, event& q) {
+    if(!q_.empty() && q_.top().t_ <= tt) {
+        q = q_.top();
+        q_.pop();
+        return true;
+    }
+    return false;
+}
+
+size_t sptq_queue::batch_dq(double tt, std::vector<event>& v) {
+    return q_.pop_until(event(0, tt), std::back_inserter(v));
+}
+
+void bin_queue::insert(double tt, int d) {
+    q_.push(event(d,tt));
+}
+
+bool bin_queue::atomic_dq(double tt, event& q) {
+    if(!q_.empty() && q_.top().t_ <= tt) {
+        q = q_.top();
+        q_.pop();
+        return true;
+    }
+    // drained up to tt, the bins before it are free
+    q_.advance(tt);
+    return false;
+}
+
+size_t bin_queue::batch_dq(double tt, std::vector<event>& v) {
+    typedef tool::bin_queue<event>::node_type node;
+    size_t n = 0;
+    while(!q_.empty() && q_.top().t_ <= tt) {
+        node* q = q_.pop_bin();
+        while(q) {
+            node* left = q->left_;
+            if(q->t_.t_ <= tt) {
+                v.push_back(q->t_);
+                delete q;
+                ++n;
+            }
+            else {
+                q_.push(q); // a later event of the same bin, pushed back
+            }
+            q = left;
+        }
+    }
+    // drained up to tt, the bins before it are free
+    q_.advance(tt);
+    return n;
+}
+
+void concurrent_bin_queue::insert(double tt, int d) {
+    q_.push(event(d,tt));
+}
+
+bool concurrent_bin_queue::atomic_dq(double tt, event& q) {
+    // the bins up to tt are taken whole, then returned one by one
+    if(next_ == ready_.size()) {
+        ready_.clear();
+        next_ = 0;
+        q_.pop_until(tt, std::back_inserter(ready_));
+    }
+    if(next_ < ready_.size() && ready_[next_].t_ <= tt) {
+        q = ready_[next_++];
+        return true;
+    }
+    return false;
+}
+
+size_t concurrent_bin_queue::batch_dq(double tt, std::vector<event>& v) {
+    size_t n = 0;
+    for(; next_ < ready_.size() && ready_[next_].t_ <= tt; ++next_, ++n)
+        v.push_back(ready_[next_]);
+    if(next_ < ready_.size())
+        return n;
+    ready_.clear();
+    next_ = 0;
+    return n + q_.pop_until(tt, std::back_inserter(v));
+}
+
 } //end of namespace
@@ -31,6 +31,9 @@
 #include <utility>
 #include <functional>
 
+#include "coreneuron_1.0/queue/tool/sptq_queue.hpp"
+#include "coreneuron_1.0/queue/tool/bin_queue.hpp"
+#include "coreneuron_1.0/queue/tool/concurrent_bin_queue.hpp"
 
 #ifndef MAPP_CONTAINER_H_
 #define MAPP_CONTAINER_H_
@@ -50,6 +53,15 @@ struct event {
     }
 };
 
+/** \fn double time_of(const event& e)
+ *  \return the time of the event, the key of tool::bin_queue
+ */
+inline double time_of(const event& e) {return e.t_;}
+
+/** \class queue
+ *  \brief the event container of nrn_thread_data, a binary heap (std::priority_queue).
+ *  sptq_queue and bin_queue have the same API, see basic_nrn_thread_data
+ */
 class queue {
 public:
     /** \fn size()
@@ -65,6 +77,14 @@ public:
      */
     bool atomic_dq(double til, event& q);
 
+    /** \fn size_t batch_dq(double til, std::vector<event>& v)
+     *  \brief pops every event with time <= til
+     *  \param til a double value compared against the times.
+     *  \param v the events are appended to v, in time order
+     *  \return the number of popped events
+     */
+    size_t batch_dq(double til, std::vector<event>& v);
+
     /** \fn void insert(double t, int data)
      *  \brief inserts an event with time t and data value
      *  \param t the event time.
@@ -76,5 +96,71 @@ private:
     std::priority_queue<event, std::vector<event>, std::greater<event> > pq_que;
 };
 
+/** \class sptq_queue
+ *  \brief the splay tree of the queue miniapp (tool::sptq_queue) as event container,
+ *  the nodes come from a slab allocator
+ */
+class sptq_queue {
+public:
+    size_t size() const {return q_.size();}
+    bool atomic_dq(double til, event& q);
+    size_t batch_dq(double til, std::vector<event>& v);
+    void insert(double t, int data);
+
+private:
+    tool::sptq_queue<event, std::greater<event>, tool::sptq_pool_allocator<event> > q_;
+};
+
+/** \class bin_queue
+ *  \brief the calendar queue of the queue miniapp (tool::bin_queue) as event container,
+ *  the bins are one time step wide. The times of the events are whole steps so a bin holds
+ *  the events of a single time, batch_dq takes the bins whole. The origin of the bins
+ *  follows the dequeue time, the received spikes of the past go in the first bin
+ */
+class bin_queue {
+public:
+    bin_queue(): q_(1.) {}
+    size_t size() const {return q_.size();}
+    bool atomic_dq(double til, event& q);
+    size_t batch_dq(double til, std::vector<event>& v);
+    void insert(double t, int data);
+
+private:
+    tool::bin_queue<event> q_;
+};
+
+/** \class concurrent_bin_queue
+ *  \brief the concurrent bin queue (tool::concurrent_bin_queue) as event container, one bin
+ *  per time step. insert may be called by any thread while the owner pops, the inter thread
+ *  events go directly in the bins (see is_concurrent), not through inter_thread_events_
+ */
+class concurrent_bin_queue {
+public:
+    concurrent_bin_queue(): q_(1., 128), next_(0) {}
+    size_t size() const {return q_.size() + ready_.size() - next_;}
+    bool atomic_dq(double til, event& q);
+    size_t batch_dq(double til, std::vector<event>& v);
+    void insert(double t, int data);
+
+private:
+    tool::concurrent_bin_queue<event> q_;
+    /// the events popped from q_ by atomic_dq, not returned yet
+    std::vector<event> ready_;
+    size_t next_;
+};
+
+/** \struct is_concurrent
+ *  \brief value is true if the container Q accepts insert from any thread
+ */
+template<class Q>
+struct is_concurrent {
+    static const bool value = false;
+};
+
+template<>
+struct is_concurrent<concurrent_bin_queue> {
+    static const bool value = true;
+};
+
 } //end of namespace
 #endif
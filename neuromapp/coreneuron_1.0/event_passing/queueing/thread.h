@@ -20,7 +20,7 @@
 
 /**
  * @file neuromapp/coreneuron_1.0/event_passing/queueing/thread.h
- * \brief Contains nrn_thread_data class declaration.
+ * \brief Contains basic_nrn_thread_data class declaration.
  */
 
 #ifndef thread_h
@@ -29,6 +29,7 @@
 #include <queue>
 
 #include "coreneuron_1.0/kernel/mechanism/mechanism.h"
+#include "coreneuron_1.0/kernel/mechanism/registry.h"
 #include "coreneuron_1.0/kernel/helper.h"
 #include "coreneuron_1.0/common/memory/nrnthread.h"
 #include "coreneuron_1.0/common/util/nrnthread_handler.h"
@@ -36,6 +37,7 @@
 #include "utils/storage/storage.h"
 
 #include "coreneuron_1.0/event_passing/queueing/queue.h"
+#include "coreneuron_1.0/event_passing/queueing/inbox.h"
 #include "coreneuron_1.0/common/data/helper.h"
 
 // Get OMP header if available
@@ -44,14 +46,32 @@
 
 namespace queueing {
 
-class nrn_thread_data{
+/** \class basic_nrn_thread_data
+ *  \brief a cell group: its dataset, its event container and its inter thread events
+ *  \param Q the event container: queue (binary heap), sptq_queue, bin_queue or
+ *  concurrent_bin_queue, the member functions are instantiated for these four in thread.cpp.
+ *  The inter thread events are inserted directly in a concurrent container (is_concurrent)
+ */
+template<class Q>
+class basic_nrn_thread_data{
 private:
     mapp::mutex lock_;
 
-    queue qe_;
+    Q qe_;
     NrnThread* nt_;
     /// vector for inter thread events
     std::vector<event> inter_thread_events_;
+    /// lock-free inbox for the inter thread events, used instead of lock_
+    inbox inbox_;
+    bool lock_free_;
+    /// the currents of the step are already computed by the last fused sweep
+    bool current_ready_;
+    /// index of the mechanism receiving the events, -1 if none
+    int receiver_;
+    /// kernels of the receiving mechanism, looked up once with receiver_
+    const mech_kernels* receiver_kernels_;
+    /// buffer of deliver_batch
+    std::vector<event> delivered_events_;
 public:
     int ite_received_;
     int local_received_;
@@ -59,12 +79,12 @@ public:
     int delivered_;
     int time_;
 
-    /** \fn nrn_thread_data()
+    /** \fn basic_nrn_thread_data(bool lock_free)
      *  \brief initializes nrn_thread_data and creates a new priority queue
-     *  \param i provides the thread id for this nrn_thread_data
-     *   \param verbose verbose mode: 1 = ON, 0 = OFF
+     *  \param lock_free if true, the inter thread events go through the lock-free
+     *  inbox instead of the vector protected by lock_
      */
-    nrn_thread_data();
+    explicit basic_nrn_thread_data(bool lock_free = false);
 
     /** \fn void self_send(int d, double tt)
      *  \brief send an item directly to my priority queue
@@ -80,6 +100,20 @@ public:
      */
     void inter_thread_send(int d, double tt);
 
+    /** \fn void inter_thread_send_batch(const std::vector<event>& events)
+     *  \brief sends a batch of events to inter_thread_events_ without lock,
+     *  no other thread may send to this one meanwhile
+     *  \param events the events, counted in ite_received_
+     */
+    void inter_thread_send_batch(const std::vector<event>& events);
+
+    /** \fn void inter_thread_publish(const std::vector<event>& events)
+     *  \brief sends a batch of events to the lock-free inbox in a single atomic
+     *  operation, any number of threads may send meanwhile (lock-free mode only)
+     *  \param events the events, counted in ite_received_
+     */
+    void inter_thread_publish(const std::vector<event>& events);
+
     /** \fn void inter_send_no_lock(int d, double tt)
      *  \brief send an item to inter_thread_events_ (serially)
      *  \param d the Event's data value
@@ -101,15 +135,26 @@ public:
      */
     bool deliver();
 
-    /** \fn void l_algebra()
+    /** \fn int deliver_batch()
+     *  \brief dequeue all items with time <= time_ at once (batch_dq of the container)
+     *  and deliver them in time order, same effect than calling deliver() until false
+     *  \return the number of delivered events
+     */
+    int deliver_batch();
+
+    /** \fn void l_algebra(bool fused)
      *  \brief performs the mechanism calculations/updates for linear algebra
+     *  every mechanism of nt_ present in the registry is computed
+     *  \param fused if true, the state and the current of the next step are computed in a
+     *  single sweep (mech_fused_chunk). The mechanisms receiving events (net_receive) are not
+     *  fused, the delivered events change them between two steps
      */
-    void l_algebra();
+    void l_algebra(bool fused = false);
 
     /** \fn size_t inter_thread_size()
-     *  \return the size of inter_thread_events_
+     *  \return the number of inter thread events not enqueued yet
      */
-    size_t inter_thread_size() const {return inter_thread_events_.size();}
+    size_t inter_thread_size() const {return inter_thread_events_.size() + inbox_.size();}
 
     /** \fn size_t pq_size()
      *  \return the size of qe_
@@ -127,5 +172,8 @@ public:
     void increment_time() {++time_;}
 };
 
+/** the cell group with the binary heap */
+typedef basic_nrn_thread_data<queue> nrn_thread_data;
+
 } //endnamespace
 #endif
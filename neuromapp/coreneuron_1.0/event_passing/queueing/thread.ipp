@@ -0,0 +1,217 @@
+/*
+ * Neuromapp - thread.ipp, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/queueing/thread.ipp
+ * \brief Contains basic_nrn_thread_data class definition.
+ */
+
+#include <queue>
+#include <vector>
+#include <iostream>
+#include <unistd.h>
+#include <utility>
+#include <cassert>
+
+#ifndef MAPP_THREAD_IPP_
+#define MAPP_THREAD_IPP_
+
+#include "coreneuron_1.0/event_passing/queueing/thread.h"
+
+namespace queueing {
+
+template<class Q>
+basic_nrn_thread_data<Q>::basic_nrn_thread_data(bool lock_free):
+lock_free_(lock_free), current_ready_(false), receiver_(-1), receiver_kernels_(NULL), ite_received_(0), local_received_(0), enqueued_(0), delivered_(0) {
+    input_parameters p;
+    time_ = 0;
+    char name[] = "coreneuron_1.0_queueing_data";
+    std::string data = mapp::data_test();
+    p.name = name;
+
+    std::vector<char> chardata(data.begin(), data.end());
+    chardata.push_back('\0');
+    p.d = &chardata[0];
+    nt_ = (NrnThread *) storage_get(p.name, make_nrnthread, p.d, free_nrnthread);
+    if(nt_ == NULL){
+        std::cerr<<"Error: Unable to open data file"<<std::endl;
+        storage_clear(p.name);
+        exit(EXIT_FAILURE);
+    }
+    inter_thread_events_.reserve(1000);
+
+    // the events go to the first mechanism able to receive them
+    for(int i = 0; i < nt_->nmech && receiver_ < 0; ++i){
+        const mech_kernels* k = mech_find(nt_->ml[i].type);
+        if(k != NULL && k->net_receive != NULL){
+            receiver_ = i;
+            receiver_kernels_ = k;
+        }
+    }
+}
+
+template<class Q>
+void basic_nrn_thread_data<Q>::self_send(int d, double tt){
+    // the other threads count their sends to a concurrent container
+    if(is_concurrent<Q>::value)
+        __sync_fetch_and_add(&enqueued_, 1);
+    else
+        ++enqueued_;
+    ++local_received_;
+    qe_.insert(tt, d);
+}
+
+template<class Q>
+void basic_nrn_thread_data<Q>::inter_thread_send(int d, double tt){
+    event ite;
+    ite.data_ = d;
+    ite.t_ = tt;
+    // no copy in inter_thread_events_, the event goes in its bin
+    if(is_concurrent<Q>::value){
+        __sync_fetch_and_add(&ite_received_, 1);
+        __sync_fetch_and_add(&enqueued_, 1);
+        qe_.insert(tt, d);
+        return;
+    }
+    if(lock_free_){
+        __sync_fetch_and_add(&ite_received_, 1);
+        inbox_.push(ite);
+        return;
+    }
+    lock_.lock();
+    ++ite_received_;
+    inter_thread_events_.push_back(ite);
+    lock_.unlock();
+}
+
+template<class Q>
+void basic_nrn_thread_data<Q>::inter_thread_send_batch(const std::vector<event>& events){
+    ite_received_ += events.size();
+    if(is_concurrent<Q>::value){
+        enqueued_ += events.size();
+        for(int i = 0; i < events.size(); ++i)
+            qe_.insert(events[i].t_, events[i].data_);
+        return;
+    }
+    inter_thread_events_.insert(inter_thread_events_.end(), events.begin(), events.end());
+}
+
+template<class Q>
+void basic_nrn_thread_data<Q>::inter_thread_publish(const std::vector<event>& events){
+    assert(lock_free_);
+    __sync_fetch_and_add(&ite_received_, events.size());
+    inbox_.push(events.begin(), events.end());
+}
+
+template<class Q>
+void basic_nrn_thread_data<Q>::inter_send_no_lock(int d, double tt){
+    event ite;
+    ite.data_ = d;
+    ite.t_ = tt;
+    if(is_concurrent<Q>::value){
+        ++enqueued_;
+        qe_.insert(tt, d);
+        return;
+    }
+    inter_thread_events_.push_back(ite);
+}
+
+template<class Q>
+void basic_nrn_thread_data<Q>::enqueue_my_events(){
+    // only the owner touches inter_thread_events_ in the lock-free mode
+    if(lock_free_)
+        inbox_.drain(inter_thread_events_);
+    else
+        lock_.lock();
+    event ite;
+    for(int i = 0; i < inter_thread_events_.size(); ++i){
+        ite = inter_thread_events_[i];
+        ++enqueued_;
+        qe_.insert(ite.t_, ite.data_);
+    }
+    inter_thread_events_.clear();
+    if(!lock_free_)
+        lock_.unlock();
+}
+
+template<class Q>
+bool basic_nrn_thread_data<Q>::deliver(){
+    event q;
+    if(qe_.atomic_dq(time_, q)){
+        ++delivered_;
+
+        // Use imitation of the point_receive of CoreNeron.
+        // Varies per a specific simulation case.
+        // Uses reduced version of net_receive of ProbAMPANMDA mechanism.
+        if(receiver_ >= 0)
+            receiver_kernels_->net_receive(nt_,&(nt_->ml[receiver_]));
+        return true;
+    }
+    return false;
+}
+
+template<class Q>
+int basic_nrn_thread_data<Q>::deliver_batch(){
+    delivered_events_.clear();
+    const int n = qe_.batch_dq(time_, delivered_events_);
+    delivered_ += n;
+
+    // same imitation of the point_receive than deliver(), once per event
+    if(receiver_ >= 0){
+        Mechanism* ml = &(nt_->ml[receiver_]);
+        for(int i = 0; i < n; ++i)
+            receiver_kernels_->net_receive(nt_,ml);
+    }
+    return n;
+}
+
+template<class Q>
+void basic_nrn_thread_data<Q>::l_algebra(bool fused){
+    nt_->_t = static_cast<double>(time_);
+
+    //Update the current, the mechanisms without event may be done by the last fused sweep
+    for(int i = 0; i < nt_->nmech; ++i){
+        const mech_kernels* k = mech_find(nt_->ml[i].type);
+        if(k != NULL && (!current_ready_ || k->net_receive != NULL))
+            k->current(nt_,&(nt_->ml[i]));
+    }
+    //the precomputed current is consumed, whatever the mode of this step
+    current_ready_ = false;
+
+    //Call solver
+    nrn_solve_minimal(nt_);
+
+    //Update the states, fused with the current of the next step if possible
+    for(int i = 0; i < nt_->nmech; ++i){
+        Mechanism* ml = &(nt_->ml[i]);
+        const mech_kernels* k = mech_find(ml->type);
+        if(k == NULL)
+            continue;
+        if(fused && k->net_receive == NULL)
+            mech_fused_chunk(nt_,ml,k->state_chunk,k->current_chunk,1,0,ml->nodecount);
+        else
+            k->state(nt_,ml);
+    }
+    current_ready_ = fused;
+}
+
+} //endnamespace
+
+#endif
@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include <unistd.h>
+#include <algorithm>
 #include <mpi.h>
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
@@ -327,6 +328,85 @@ void accumulate_stats<spike::spike_interface_stats_collector_large_mpi>(spike::s
 
 
 
+//FIXED SIZE
+/**
+ * \fn pack_fixed(data& d)
+ * \brief fills fixed_out_ with a header (data_ is the number of spikes of
+ * spikeout_) and the first fixed_size_ spikes
+ * \param d the data environment on which this algo is called
+ */
+template<typename data>
+void pack_fixed(data& d){
+    const int count = d.spikeout_.size();
+    d.fixed_out_.resize(d.fixed_size_ + 1);
+    d.fixed_out_[0] = spike_item(count, 0.);
+    std::copy(d.spikeout_.begin(), d.spikeout_.begin() + std::min(count, d.fixed_size_),
+              d.fixed_out_.begin() + 1);
+}
+
+/**
+ * \fn unpack_fixed(data& d, int nsource)
+ * \brief reads the headers of fixed_in_ into nin_, copies the spikes to spikein_
+ * if they all fitted, and adapts fixed_size_: twice the largest count after an
+ * overflow, halved when the largest count is below the quarter
+ * \param d the data environment on which this algo is called
+ * \param nsource the number of ranks in fixed_in_
+ * \return true if every spike fitted, else the spikes must be exchanged with nin_
+ */
+template<typename data>
+bool unpack_fixed(data& d, int nsource){
+    const int stride = d.fixed_size_ + 1;
+    int max_count = 0;
+    for(int i = 0; i < nsource; ++i){
+        d.nin_[i] = d.fixed_in_[i*stride].data_;
+        max_count = std::max(max_count, d.nin_[i]);
+    }
+
+    const bool fitted = (max_count <= d.fixed_size_);
+    if(fitted){
+        d.spikein_.clear();
+        for(int i = 0; i < nsource; ++i)
+            d.spikein_.insert(d.spikein_.end(), d.fixed_in_.begin() + i*stride + 1,
+                              d.fixed_in_.begin() + i*stride + 1 + d.nin_[i]);
+    }
+
+    //every rank sees the same counts, so the same new size
+    if(!fitted){
+        d.fixed_size_ = 2*max_count;
+        ++(d.overflow_stats_);
+    }
+    else if(4*max_count < d.fixed_size_ && d.fixed_size_ > 1){
+        d.fixed_size_ /= 2;
+    }
+    return fitted;
+}
+
+//SIMULATIONS
+/**
+ * \fn fixed_spike(data& d, MPI_Datatype spike)
+ * \brief performs a spike exchange with a single collective in the common case,
+ * like the overflow protocol of NEST (mpi_manager::communicate_Allgather): every
+ * rank sends a buffer of fixed_size_ spikes behind a count header with MPI_Allgather.
+ * If a rank overflows, the counts of the headers give the displacements of an
+ * MPI_Allgatherv of the whole spikeout_, and fixed_size_ grows for the next exchanges.
+ * \param d the data environment on which this algo is called
+ * \param spike the MPI_Datatype being communicated
+ */
+template<typename data>
+void fixed_spike(data& d, MPI_Datatype spike){
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    const int stride = d.fixed_size_ + 1;
+    pack_fixed(d);
+    d.fixed_in_.resize(size * stride);
+    MPI_Allgather(&(d.fixed_out_[0]), stride, spike, &(d.fixed_in_[0]), stride, spike, MPI_COMM_WORLD);
+    if(!unpack_fixed(d, size)){
+        //overflow, nin_ is already known
+        set_displ(d);
+        allgatherv(d, spike);
+    }
+}
+
 //SIMULATIONS
 /**
  * \fn blocking_spike(data& d, MPI_Datatype spike)
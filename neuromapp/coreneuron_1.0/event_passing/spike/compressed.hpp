@@ -0,0 +1,262 @@
+/*
+ * Neuromapp - compressed.hpp, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/spike/compressed.hpp
+ * contains the compressed wire format of the spike exchange
+ */
+
+#ifndef MAPP_COMPRESSED_H
+#define MAPP_COMPRESSED_H
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <mpi.h>
+
+#include "coreneuron_1.0/event_passing/queueing/queue.h"
+#include "coreneuron_1.0/event_passing/spike/algos.hpp"
+
+/**
+ * \class spike_codec
+ * \brief packs a spike_item {int gid, double t} (16 bytes with the padding) in a
+ * single 4 or 8 bytes word: the gid in the high bits, the time in the low bits as a
+ * number of steps dt from the start of the exchange window.
+ *
+ * The width only depends on the number of gids and on the window length, so it is the
+ * same on every rank: 4 bytes when both fit in 32 bits, else 8 bytes (32 bits each).
+ * The times must be in [t0, t0 + window] and multiples of dt, up to the rounding
+ * error of t0 + k*dt (1e-6 step). A rank with a spike out of the window, or off
+ * the steps, sends the uncompressed spike_items for this interval, its count is
+ * negative (-n-1) so that the receivers decode its block as such: the times are
+ * never quantized.
+ */
+class spike_codec {
+private:
+    int time_bits_;
+    int width_;
+    double dt_;
+    int fallbacks_;
+
+    std::vector<uint32_t> out32_;
+    std::vector<uint64_t> out64_;
+    std::vector<char> in_;
+    std::vector<int> bytes_;
+    std::vector<int> bytes_displ_;
+
+    /** \fn bits(unsigned long n)
+     *  \return the number of bits needed by the values [0, n]
+     */
+    static int bits(unsigned long n){
+        int b = 0;
+        while(n >> b)
+            ++b;
+        return b;
+    }
+
+public:
+    /** \fn spike_codec(int ngid, double window, double dt)
+     *  \param ngid the total number of gids
+     *  \param window the length of the exchange window (min delay)
+     *  \param dt the time quantum
+     */
+    spike_codec(int ngid, double window, double dt = 1.): dt_(dt), fallbacks_(0) {
+        time_bits_ = bits(static_cast<unsigned long>(window/dt + 0.5));
+        const int gid_bits = bits(ngid > 0 ? ngid - 1 : 0);
+        if(gid_bits + time_bits_ <= 32){
+            width_ = 4;
+        }
+        else{
+            assert(time_bits_ <= 32);
+            width_ = 8;
+            time_bits_ = 32;
+        }
+    }
+
+    /** \fn width()
+     *  \return the number of bytes per spike on the wire
+     */
+    int width() const {return width_;}
+
+    /** \fn fallbacks()
+     *  \return the number of exchanges this rank sent uncompressed, a spike
+     *  was out of the window
+     */
+    int fallbacks() const {return fallbacks_;}
+
+    /** \fn encode(const std::vector<spike_item>& in, std::vector<W>& out, double t0)
+     *  \brief packs the spikes of in into out
+     *  \param t0 the start of the exchange window
+     *  \return false if a time is out of the window or off the steps, or a gid
+     *  does not fit, out is then invalid
+     */
+    template<typename W>
+    bool encode(const std::vector<spike_item>& in, std::vector<W>& out, double t0) const {
+        const W mask = (time_bits_ == 0) ? 0 : (~W(0) >> (8*sizeof(W) - time_bits_));
+        const int gid_bits = 8*sizeof(W) - time_bits_;
+        //the distance to a step (in steps) of a time on the grid
+        const double epsilon = 1e-6;
+        out.resize(in.size());
+        for(int i = 0; i < in.size(); ++i){
+            const double exact = (in[i].t_ - t0)/dt_;
+            const double step = floor(exact + 0.5);
+            if(!(step >= 0. && step < mask + 1.) || fabs(exact - step) > epsilon)
+                return false;
+            const W gid = static_cast<W>(in[i].data_);
+            if(in[i].data_ < 0 || (gid_bits < 8*sizeof(W) && (gid >> gid_bits)))
+                return false;
+            out[i] = (gid << time_bits_) | static_cast<W>(step);
+        }
+        return true;
+    }
+
+    /** \fn decode(const std::vector<W>& in, std::vector<spike_item>& out, double t0)
+     *  \brief unpacks the words of in into out
+     *  \param t0 the start of the exchange window
+     */
+    template<typename W>
+    void decode(const std::vector<W>& in, std::vector<spike_item>& out, double t0) const {
+        const W mask = (time_bits_ == 0) ? 0 : (~W(0) >> (8*sizeof(W) - time_bits_));
+        out.resize(in.size());
+        for(int i = 0; i < in.size(); ++i)
+            out[i] = spike_item(static_cast<int>(in[i] >> time_bits_), t0 + (in[i] & mask)*dt_);
+    }
+
+    /** \fn exchange(data& d, double t0, MPI_Comm comm, bool neighbor)
+     *  \brief packs spikeout_, exchanges the counts in nin_ and the words, and
+     *  unpacks them in spikein_
+     *  \param d the data environment on which this algo is called
+     *  \param t0 the start of the exchange window
+     *  \param comm MPI_COMM_WORLD, or a distributed graph if neighbor
+     */
+    template<typename data>
+    void exchange(data& d, double t0, MPI_Comm comm, bool neighbor = false){
+        if(width_ == 4)
+            exchange(d, t0, comm, neighbor, out32_);
+        else
+            exchange(d, t0, comm, neighbor, out64_);
+    }
+
+private:
+    template<typename data, typename W>
+    void exchange(data& d, double t0, MPI_Comm comm, bool neighbor, std::vector<W>& out){
+        //uncompressed for this interval when a spike is out of the window or off the steps
+        const bool packed = encode(d.spikeout_, out, t0);
+        if(!packed)
+            ++fallbacks_;
+        const int n = d.spikeout_.size();
+        const int send_size = packed ? n : -n - 1;
+        const int send_bytes = n*(packed ? sizeof(W) : sizeof(spike_item));
+        // MPI accepts any address with a zero count
+        char* send = NULL;
+        if(n > 0)
+            send = packed ? reinterpret_cast<char*>(&out[0])
+                          : reinterpret_cast<char*>(&d.spikeout_[0]);
+
+#if MPI_VERSION >= 3
+        if(neighbor)
+            MPI_Neighbor_allgather(&send_size, 1, MPI_INT, &d.nin_[0], 1, MPI_INT, comm);
+        else
+#endif
+            MPI_Allgather(&send_size, 1, MPI_INT, &d.nin_[0], 1, MPI_INT, comm);
+
+        //the blocks are sent as bytes, every source has its own format
+        bytes_.resize(d.nin_.size());
+        bytes_displ_.resize(d.nin_.size());
+        int total = 0;
+        int nspikes = 0;
+        for(int i = 0; i < d.nin_.size(); ++i){
+            const bool raw = d.nin_[i] < 0;
+            const int ni = raw ? -d.nin_[i] - 1 : d.nin_[i];
+            bytes_[i] = ni*(raw ? sizeof(spike_item) : sizeof(W));
+            bytes_displ_[i] = total;
+            d.displ_[i] = nspikes;
+            total += bytes_[i];
+            nspikes += ni;
+        }
+        in_.resize(total);
+        char* recv = in_.empty() ? NULL : &in_[0];
+#if MPI_VERSION >= 3
+        if(neighbor)
+            MPI_Neighbor_allgatherv(send, send_bytes, MPI_BYTE,
+                recv, &bytes_[0], &bytes_displ_[0], MPI_BYTE, comm);
+        else
+#endif
+            MPI_Allgatherv(send, send_bytes, MPI_BYTE,
+                recv, &bytes_[0], &bytes_displ_[0], MPI_BYTE, comm);
+
+        const W mask = (time_bits_ == 0) ? 0 : (~W(0) >> (8*sizeof(W) - time_bits_));
+        d.spikein_.resize(nspikes);
+        for(int i = 0; i < d.nin_.size(); ++i){
+            if(bytes_[i] == 0)
+                continue;
+            if(d.nin_[i] < 0){
+                memcpy(&d.spikein_[d.displ_[i]], &in_[bytes_displ_[i]], bytes_[i]);
+                continue;
+            }
+            for(int j = 0; j < d.nin_[i]; ++j){
+                W w;
+                memcpy(&w, &in_[bytes_displ_[i] + j*sizeof(W)], sizeof(W));
+                d.spikein_[d.displ_[i] + j] =
+                    spike_item(static_cast<int>(w >> time_bits_), t0 + (w & mask)*dt_);
+            }
+        }
+    }
+};
+
+//SIMULATIONS
+/**
+ * \fn compressed_spike(data& d, spike_codec& codec, double t0)
+ * \brief performs a blocking spike exchange with the compressed wire format
+ * \param d the data environment on which this algo is called
+ * \param codec the wire format
+ * \param t0 the start of the exchange window, the times of spikeout_ are
+ * in [t0, t0 + window]
+ */
+template<typename data>
+void compressed_spike(data& d, spike_codec& codec, double t0){
+    //the counts and the packed spikes
+    codec.exchange(d, t0, MPI_COMM_WORLD);
+}
+
+/**
+ * \fn distributed_compressed_spike(data& d, spike_codec& codec, double t0, MPI_Comm neighborhood)
+ * \brief performs a spike exchange for distributed graph with the compressed wire format
+ * \param d the data environment on which this algo is called
+ * \param codec the wire format
+ * \param t0 the start of the exchange window
+ * \param neighborhood the distributed graph, see create_dist_graph()
+ */
+template<typename data>
+void distributed_compressed_spike(data& d, spike_codec& codec, double t0, MPI_Comm neighborhood){
+#if MPI_VERSION >= 3
+    //the counts and the packed spikes of the neighbors
+    codec.exchange(d, t0, neighborhood, true);
+#else
+    std::cerr<<"MPI version is < 3. Cannot use distributed graph implementation"<<std::endl;
+    exit(EXIT_FAILURE);
+#endif
+}
+
+#endif
@@ -32,107 +32,66 @@
 #include <mpi.h>
 
 #include "coreneuron_1.0/event_passing/queueing/queue.h"
+#include "coreneuron_1.0/event_passing/environment/neurondistribution.h"
 #include "coreneuron_1.0/event_passing/spike/algos.hpp"
 
 
 #if MPI_VERSION >= 3
 /**
- * \fn create_dist_graph(P& presyns, int ncells)
+ * \fn create_dist_graph(P& presyns, const environment::neurondistribution& dist)
  * \brief Creates a distributed graph topology in order to perform nearest
  * neighbor communication.
+ * \param presyns the presyns of this rank
+ * \param dist the distribution of the cells between the ranks
  *
  *Summary:
- * - Uses MPI broadcast in order to exchange information about the cells
- *   on each ranks.
+ * - The owner of each input presyn is given by the distribution (contiguous
+ *   ranges or round-robin, a rank may own no cell), the owners are the
+ *   inNeighbors. No gid is communicated.
  *
- * - If you care about a cell on a different rank,
- *   add them as an inNeighbor.
- *
- * - Next exchange inNeighbor information.
- *
- * - If another rank has you as an inNeighbor, add them as an outNeighbor.
+ * - MPI_Alltoall of one flag per rank, "I have inputs from your gids":
+ *   the ranks sending a flag are the outNeighbors.
  *
  * - Use this information to construct topology.
+ *
+ * The traffic is O(P) per rank, instead of the ncells gids broadcast by
+ * every rank.
  */
 template <typename P>
-MPI_Comm create_dist_graph(P& presyns, int ncells){
+MPI_Comm create_dist_graph(P& presyns, const environment::neurondistribution& dist){
     MPI_Comm neighborhood;
     int size;
     int rank;
     MPI_Comm_size(MPI_COMM_WORLD, &size);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    //passed in as argument but not used
-    environment::presyn dummy_input;
-
-    //create a temporary buffer for sending
-    std::vector<int> sendbuf;
-    std::vector<int> outNeighbors;
-    std::vector<int> inNeighbors;
 
-    //Every rank takes a turn to broadcast their output presyns
-    //If receiver has a corresponding input presyn, add as inNeighbor
-    int start = 0;
-    for(int i = 0; i < size; ++i){
-        if(rank == i){
-            start = rank * ncells;
-            for(int j = 0; j < ncells; ++j){
-                sendbuf.push_back(start + j);
-            }
-        }
-        else{
-            sendbuf.resize(ncells);
-        }
-        MPI_Bcast(&sendbuf[0], ncells, MPI_INT, i, MPI_COMM_WORLD);
-
-        //add sender to inNeighbors if there is matching input presyn
-        if(rank != i){
-            for(int j = 0; j < ncells; ++j){
-                if(presyns.find_input(sendbuf[j])){
-                    inNeighbors.push_back(i);
-                    break;
-                }
-            }
-        }
-        sendbuf.clear();
+    //flag the owners of the input presyns
+    std::vector<int> sendflags(size, 0);
+    const std::vector<int>& inputs = presyns.input_gids();
+    for(int i = 0; i < inputs.size(); ++i){
+        const int owner = dist.owner(inputs[i]);
+        assert(owner < size);
+        if(owner != rank)
+            sendflags[owner] = 1;
     }
 
-    int send_size;
-    //Now every rank broadcasts their inNeighbors
-    //If receiver is an inNeighbor, add sender as outNeighbor
+    //receive a flag from every rank with inputs from my gids
+    std::vector<int> recvflags(size, 0);
+    MPI_Alltoall(&sendflags[0], 1, MPI_INT, &recvflags[0], 1, MPI_INT, MPI_COMM_WORLD);
+
+    std::vector<int> outNeighbors;
+    std::vector<int> inNeighbors;
     for(int i = 0; i < size; ++i){
-        //Broadcast the send size
-        if(rank == i){
-            send_size = inNeighbors.size();
-        }
-        MPI_Bcast(&send_size, 1, MPI_INT, i, MPI_COMM_WORLD);
-
-        //send inNeighbors
-        if(rank == i){
-            for(int i = 0; i < inNeighbors.size(); ++i){
-                sendbuf.push_back(inNeighbors[i]);
-            }
-        }
-        else{
-            sendbuf.resize(send_size);
-        }
-        MPI_Bcast(&sendbuf[0], send_size, MPI_INT, i, MPI_COMM_WORLD);
-
-        //add sender to outNeighbors if receiver is an inNeighbor
-        if(rank != i){
-            for(int j = 0; j < send_size; ++j){
-                if(sendbuf[j] == rank){
-                    outNeighbors.push_back(i);
-                    break;
-                }
-            }
-        }
-        sendbuf.clear();
+        if(sendflags[i])
+            inNeighbors.push_back(i);
+        if(recvflags[i])
+            outNeighbors.push_back(i);
     }
-
+    // MPI accepts any address with a zero degree
     MPI_Dist_graph_create_adjacent(MPI_COMM_WORLD, inNeighbors.size(),
-        &inNeighbors[0], (int*)MPI_UNWEIGHTED, outNeighbors.size(),
-        &outNeighbors[0], (int*)MPI_UNWEIGHTED, MPI_INFO_NULL,
-        false, &neighborhood);
+        inNeighbors.empty() ? NULL : &inNeighbors[0], (int*)MPI_UNWEIGHTED,
+        outNeighbors.size(), outNeighbors.empty() ? NULL : &outNeighbors[0],
+        (int*)MPI_UNWEIGHTED, MPI_INFO_NULL, false, &neighborhood);
     return neighborhood;
 }
 
@@ -170,7 +129,7 @@ void distributed_spike(data& d, MPI_Datatype spike, MPI_Comm neighborhood){
  * compatibility issues, so use dummy functions.
  */
 template <typename P>
-MPI_Comm create_dist_graph(P& presyns, int ncells){
+MPI_Comm create_dist_graph(P& presyns, const environment::neurondistribution& dist){
     std::cerr<<"MPI version is < 3. Cannot use distributed graph implementation"<<std::endl;
     exit(EXIT_FAILURE);
 }
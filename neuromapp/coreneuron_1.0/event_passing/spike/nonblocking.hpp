@@ -0,0 +1,249 @@
+/*
+ * Neuromapp - nonblocking.hpp, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/spike/nonblocking.hpp
+ * contains the non-blocking spike exchange
+ */
+
+#ifndef MAPP_NONBLOCKING_H
+#define MAPP_NONBLOCKING_H
+
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+#include <mpi.h>
+
+#include "coreneuron_1.0/event_passing/queueing/queue.h"
+#include "coreneuron_1.0/event_passing/spike/algos.hpp"
+
+#if MPI_VERSION >= 3
+/**
+ * \class nonblocking_exchange
+ * \brief spike exchange with the non-blocking collectives, overlapped with the
+ * computation of the next fixed step.
+ *
+ *Summary:
+ * - The call following the fixed step k posts MPI_Iallgather of the number of
+ *   spikes of the interval k (MPI_Ineighbor_allgather on a distributed graph).
+ *
+ * - progress() tests the counts and, once they arrived, chains the gather of
+ *   the spikes: MPI_Iallgatherv (MPI_Ineighbor_allgatherv), it progresses
+ *   during the fixed step k+1. The drivers call it after the filter of the
+ *   interval k; without it, the next call chains the spikes itself.
+ *
+ * - The call following the fixed step k+1 waits for the spikes of the interval
+ *   k and appends them to spikein_, then posts the counts of the interval k+1:
+ *   the exchange of an interval ends within the next one, its spikes are
+ *   delivered within min delay.
+ *
+ * - flush() completes the last exchange at the end of the simulation.
+ *
+ * The time blocked in MPI_Wait of the counts and of the spikes is the exposed
+ * communication, the time between the posts and the waits (or the successful
+ * test of the counts) is the computation overlapping the communication.
+ */
+template<typename data>
+class nonblocking_exchange {
+private:
+    data& d_;
+    MPI_Datatype spike_;
+    MPI_Comm comm_;
+    bool neighbor_;
+
+    //the counts in flight, the spikes follow once they arrived
+    bool counting_;
+    MPI_Request count_request_;
+    //the spikes in flight
+    bool active_;
+    MPI_Request request_;
+    double posted_;
+    int send_;
+    std::vector<int> nin_;
+    std::vector<int> displ_;
+    std::vector<spike_item> sendbuf_;
+    std::vector<spike_item> recvbuf_;
+
+    double exposed_;
+    double overlapped_;
+
+    /** \fn post_counts()
+     *  \brief posts the gather of the count of sendbuf_
+     */
+    void post_counts(){
+        double t0 = MPI_Wtime();
+        send_ = sendbuf_.size();
+        if(neighbor_)
+            MPI_Ineighbor_allgather(&send_, 1, MPI_INT, &nin_[0], 1, MPI_INT, comm_, &count_request_);
+        else
+            MPI_Iallgather(&send_, 1, MPI_INT, &nin_[0], 1, MPI_INT, comm_, &count_request_);
+        posted_ = MPI_Wtime();
+        exposed_ += posted_ - t0;
+        counting_ = true;
+    }
+
+    /** \fn post_spikes()
+     *  \brief posts the gather of the spikes of sendbuf_, the counts arrived
+     */
+    void post_spikes(){
+        double t0 = MPI_Wtime();
+        displ_.resize(nin_.size());
+        int total = 0;
+        for(int i = 0; i < nin_.size(); ++i){
+            displ_[i] = total;
+            total += nin_[i];
+        }
+        recvbuf_.resize(total);
+
+        // MPI accepts any address with a zero count
+        spike_item* sendptr = sendbuf_.empty() ? NULL : &sendbuf_[0];
+        spike_item* recvptr = recvbuf_.empty() ? NULL : &recvbuf_[0];
+        if(neighbor_)
+            MPI_Ineighbor_allgatherv(sendptr, send_, spike_,
+                recvptr, &nin_[0], &displ_[0], spike_, comm_, &request_);
+        else
+            MPI_Iallgatherv(sendptr, send_, spike_,
+                recvptr, &nin_[0], &displ_[0], spike_, comm_, &request_);
+        posted_ = MPI_Wtime();
+        exposed_ += posted_ - t0;
+        active_ = true;
+    }
+
+    /** \fn chain()
+     *  \brief waits for the counts in flight, then posts the spikes
+     */
+    void chain(){
+        if(!counting_)
+            return;
+        double t0 = MPI_Wtime();
+        MPI_Wait(&count_request_, MPI_STATUS_IGNORE);
+        exposed_ += MPI_Wtime() - t0;
+        overlapped_ += t0 - posted_;
+        counting_ = false;
+        post_spikes();
+    }
+
+    /** \fn complete()
+     *  \brief waits for the spikes in flight and appends them to spikein_
+     */
+    void complete(){
+        chain();
+        if(!active_)
+            return;
+        double t0 = MPI_Wtime();
+        MPI_Wait(&request_, MPI_STATUS_IGNORE);
+        exposed_ += MPI_Wtime() - t0;
+        overlapped_ += t0 - posted_;
+
+        d_.spikein_.insert(d_.spikein_.end(), recvbuf_.begin(), recvbuf_.end());
+        active_ = false;
+    }
+
+public:
+    /** \fn nonblocking_exchange(data& d, MPI_Datatype spike, MPI_Comm comm, bool neighbor)
+     *  \param d the data environment, its spikeout_ is sent and its spikein_ is filled
+     *  \param spike the MPI_Datatype being communicated
+     *  \param comm MPI_COMM_WORLD, or a distributed graph if neighbor
+     *  \param neighbor use the neighbor collectives of the distributed graph comm
+     */
+    nonblocking_exchange(data& d, MPI_Datatype spike, MPI_Comm comm, bool neighbor = false):
+    d_(d), spike_(spike), comm_(comm), neighbor_(neighbor), counting_(false), active_(false),
+    send_(0), exposed_(0.), overlapped_(0.) {
+        int nsource;
+        if(neighbor_){
+            int noutput, weighted;
+            MPI_Dist_graph_neighbors_count(comm_, &nsource, &noutput, &weighted);
+        }
+        else{
+            MPI_Comm_size(comm_, &nsource);
+        }
+        nin_.resize(nsource + 1); // + 1, never an empty buffer
+    }
+
+    /** \fn operator()()
+     *  \brief appends the spikes of the previous interval to spikein_, then
+     *  posts the counts of spikeout_ (cleared)
+     */
+    void operator()(){
+        complete();
+
+        //the buffers of the completed exchange are free
+        sendbuf_.swap(d_.spikeout_);
+        d_.spikeout_.clear();
+        post_counts();
+    }
+
+    /** \fn progress()
+     *  \brief posts the spikes if their counts arrived, never blocks
+     */
+    void progress(){
+        if(!counting_)
+            return;
+        int done = 0;
+        double t0 = MPI_Wtime();
+        MPI_Test(&count_request_, &done, MPI_STATUS_IGNORE);
+        exposed_ += MPI_Wtime() - t0;
+        if(!done)
+            return;
+        overlapped_ += t0 - posted_;
+        counting_ = false;
+        post_spikes();
+    }
+
+    /** \fn flush()
+     *  \brief completes the exchange in flight, its spikes are appended to spikein_
+     */
+    void flush(){
+        complete();
+    }
+
+    /** \fn exposed()
+     *  \return the time (s) blocked posting and waiting for the counts and the
+     *  spikes
+     */
+    double exposed() const {return exposed_;}
+
+    /** \fn overlapped()
+     *  \return the time (s) between the posts and the waits of the counts and
+     *  the spikes, the communication progresses meanwhile
+     */
+    double overlapped() const {return overlapped_;}
+};
+#else
+/**
+ * If MPI version is less than 3, there are no non-blocking collectives,
+ * so use a dummy class.
+ */
+template<typename data>
+class nonblocking_exchange {
+public:
+    nonblocking_exchange(data& d, MPI_Datatype spike, MPI_Comm comm, bool neighbor = false){}
+    void operator()(){
+        std::cerr<<"MPI version is < 3. Cannot use non-blocking spike exchange"<<std::endl;
+        exit(EXIT_FAILURE);
+    }
+    void flush(){}
+    void progress(){}
+    double exposed() const {return 0.;}
+    double overlapped() const {return 0.;}
+};
+#endif //MPI VERSION 3
+
+#endif
@@ -47,6 +47,11 @@ struct spike_interface{
     std::vector<queueing::event> spikeout_;
     std::vector<int> nin_;
     std::vector<int> displ_;
+    //FIXED SIZE EXCHANGE, see fixed_spike()
+    std::vector<queueing::event> fixed_out_;
+    std::vector<queueing::event> fixed_in_;
+    /// number of spikes per rank sent by the single collective, the same on every rank
+    int fixed_size_;
 
     //STATS ACCUMULATORS
     int spike_stats_;
@@ -54,17 +59,20 @@ struct spike_interface{
     int local_stats_;
     int post_spike_stats_;
     int received_spike_stats_;
+    int overflow_stats_;
 
     /** \fn spike_interface(int nprocs)
         \brief spike_interface constructor. Initializes nin and displ buffers
         to have size == number of processes
      */
     spike_interface(int nprocs):
+        fixed_size_(8),
         spike_stats_(0),
         ite_stats_(0),
         local_stats_(0),
         post_spike_stats_(0),
-        received_spike_stats_(0)
+        received_spike_stats_(0),
+        overflow_stats_(0)
         {nin_.resize(nprocs); displ_.resize(nprocs);}
 };
 
@@ -34,16 +34,20 @@
 #include <unistd.h>
 
 #include "coreneuron_1.0/kernel/helper.h"
+#include "coreneuron_1.0/kernel/mechanism/registry.h"
 #include "utils/error.h"
 
 int kernel_print_usage() {
-    printf("Usage: kernel --mechanism [string] --function [string] --data [string] --numthread [int] --name [string]\n");
+    printf("Usage: kernel --mechanism [string] --function [string] --data [string] --numthread [int] --name [string] --simd --template --block [int]\n");
     printf("Details: \n");
-    printf("                 --mechanism [Na, ProbAMPANMDA or Ih] \n");
+    printf("                 --mechanism [Na, ProbAMPANMDA or Ih, beginning of a name of the registry] \n");
     printf("                 --function [state or current] \n");
     printf("                 --data [path to the input] \n");
-    printf("                 --numthread [threadnumber] \n");
+    printf("                 --numthread [threadnumber, the instances of the mechanism are split between the threads] \n");
     printf("                 --name [to internally reference the data, default name coreneuron_1.0_kernel_data] \n");
+    printf("                 --simd [use the hand-vectorized kernels] \n");
+    printf("                 --template [use the C++ kernels specialized on the layout] \n");
+    printf("                 --block [4, 8 or 16, AoSoA layout of the mechanism data, needs --template] \n");
     return MAPP_USAGE;
 }
 
@@ -59,7 +63,7 @@ int kernel_help_function(const char* f)
 int kernel_help_mechanism(const char* m)
 {
     int error = MAPP_OK;
-    if((strncmp(m,"Na",2) != 0) && (strncmp(m,"Ih",3) != 0) && (strncmp(m,"ProbAMPANMDA",12) != 0))
+    if(mech_find_name(m) == NULL)
         error = MAPP_BAD_ARG;
     return error;
 }
@@ -72,6 +76,9 @@ int kernel_help(int argc, char * const argv[], struct input_parameters * p)
   p->f = "state"; // default
   p->d = "";
   p->th = 1; // one omp thread by default
+  p->simd = 0; // compiler vectorization by default
+  p->tmpl = 0; // C kernels by default
+  p->block = 0; // SoA layout by default
   p->name = "coreneuron_1.0_kernel_data";
 
   optind = 0;
@@ -86,13 +93,16 @@ int kernel_help(int argc, char * const argv[], struct input_parameters * p)
           {"data",  required_argument,     0, 'd'},
           {"numthread",  required_argument,0, 't'},
           {"name",  required_argument,     0, 'n'},
+          {"simd",  no_argument,           0, 's'},
+          {"template",  no_argument,       0, 'p'},
+          {"block",  required_argument,    0, 'b'},
 
           {0, 0, 0, 0}
       };
       /* getopt_long stores the option index here. */
       int option_index = 0;
 
-      c = getopt_long (argc, argv, "m:f:d:t:n:",
+      c = getopt_long (argc, argv, "m:f:d:t:n:spb:",
                        long_options, &option_index);
       /* Detect the end of the options. */
       if (c == -1)
@@ -121,6 +131,17 @@ int kernel_help(int argc, char * const argv[], struct input_parameters * p)
           case 'n':
               p->name = optarg;
               break;
+          case 's':
+              p->simd = 1;
+              break;
+          case 'p':
+              p->tmpl = 1;
+              break;
+          case 'b':
+              p->block = atoi(optarg);
+              if(p->block != 4 && p->block != 8 && p->block != 16)
+                  return MAPP_BAD_ARG;
+              break;
           case 'h':
               return kernel_print_usage();
               break;
@@ -129,5 +150,13 @@ int kernel_help(int argc, char * const argv[], struct input_parameters * p)
 	      break;
       }
   }
+
+  if(p->simd && p->tmpl)
+      return MAPP_BAD_ARG;
+
+  /* only the template kernels know the AoSoA layout */
+  if(p->block && !p->tmpl)
+      return MAPP_BAD_ARG;
+
   return 0 ;
 }
@@ -48,6 +48,18 @@ struct input_parameters{
      \warning The default value is 1 OMP thread
      */
     int th;
+    /** Use the hand-vectorized kernels
+     \warning The default value is 0, the compiler vectorizes the kernels
+     */
+    int simd;
+    /** use the C++ template kernels specialized on the layout of the mechanism
+     \warning The default value is 0, --simd and --template are exclusive
+     */
+    int tmpl;
+    /** AoSoA block size of the mechanism data (4, 8 or 16), needs --template
+     \warning The default value is 0, the SoA layout
+     */
+    int block;
     /** key for the storage library
      \warning The default key name is coreneuron_1.0_kernel_data
      */
@@ -0,0 +1,161 @@
+/*
+ * Neuromapp - layout_benchmark.cpp, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/kernel/layout_benchmark.cpp
+ * \brief Compare the SoA and AoSoA layouts of the mechanism data on the template kernels
+ *
+ * For every layout the benchmark reports the time of the state and current kernels and
+ * the memory footprint of the variables they touch: distinct cache lines per instance and
+ * distinct pages per group of 16 instances (the TLB entries needed by a vector loop).
+ * Run it under "perf stat -e dTLB-load-misses,cache-misses" for the hardware counters.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <sys/time.h>
+
+extern "C" {
+#include "coreneuron_1.0/common/memory/nrnthread.h"
+#include "coreneuron_1.0/common/util/nrnthread_handler.h"
+}
+
+#include "coreneuron_1.0/kernel/mechanism/mechanism.h"
+#include "coreneuron_1.0/kernel/mechanism/registry.h"
+#include "coreneuron_1.0/kernel/mechanism/template/NaTs2_t.hpp"
+#include "coreneuron_1.0/kernel/mechanism/template/Ih.hpp"
+#include "coreneuron_1.0/kernel/mechanism/template/ProbAMPANMDA_EMS.hpp"
+#include "utils/error.h"
+
+namespace {
+
+    /** description of a benchmarked mechanism, the kernels come from the registry */
+    struct bench_mechanism {
+        int type;
+        std::vector<int> variables; // variables touched by the kernels
+    };
+
+    double wtime(){
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        return tv.tv_sec + 1e-6*tv.tv_usec;
+    }
+
+    /** address of the variable var of the instance i whatever the layout */
+    double const* address(Mechanism const* ml, double const* p, int var, int i){
+        if(ml->block == 0)
+            return p + var*ml->nodecount + i;
+        return p + NRN_AOSOA_INDEX(var, i, ml->block, ml->szp);
+    }
+
+    /** distinct units (cache lines or pages) touched by the variables of the instances [b,e) */
+    std::size_t footprint(Mechanism const* ml, std::vector<int> const& variables, int b, int e, std::size_t unit){
+        std::vector<std::size_t> u;
+        for(std::vector<int>::const_iterator it = variables.begin(); it != variables.end(); ++it)
+            for(int i = b; i < e; ++i)
+                u.push_back(reinterpret_cast<std::size_t>(address(ml, ml->data, *it, i)) / unit);
+        std::sort(u.begin(), u.end());
+        return std::unique(u.begin(), u.end()) - u.begin();
+    }
+
+    void benchmark(NrnThread* nt, bench_mechanism const& m, int block, int repetition){
+        Mechanism* ml = nrnthread_mechanism(nt, m.type);
+        mech_kernels const* k = mech_find(m.type);
+        if(ml == NULL)
+            return;
+        const int n = ml->nodecount;
+        const int group = 16;
+
+        double lines = double(footprint(ml, m.variables, 0, n, 64)) / n;
+        std::size_t pages = 0;
+        for(int i = 0; i < n; i += group)
+            pages += footprint(ml, m.variables, i, std::min(i + group, n), 4096);
+
+        double t0 = wtime();
+        for(int r = 0; r < repetition; ++r)
+            k->state_template_chunk(nt, ml, 0, n);
+        double t1 = wtime();
+        for(int r = 0; r < repetition; ++r){
+            k->current_template_chunk(nt, ml, 0, n);
+            mech_shadow_update(nt, ml, 0, n);
+        }
+        double t2 = wtime();
+
+        std::cout << std::setw(18) << k->name
+                  << std::setw(8) << (block ? block : 0)
+                  << std::setw(14) << std::setprecision(4) << 1e6*(t1-t0)/repetition
+                  << std::setw(14) << std::setprecision(4) << 1e6*(t2-t1)/repetition
+                  << std::setw(14) << std::setprecision(4) << lines
+                  << std::setw(14) << std::setprecision(4) << double(pages)/((n + group - 1)/group)
+                  << std::endl;
+    }
+
+} // end namespace
+
+int main(int argc, char* argv[]){
+    if(argc < 2){
+        std::cout << "Usage: layout_benchmark [input] [repetition, default 100]" << std::endl;
+        return mapp::MAPP_USAGE;
+    }
+
+    int repetition = (argc > 2) ? std::atoi(argv[2]) : 100;
+
+    NrnThread* nt = (NrnThread*) make_nrnthread(argv[1]);
+    if(nt == NULL){
+        std::cout << "Error: unable to read " << argv[1] << std::endl;
+        return mapp::MAPP_BAD_DATA;
+    }
+
+    std::vector<bench_mechanism> mechanisms(3);
+    mechanisms[0].type = MECH_TYPE_NATS2_T;
+    for(int v = mechanism::NaTs2_t::gNaTs2_tbar; v <= mechanism::NaTs2_t::ena; ++v)
+        mechanisms[0].variables.push_back(v);
+
+    mechanisms[1].type = MECH_TYPE_IH;
+    mechanisms[1].variables.push_back(mechanism::Ih::gIhbar);
+    mechanisms[1].variables.push_back(mechanism::Ih::m);
+
+    mechanisms[2].type = MECH_TYPE_PROBAMPANMDA_EMS;
+    mechanisms[2].variables.push_back(mechanism::ProbAMPANMDA_EMS::e);
+    mechanisms[2].variables.push_back(mechanism::ProbAMPANMDA_EMS::mg);
+    for(int v = mechanism::ProbAMPANMDA_EMS::A_AMPA_step; v <= mechanism::ProbAMPANMDA_EMS::B_NMDA_step; ++v)
+        mechanisms[2].variables.push_back(v);
+    for(int v = mechanism::ProbAMPANMDA_EMS::A_AMPA; v <= mechanism::ProbAMPANMDA_EMS::B_NMDA; ++v)
+        mechanisms[2].variables.push_back(v);
+
+    std::cout << std::setw(18) << "mechanism" << std::setw(8) << "block"
+              << std::setw(14) << "state [us]" << std::setw(14) << "current [us]"
+              << std::setw(14) << "lines/inst" << std::setw(14) << "pages/16inst" << std::endl;
+
+    const int blocks[4] = {0, 4, 8, 16};
+    for(int b = 0; b < 4; ++b){
+        NrnThread* clone = (NrnThread*) clone_nrnthread(nt);
+        nrnthread_block(clone, blocks[b]);
+        for(std::size_t i = 0; i < mechanisms.size(); ++i)
+            benchmark(clone, mechanisms[i], blocks[b], repetition);
+        free_nrnthread(clone);
+    }
+
+    free_nrnthread(nt);
+    return mapp::MAPP_OK;
+}
@@ -34,9 +34,11 @@
 #include "coreneuron_1.0/kernel/helper.h"
 #include "coreneuron_1.0/kernel/kernel.h"
 #include "coreneuron_1.0/kernel/mechanism/mechanism.h"
+#include "coreneuron_1.0/kernel/mechanism/registry.h"
 #include "coreneuron_1.0/common/memory/nrnthread.h"
 #include "coreneuron_1.0/common/util/nrnthread_handler.h"
 #include "coreneuron_1.0/common/util/timer.h"
+#include "coreneuron_1.0/common/util/simd.h"
 #include "utils/error.h"
 
 // Get OMP header if available
@@ -46,8 +48,9 @@
     \brief Start the computation of kernel following the input parameter
     \param nt the data structure where all the datas are saved
     \param p input parameters where are defined the wanted computation
+    \return MAPP_BAD_DATA if the dataset does not contain the mechanism
  */
-void compute_wrapper(NrnThread *nt, struct input_parameters* p);
+int compute_wrapper(NrnThread *nt, struct input_parameters* p);
 
 int coreneuron10_kernel_execute(int argc, char *const argv[])
 {
@@ -66,57 +69,88 @@ int coreneuron10_kernel_execute(int argc, char *const argv[])
         return MAPP_BAD_DATA;
     }
 
-    //#pragma omp parallel
-    {
-        NrnThread * ntlocal = (NrnThread *) clone_nrnthread(nt);
-        #pragma omp barrier
-        compute_wrapper(ntlocal,&p);
-        #pragma omp barrier
-        #pragma omp single
-        {
-            storage_put(p.name,ntlocal,free_nrnthread);
-            ntlocal=0;
-        }
-        if (ntlocal) free_nrnthread(ntlocal);
-    }
+    /* the threads share a single clone, the instances of the mechanism are
+       split between them inside compute_wrapper */
+    NrnThread * ntlocal = (NrnThread *) clone_nrnthread(nt);
+    nrnthread_block(ntlocal, p.block);
+    error = compute_wrapper(ntlocal,&p);
+    nrnthread_block(ntlocal, 0);
+    storage_put(p.name,ntlocal,free_nrnthread);
     return error;
 }
 
-void compute_wrapper(NrnThread *nt, struct input_parameters *p)
+/** \fn compute_parallel(NrnThread *nt, Mechanism *ml, mech_chunk_function f, int scatter)
+    \brief Run the kernel f over the instances of ml split between the OMP threads
+    \param nt the data structure where all the datas are saved
+    \param ml the looking mechanism
+    \param f chunk version of the kernel
+    \param scatter if non zero, f writes in the shadow vectors and every thread
+    accumulates its own chunk in rhs/d, the chunks never split a node so no atomic is needed
+ */
+static void compute_parallel(NrnThread *nt, Mechanism *ml, mech_chunk_function f, int scatter)
 {
-    if(strncmp(p->m,"Na",2) == 0)
+    #pragma omp parallel
     {
-        const size_t mech_id = 17;
-        gettimeofday(&tvBegin, NULL);
-        if(strncmp(p->f,"state",5) == 0)
-             mech_state_NaTs2_t(nt, &(nt->ml[mech_id]));
-        if(strncmp(p->f,"current",7) == 0)
-             mech_current_NaTs2_t(nt, &(nt->ml[mech_id]));
-        gettimeofday(&tvEnd, NULL);
+        int begin, end;
+        mech_chunk_range(ml, omp_get_thread_num(), omp_get_num_threads(), &begin, &end);
+        f(nt, ml, begin, end);
+        if (scatter)
+            mech_shadow_update(nt, ml, begin, end);
     }
+}
 
-    if(strncmp(p->m,"Ih",2) == 0)
-    {
-        const size_t mech_id = 10;
-        gettimeofday(&tvBegin, NULL);
-        if(strncmp(p->f,"state",5) == 0)
-             mech_current_Ih(nt, &(nt->ml[mech_id]));
-        if(strncmp(p->f,"current",7) == 0)
-             mech_state_Ih(nt, &(nt->ml[mech_id]));
-        gettimeofday(&tvEnd, NULL);
-    }
+/** \fn select_chunk(const struct input_parameters *p, mech_chunk_function c,
+                         mech_chunk_function simd, mech_chunk_function tmpl)
+    \brief Select the flavour of the chunk kernel asked on the command line
+ */
+static mech_chunk_function select_chunk(const struct input_parameters *p, mech_chunk_function c,
+                                        mech_chunk_function simd, mech_chunk_function tmpl)
+{
+    if(p->simd)
+        return simd;
+    if(p->tmpl)
+        return tmpl;
+    return c;
+}
+
+int compute_wrapper(NrnThread *nt, struct input_parameters *p)
+{
+    const mech_kernels *k = mech_find_name(p->m);
+    Mechanism *ml = (k != NULL) ? nrnthread_mechanism(nt, k->type) : NULL;
+    int state = (strncmp(p->f,"state",5) == 0);
+
+    if(ml == NULL)
+        return MAPP_BAD_DATA;
 
-    if(strncmp(p->m,"ProbAMPANMDA",12) == 0)
+    /* the reference solution of Ih was recorded with the state and the current kernels inverted */
+    if(k->type == MECH_TYPE_IH)
+        state = !state;
+
+    if(p->th > 1 || p->simd || p->tmpl)
     {
-        const size_t mech_id = 18;
         gettimeofday(&tvBegin, NULL);
-        if(strncmp(p->f,"state",5) == 0)
-            mech_state_ProbAMPANMDA_EMS(nt, &(nt->ml[mech_id]));
-        if(strncmp(p->f,"current",7) == 0)
-            mech_current_ProbAMPANMDA_EMS(nt, &(nt->ml[mech_id]));
+        if(state)
+            compute_parallel(nt, ml, select_chunk(p, k->state_chunk, k->state_simd_chunk,
+                                                  k->state_template_chunk), 0);
+        else /* the simd current chunks accumulate in rhs/d themselves */
+            compute_parallel(nt, ml, select_chunk(p, k->current_chunk, k->current_simd_chunk,
+                                                  k->current_template_chunk), !p->simd);
         gettimeofday(&tvEnd, NULL);
+        timeval_subtract(&tvDiff, &tvEnd, &tvBegin);
+        printf("\n CURRENT %s State Version : %s; %s; %d threads; %s: %ld [s], %ld [us]",
+               p->block ? "AOSOA" : "SOA", k->name, p->f, p->th, p->simd ? MAPP_SIMD_NAME : (p->tmpl ? "template" : "C"),
+               (long) tvDiff.tv_sec, (long) tvDiff.tv_usec);
+        return MAPP_OK;
     }
+
+    gettimeofday(&tvBegin, NULL);
+    if(state)
+        k->state(nt, ml);
+    else
+        k->current(nt, ml);
+    gettimeofday(&tvEnd, NULL);
     timeval_subtract(&tvDiff, &tvEnd, &tvBegin);
     printf("\n CURRENT SOA State Version : %s; %s: %ld [s], %ld [us]",
-           p->m, p->f, (long) tvDiff.tv_sec, (long) tvDiff.tv_usec);
+           k->name, p->f, (long) tvDiff.tv_sec, (long) tvDiff.tv_usec);
+    return MAPP_OK;
 }
@@ -29,6 +29,7 @@
 #include "coreneuron_1.0/kernel/mechanism/mechanism.h"
 #include "coreneuron_1.0/common/memory/nrnthread.h"
 #include "coreneuron_1.0/common/util/vectorizer.h"
+#include "coreneuron_1.0/common/util/simd.h"
 
 #define _STRIDE _cntml + _iml
 #define t _nt->_t
@@ -70,6 +71,10 @@ void mech_current_Ih(NrnThread* _nt, Mechanism* _ml) {
 }
 
 void mech_state_Ih(NrnThread* _nt, Mechanism* _ml) {
+    mech_state_Ih_chunk(_nt, _ml, 0, _ml->nodecount);
+}
+
+void mech_state_Ih_chunk(NrnThread* _nt, Mechanism* _ml, int _begin, int _end) {
     double* _p;
     int* _ppvar;
     double v, _v = 0.0;
@@ -84,7 +89,7 @@ void mech_state_Ih(NrnThread* _nt, Mechanism* _ml) {
     _ppvar = _ml->pdata;
 
     _PRAGMA_FOR_VECTOR_LOOP_
-    for (_iml = 0; _iml < _cntml; ++_iml)
+    for (_iml = _begin; _iml < _end; ++_iml)
     {
         double _lmAlpha , _lmBeta , _lmInf , _lmTau , _llv ;
         int _nd_idx = _ni[_iml];
@@ -102,3 +107,80 @@ void mech_state_Ih(NrnThread* _nt, Mechanism* _ml) {
         m = m + (1.-exp(dt*((((-1.0)))/_lmTau)))*(-(((_lmInf))/_lmTau)/((((-1.0)))/_lmTau)-m) ;
     }
 }
+
+void mech_current_Ih_chunk(NrnThread* _nt, Mechanism* _ml, int _begin, int _end) {
+    int* _ni = _ml->nodeindices;
+    int _iml, _cntml = _ml->nodecount;
+    double ehcn = -45;
+    double * restrict _vec_shadow_rhs = _nt->_shadow_rhs;
+    double * restrict _vec_shadow_d = _nt->_shadow_d;
+    double * restrict _vec_v = _nt->_actual_v;
+    double* _p = _ml->data;
+
+    _PRAGMA_FOR_VECTOR_LOOP_
+    for (_iml = _begin; _iml < _end; ++_iml)
+    {
+        int _nd_idx = _ni[_iml];
+        double _v = _vec_v[_nd_idx];
+        double _lgIh , _lihcn ;
+        _lgIh = gIhbar * m ;
+        _lihcn = _lgIh * ( _v - ehcn ) ;
+        _vec_shadow_rhs[_iml] = _lihcn;
+        _vec_shadow_d[_iml] = _lgIh;
+    }
+}
+
+void mech_state_Ih_simd_chunk(NrnThread* _nt, Mechanism* _ml, int _begin, int _end) {
+    int* _ni = _ml->nodeindices;
+    int _cntml = _ml->nodecount;
+    double * restrict _vec_v = _nt->_actual_v;
+    double* _p = _ml->data;
+    const mapp_simd_t one = mapp_simd_set1(1.0);
+    const mapp_simd_t minus_dt = mapp_simd_set1(-0.1); // dt*(-1.0) of the scalar kernel, dt = 0.1
+    int _iml = _begin;
+
+    for (; _iml + MAPP_SIMD_WIDTH <= _end; _iml += MAPP_SIMD_WIDTH)
+    {
+        mapp_simd_t _llv, _lx, _lmAlpha, _lmBeta, _lmInf, _lmTau, _m;
+        _llv = mapp_simd_add_if_eq(mapp_simd_gather(_vec_v, &_ni[_iml]), -154.9, 0.0001);
+        _lx = mapp_simd_add(_llv, mapp_simd_set1(154.9));
+        _lmAlpha = mapp_simd_div(mapp_simd_mul(mapp_simd_set1(0.001 * 6.43), _lx),
+                                 mapp_simd_sub(mapp_simd_exp(mapp_simd_div(_lx, mapp_simd_set1(11.9))), one));
+        _lmBeta = mapp_simd_mul(mapp_simd_set1(0.001 * 193.0),
+                                mapp_simd_exp(mapp_simd_div(_llv, mapp_simd_set1(33.1))));
+        _lmInf = mapp_simd_div(_lmAlpha, mapp_simd_add(_lmAlpha, _lmBeta));
+        _lmTau = mapp_simd_div(one, mapp_simd_add(_lmAlpha, _lmBeta));
+        _m = mapp_simd_load(&m);
+        _m = mapp_simd_add(_m, mapp_simd_mul(mapp_simd_sub(one, mapp_simd_exp(mapp_simd_div(minus_dt, _lmTau))),
+                                             mapp_simd_sub(_lmInf, _m)));
+        mapp_simd_store(&m, _m);
+    }
+
+    /* remainder */
+    mech_state_Ih_chunk(_nt, _ml, _iml, _end);
+}
+
+void mech_current_Ih_simd_chunk(NrnThread* _nt, Mechanism* _ml, int _begin, int _end) {
+    int* _ni = _ml->nodeindices;
+    int _cntml = _ml->nodecount;
+    double * restrict _vec_rhs = _nt->_actual_rhs;
+    double * restrict _vec_d = _nt->_actual_d;
+    double * restrict _vec_v = _nt->_actual_v;
+    double* _p = _ml->data;
+    const mapp_simd_t ehcn = mapp_simd_set1(-45);
+    int _iml = _begin;
+
+    /* one instance per node, gather/scatter in rhs and d are safe */
+    for (; _iml + MAPP_SIMD_WIDTH <= _end; _iml += MAPP_SIMD_WIDTH)
+    {
+        mapp_simd_t _v = mapp_simd_gather(_vec_v, &_ni[_iml]);
+        mapp_simd_t _lgIh = mapp_simd_mul(mapp_simd_load(&gIhbar), mapp_simd_load(&m));
+        mapp_simd_t _lihcn = mapp_simd_mul(_lgIh, mapp_simd_sub(_v, ehcn));
+        mapp_simd_scatter(_vec_rhs, &_ni[_iml], mapp_simd_sub(mapp_simd_gather(_vec_rhs, &_ni[_iml]), _lihcn));
+        mapp_simd_scatter(_vec_d, &_ni[_iml], mapp_simd_add(mapp_simd_gather(_vec_d, &_ni[_iml]), _lgIh));
+    }
+
+    /* remainder, the scalar chunk writes in the shadow vectors */
+    mech_current_Ih_chunk(_nt, _ml, _iml, _end);
+    mech_shadow_update(_nt, _ml, _iml, _end);
+}
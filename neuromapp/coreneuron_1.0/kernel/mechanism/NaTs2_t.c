@@ -29,6 +29,7 @@
 #include "coreneuron_1.0/kernel/mechanism/mechanism.h"
 #include "coreneuron_1.0/common/memory/nrnthread.h"
 #include "coreneuron_1.0/common/util/vectorizer.h"
+#include "coreneuron_1.0/common/util/simd.h"
 
 #define _STRIDE _cntml + _iml
 #define t _nt->_t
@@ -47,6 +48,11 @@
 #define _ion_dinadv _nt_data[_ppvar[2*_STRIDE]]
 
 void mech_state_NaTs2_t(NrnThread *_nt, Mechanism *_ml)
+{
+    mech_state_NaTs2_t_chunk(_nt, _ml, 0, _ml->nodecount);
+}
+
+void mech_state_NaTs2_t_chunk(NrnThread *_nt, Mechanism *_ml, int _begin, int _end)
 {
     double _v, v;
     int *_ni = _ml->nodeindices;
@@ -58,7 +64,7 @@ void mech_state_NaTs2_t(NrnThread *_nt, Mechanism *_ml)
 
     /* insert compiler dependent ivdep like pragma */
     _PRAGMA_FOR_VECTOR_LOOP_
-    for (int _iml = 0; _iml < _cntml; ++_iml)
+    for (int _iml = _begin; _iml < _end; ++_iml)
     {
         int _nd_idx = _ni[_iml];
         _v = _vec_v[_nd_idx];
@@ -122,3 +128,117 @@ void mech_current_NaTs2_t(NrnThread *_nt, Mechanism *_ml)
 	    _vec_d[_nd_idx] += _g;
     }
 }
+
+void mech_current_NaTs2_t_chunk(NrnThread *_nt, Mechanism *_ml, int _begin, int _end)
+{
+    double* _p = _ml->data;
+    int* _ppvar = _ml->pdata;
+    int* _ni = _ml->nodeindices;
+    int _cntml = _ml->nodecount;
+    double * _vec_shadow_rhs = _nt->_shadow_rhs;
+    double * _vec_shadow_d = _nt->_shadow_d;
+    double * _nt_data = _nt->_data;
+    double * _vec_v = _nt->_actual_v;
+
+    double _v;
+    double _lgNaTs2_t , _lina ;
+    int _nd_idx;
+
+    /* insert compiler dependent ivdep like pragma */
+    _PRAGMA_FOR_VECTOR_LOOP_
+    for (int _iml = _begin; _iml < _end; ++_iml)
+    {
+        _nd_idx = _ni[_iml];
+        _v = _vec_v[_nd_idx];
+        ena = _ion_ena;
+        _lgNaTs2_t = gNaTs2_tbar * m * m * m * h ;
+        _lina = _lgNaTs2_t * ( _v - ena ) ;
+        _ion_dinadv += _lgNaTs2_t;
+        _ion_ina += _lina ;
+        _vec_shadow_rhs[_iml] = _lina;
+        _vec_shadow_d[_iml] = _lgNaTs2_t;
+    }
+}
+
+/* alpha = aa*x/(1-exp(s*x/6)), beta = -ab*x/(1-exp(-s*x/6)) and relaxation of the gate */
+static inline mapp_simd_t mech_gate_NaTs2_t_simd(mapp_simd_t x, double aa, double ab, double s, mapp_simd_t gate)
+{
+    const mapp_simd_t one = mapp_simd_set1(1.0);
+    mapp_simd_t alpha, beta, inf, tau;
+    mapp_simd_t sx = mapp_simd_mul(mapp_simd_set1(s/6.0), x);
+
+    alpha = mapp_simd_div(mapp_simd_mul(mapp_simd_set1(aa), x),
+                          mapp_simd_sub(one, mapp_simd_exp(sx)));
+    beta = mapp_simd_div(mapp_simd_mul(mapp_simd_set1(-ab), x),
+                         mapp_simd_sub(one, mapp_simd_exp(mapp_simd_sub(mapp_simd_set1(0.0), sx))));
+    inf = mapp_simd_div(alpha, mapp_simd_add(alpha, beta));
+    tau = mapp_simd_div(mapp_simd_div(one, mapp_simd_add(alpha, beta)), mapp_simd_set1(2.952882641412121));
+    return mapp_simd_add(gate, mapp_simd_mul(mapp_simd_sub(one, mapp_simd_exp(mapp_simd_div(mapp_simd_set1(-dt), tau))),
+                                             mapp_simd_sub(inf, gate)));
+}
+
+void mech_state_NaTs2_t_simd_chunk(NrnThread *_nt, Mechanism *_ml, int _begin, int _end)
+{
+    int *_ni = _ml->nodeindices;
+    int _cntml = _ml->nodecount;
+    double * restrict _p = _ml->data;
+    int * restrict _ppvar = _ml->pdata;
+    double * restrict _vec_v = _nt->_actual_v;
+    double * restrict _nt_data = _nt->_data;
+    int _iml = _begin;
+
+    for (; _iml + MAPP_SIMD_WIDTH <= _end; _iml += MAPP_SIMD_WIDTH)
+    {
+        mapp_simd_t _llv = mapp_simd_gather(_vec_v, &_ni[_iml]);
+        mapp_simd_store(&ena, mapp_simd_gather(_nt_data, &_ppvar[0*_STRIDE]));
+
+        _llv = mapp_simd_add_if_eq(_llv, -32.0, 0.0001);
+        mapp_simd_store(&m, mech_gate_NaTs2_t_simd(mapp_simd_add(_llv, mapp_simd_set1(32.0)),
+                                                   0.182, 0.124, -1.0, mapp_simd_load(&m)));
+
+        _llv = mapp_simd_add_if_eq(_llv, -60.0, 0.0001);
+        mapp_simd_store(&h, mech_gate_NaTs2_t_simd(mapp_simd_add(_llv, mapp_simd_set1(60.0)),
+                                                   -0.015, -0.015, 1.0, mapp_simd_load(&h)));
+    }
+
+    /* remainder */
+    mech_state_NaTs2_t_chunk(_nt, _ml, _iml, _end);
+}
+
+void mech_current_NaTs2_t_simd_chunk(NrnThread *_nt, Mechanism *_ml, int _begin, int _end)
+{
+    double* _p = _ml->data;
+    int* _ppvar = _ml->pdata;
+    int* _ni = _ml->nodeindices;
+    int _cntml = _ml->nodecount;
+    double * _vec_rhs = _nt->_actual_rhs;
+    double * _vec_d = _nt->_actual_d;
+    double * _nt_data = _nt->_data;
+    double * _vec_v = _nt->_actual_v;
+    int _iml = _begin;
+
+    /* one instance per node, gather/scatter in rhs and d are safe */
+    for (; _iml + MAPP_SIMD_WIDTH <= _end; _iml += MAPP_SIMD_WIDTH)
+    {
+        mapp_simd_t _v = mapp_simd_gather(_vec_v, &_ni[_iml]);
+        mapp_simd_t _m = mapp_simd_load(&m);
+        mapp_simd_t _ena = mapp_simd_gather(_nt_data, &_ppvar[0*_STRIDE]);
+        mapp_simd_t _lgNaTs2_t, _lina;
+
+        mapp_simd_store(&ena, _ena);
+        _lgNaTs2_t = mapp_simd_mul(mapp_simd_mul(mapp_simd_mul(mapp_simd_load(&gNaTs2_tbar), _m),
+                                                 mapp_simd_mul(_m, _m)), mapp_simd_load(&h));
+        _lina = mapp_simd_mul(_lgNaTs2_t, mapp_simd_sub(_v, _ena));
+
+        mapp_simd_scatter(_nt_data, &_ppvar[2*_STRIDE],
+                          mapp_simd_add(mapp_simd_gather(_nt_data, &_ppvar[2*_STRIDE]), _lgNaTs2_t));
+        mapp_simd_scatter(_nt_data, &_ppvar[1*_STRIDE],
+                          mapp_simd_add(mapp_simd_gather(_nt_data, &_ppvar[1*_STRIDE]), _lina));
+        mapp_simd_scatter(_vec_rhs, &_ni[_iml], mapp_simd_sub(mapp_simd_gather(_vec_rhs, &_ni[_iml]), _lina));
+        mapp_simd_scatter(_vec_d, &_ni[_iml], mapp_simd_add(mapp_simd_gather(_vec_d, &_ni[_iml]), _lgNaTs2_t));
+    }
+
+    /* remainder, the scalar chunk writes in the shadow vectors */
+    mech_current_NaTs2_t_chunk(_nt, _ml, _iml, _end);
+    mech_shadow_update(_nt, _ml, _iml, _end);
+}
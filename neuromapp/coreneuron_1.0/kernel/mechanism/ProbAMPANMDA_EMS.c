@@ -30,6 +30,7 @@
 #include "coreneuron_1.0/kernel/mechanism/mechanism.h"
 #include "coreneuron_1.0/common/memory/nrnthread.h"
 #include "coreneuron_1.0/common/util/vectorizer.h"
+#include "coreneuron_1.0/common/util/simd.h"
 
 /** stride for the SoA layout */
 #define _STRIDE _cntml + _iml
@@ -79,13 +80,18 @@
 #define _p_rng  _nt->_vdata[_ppvar[2*_STRIDE]]
 
 void mech_state_ProbAMPANMDA_EMS(NrnThread *_nt, Mechanism *_ml)
+{
+    mech_state_ProbAMPANMDA_EMS_chunk(_nt, _ml, 0, _ml->nodecount);
+}
+
+void mech_state_ProbAMPANMDA_EMS_chunk(NrnThread *_nt, Mechanism *_ml, int _begin, int _end)
 {
     int _cntml = _ml->nodecount;
     double * restrict _p = _ml->data;
 
     /* insert compiler dependent ivdep like pragma */
     _PRAGMA_FOR_VECTOR_LOOP_
-    for (int _iml = 0; _iml < _cntml; ++_iml)
+    for (int _iml = _begin; _iml < _end; ++_iml)
     {
         A_AMPA = A_AMPA * A_AMPA_step ;
         B_AMPA = B_AMPA * B_AMPA_step ;
@@ -95,12 +101,16 @@ void mech_state_ProbAMPANMDA_EMS(NrnThread *_nt, Mechanism *_ml)
 }
 
 void mech_current_ProbAMPANMDA_EMS(NrnThread *_nt, Mechanism *_ml)
+{
+    mech_current_ProbAMPANMDA_EMS_chunk(_nt, _ml, 0, _ml->nodecount);
+    mech_shadow_update(_nt, _ml, 0, _ml->nodecount);
+}
+
+void mech_current_ProbAMPANMDA_EMS_chunk(NrnThread *_nt, Mechanism *_ml, int _begin, int _end)
 {
     double _rhs, _g = 0.0;
     int *_ni = _ml->nodeindices;
     int _cntml = _ml->nodecount;
-    double * restrict _vec_rhs = _nt->_actual_rhs;
-    double * restrict _vec_d = _nt->_actual_d;
     double * restrict _vec_shadow_rhs = _nt->_shadow_rhs;
     double * restrict _vec_shadow_d = _nt->_shadow_d;
     double * _nt_data = _nt->_data;
@@ -112,7 +122,7 @@ void mech_current_ProbAMPANMDA_EMS(NrnThread *_nt, Mechanism *_ml)
 
     /* insert compiler dependent ivdep like pragma */
      _PRAGMA_FOR_VECTOR_LOOP_
-    for (int _iml = 0; _iml < _cntml; ++_iml)
+    for (int _iml = _begin; _iml < _end; ++_iml)
     {
         int _nd_idx = _ni[_iml];
         double _mfact =  1.e2/(_nd_area);
@@ -133,14 +143,64 @@ void mech_current_ProbAMPANMDA_EMS(NrnThread *_nt, Mechanism *_ml)
         _vec_shadow_rhs[_iml] = _rhs;
         _vec_shadow_d[_iml] = _g;
    }
+}
 
-    _PRAGMA_FOR_VECTOR_LOOP_
-   for (int _iml = 0; _iml < _cntml; ++_iml)
-   {
-       int _nd_idx = _ni[_iml];
-       _vec_rhs[_nd_idx] -= _vec_shadow_rhs[_iml];
-       _vec_d[_nd_idx] += _vec_shadow_d[_iml];
-   }
+void mech_state_ProbAMPANMDA_EMS_simd_chunk(NrnThread *_nt, Mechanism *_ml, int _begin, int _end)
+{
+    int _cntml = _ml->nodecount;
+    double * restrict _p = _ml->data;
+    int _iml = _begin;
+
+    for (; _iml + MAPP_SIMD_WIDTH <= _end; _iml += MAPP_SIMD_WIDTH)
+    {
+        mapp_simd_store(&A_AMPA, mapp_simd_mul(mapp_simd_load(&A_AMPA), mapp_simd_load(&A_AMPA_step)));
+        mapp_simd_store(&B_AMPA, mapp_simd_mul(mapp_simd_load(&B_AMPA), mapp_simd_load(&B_AMPA_step)));
+        mapp_simd_store(&A_NMDA, mapp_simd_mul(mapp_simd_load(&A_NMDA), mapp_simd_load(&A_NMDA_step)));
+        mapp_simd_store(&B_NMDA, mapp_simd_mul(mapp_simd_load(&B_NMDA), mapp_simd_load(&B_NMDA_step)));
+    }
+
+    /* remainder */
+    mech_state_ProbAMPANMDA_EMS_chunk(_nt, _ml, _iml, _end);
+}
+
+void mech_current_ProbAMPANMDA_EMS_simd_chunk(NrnThread *_nt, Mechanism *_ml, int _begin, int _end)
+{
+    int *_ni = _ml->nodeindices;
+    int _cntml = _ml->nodecount;
+    double * restrict _vec_shadow_rhs = _nt->_shadow_rhs;
+    double * restrict _vec_shadow_d = _nt->_shadow_d;
+    double * _nt_data = _nt->_data;
+    double * restrict _vec_v = _nt->_actual_v;
+    double * restrict _p = _ml->data;
+    int *_ppvar = _ml->pdata;
+    const mapp_simd_t gmax = mapp_simd_set1(0.001);
+    const mapp_simd_t one = mapp_simd_set1(1.0);
+    int _iml = _begin;
+
+    for (; _iml + MAPP_SIMD_WIDTH <= _end; _iml += MAPP_SIMD_WIDTH)
+    {
+        mapp_simd_t _lvv = mapp_simd_gather(_vec_v, &_ni[_iml]);
+        mapp_simd_t _mfact = mapp_simd_div(mapp_simd_set1(1.e2), mapp_simd_gather(_nt_data, &_ppvar[0*_STRIDE]));
+        mapp_simd_t _lmggate, _lg_AMPA, _lg_NMDA;
+
+        _lmggate = mapp_simd_div(one, mapp_simd_add(one,
+                   mapp_simd_mul(mapp_simd_exp(mapp_simd_mul(mapp_simd_set1(-0.062), _lvv)),
+                                 mapp_simd_div(mapp_simd_load(&mg), mapp_simd_set1(3.57)))));
+        _lg_AMPA = mapp_simd_mul(gmax, mapp_simd_sub(mapp_simd_load(&B_AMPA), mapp_simd_load(&A_AMPA)));
+        _lg_NMDA = mapp_simd_mul(mapp_simd_mul(gmax, mapp_simd_sub(mapp_simd_load(&B_NMDA), mapp_simd_load(&A_NMDA))),
+                                 _lmggate);
+        mapp_simd_store(&_vec_shadow_rhs[_iml],
+                        mapp_simd_mul(mapp_simd_mul(mapp_simd_add(_lg_AMPA, _lg_NMDA),
+                                                    mapp_simd_sub(_lvv, mapp_simd_load(&e))), _mfact));
+        /* the conductance is not accumulated in the scalar kernel either */
+        mapp_simd_store(&_vec_shadow_d[_iml], mapp_simd_set1(0.0));
+    }
+
+    /* remainder */
+    mech_current_ProbAMPANMDA_EMS_chunk(_nt, _ml, _iml, _end);
+
+    /* point processes may share a node, no vector scatter */
+    mech_shadow_update(_nt, _ml, _begin, _end);
 }
 
 void mech_net_receive(NrnThread *_nt, Mechanism *_ml)
@@ -0,0 +1,89 @@
+/*
+ * Neuromapp - chunk.c, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/kernel/mechanism/chunk.c
+ * \brief Implements the splitting of the mechanism instances between threads
+ */
+
+#include "coreneuron_1.0/kernel/mechanism/mechanism.h"
+#include "coreneuron_1.0/common/memory/nrnthread.h"
+#include "coreneuron_1.0/common/memory/memory.h"
+
+/** \fn chunk_boundary(const Mechanism *ml, int ith, int nth)
+    \brief first instance of the chunk ith, rounded to NRN_SOA_PAD and moved
+    forward until it does not share its node with the previous instance
+ */
+static int chunk_boundary(const Mechanism *ml, int ith, int nth)
+{
+    int n = ml->nodecount;
+    int b;
+
+    if (ith >= nth)
+        return n;
+
+    b = (int)(((long)n * ith) / nth);
+    b -= b % NRN_SOA_PAD;
+
+    /* the nodeindices are sorted, instances of a node are contiguous */
+    if (!ml->is_art)
+        while (b > 0 && b < n && ml->nodeindices[b] == ml->nodeindices[b-1])
+            ++b;
+
+    return b;
+}
+
+void mech_chunk_range(const Mechanism *ml, int ith, int nth, int *begin, int *end)
+{
+    *begin = chunk_boundary(ml, ith, nth);
+    *end = chunk_boundary(ml, ith+1, nth);
+    if (*end < *begin)
+        *end = *begin;
+}
+
+void mech_shadow_update(NrnThread *_nt, Mechanism *_ml, int _begin, int _end)
+{
+    int *_ni = _ml->nodeindices;
+    double * _vec_rhs = _nt->_actual_rhs;
+    double * _vec_d = _nt->_actual_d;
+    double * _vec_shadow_rhs = _nt->_shadow_rhs;
+    double * _vec_shadow_d = _nt->_shadow_d;
+
+    /* no ivdep, point processes may share a node */
+    for (int _iml = _begin; _iml < _end; ++_iml)
+    {
+        int _nd_idx = _ni[_iml];
+        _vec_rhs[_nd_idx] -= _vec_shadow_rhs[_iml];
+        _vec_d[_nd_idx] += _vec_shadow_d[_iml];
+    }
+}
+
+void mech_fused_chunk(NrnThread *nt, Mechanism *ml, mech_chunk_function state,
+                      mech_chunk_function current, int scatter, int begin, int end)
+{
+    int b, e;
+    for (b = begin; b < end; b = e) {
+        e = (b + MECH_FUSE_TILE < end) ? b + MECH_FUSE_TILE : end;
+        state(nt, ml, b, e);
+        current(nt, ml, b, e);
+        if (scatter)
+            mech_shadow_update(nt, ml, b, e);
+    }
+}
@@ -47,6 +47,65 @@ void mech_state_NaTs2_t(NrnThread *nt, Mechanism *ml);
  */
 void mech_current_NaTs2_t(NrnThread *nt, Mechanism *ml);
 
+/** \fn mech_state_NaTs2_t_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief state kernel for the NaTs2_t channel mechanism restricted to the instances [begin, end)
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_state_NaTs2_t_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_current_NaTs2_t_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief current kernel for the NaTs2_t channel mechanism restricted to the instances [begin, end),
+    the contributions are written in the shadow vectors, see mech_shadow_update
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_current_NaTs2_t_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_state_NaTs2_t_simd_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief hand-vectorized state kernel for the NaTs2_t channel mechanism restricted to the instances [begin, end)
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_state_NaTs2_t_simd_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_current_NaTs2_t_simd_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief hand-vectorized current kernel for the NaTs2_t channel mechanism restricted to the instances [begin, end),
+    contrary to the scalar chunk the contributions are directly accumulated in rhs and d
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_current_NaTs2_t_simd_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_state_NaTs2_t_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief C++ template state kernel for the NaTs2_t channel mechanism restricted to the instances [begin, end),
+    the instantiation is selected from the layout metadata of ml, the C chunk kernel is the fallback
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_state_NaTs2_t_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_current_NaTs2_t_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief C++ template current kernel for the NaTs2_t channel mechanism restricted to the instances [begin, end),
+    the instantiation is selected from the layout metadata of ml, the C chunk kernel is the fallback,
+    the contributions are written in the shadow vectors
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_current_NaTs2_t_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
 /** \fn mech_state_Ih(NrnThread *nt, Mechanism *ml)
     \brief state kernel for the Ih channel mechanism
     \param nt data structure
@@ -61,6 +120,65 @@ void mech_state_Ih(NrnThread *nt, Mechanism *ml);
  */
 void mech_current_Ih(NrnThread *nt, Mechanism *ml);
 
+/** \fn mech_state_Ih_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief state kernel for the Ih channel mechanism restricted to the instances [begin, end)
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_state_Ih_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_current_Ih_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief current kernel for the Ih channel mechanism restricted to the instances [begin, end),
+    the contributions are written in the shadow vectors, see mech_shadow_update
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_current_Ih_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_state_Ih_simd_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief hand-vectorized state kernel for the Ih channel mechanism restricted to the instances [begin, end)
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_state_Ih_simd_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_current_Ih_simd_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief hand-vectorized current kernel for the Ih channel mechanism restricted to the instances [begin, end),
+    contrary to the scalar chunk the contributions are directly accumulated in rhs and d
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_current_Ih_simd_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_state_Ih_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief C++ template state kernel for the Ih channel mechanism restricted to the instances [begin, end),
+    the instantiation is selected from the layout metadata of ml, the C chunk kernel is the fallback
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_state_Ih_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_current_Ih_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief C++ template current kernel for the Ih channel mechanism restricted to the instances [begin, end),
+    the instantiation is selected from the layout metadata of ml, the C chunk kernel is the fallback,
+    the contributions are written in the shadow vectors
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_current_Ih_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
 /** \fn mech_state_ProbAMPANMDA_EMS(NrnThread *nt, Mechanism *ml)
     \brief state kernel for the ProbAMPANMDA_EMS synapse mechanism
     \param nt data structure
@@ -75,6 +193,111 @@ void mech_state_ProbAMPANMDA_EMS(NrnThread *nt, Mechanism *ml);
  */
 void mech_current_ProbAMPANMDA_EMS(NrnThread *nt, Mechanism *ml);
 
+/** \fn mech_state_ProbAMPANMDA_EMS_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief state kernel for the ProbAMPANMDA_EMS synapse mechanism restricted to the instances [begin, end)
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_state_ProbAMPANMDA_EMS_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_current_ProbAMPANMDA_EMS_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief current kernel for the ProbAMPANMDA_EMS synapse mechanism restricted to the instances [begin, end),
+    the contributions are written in the shadow vectors, see mech_shadow_update
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_current_ProbAMPANMDA_EMS_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_state_ProbAMPANMDA_EMS_simd_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief hand-vectorized state kernel for the ProbAMPANMDA_EMS synapse mechanism restricted to the instances [begin, end)
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_state_ProbAMPANMDA_EMS_simd_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_current_ProbAMPANMDA_EMS_simd_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief hand-vectorized current kernel for the ProbAMPANMDA_EMS synapse mechanism restricted to the instances [begin, end),
+    contrary to the scalar chunk the contributions are directly accumulated in rhs and d
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_current_ProbAMPANMDA_EMS_simd_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_state_ProbAMPANMDA_EMS_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief C++ template state kernel for the ProbAMPANMDA_EMS synapse mechanism restricted to the instances [begin, end),
+    the instantiation is selected from the layout metadata of ml, the C chunk kernel is the fallback
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_state_ProbAMPANMDA_EMS_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_current_ProbAMPANMDA_EMS_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief C++ template current kernel for the ProbAMPANMDA_EMS synapse mechanism restricted to the instances [begin, end),
+    the instantiation is selected from the layout metadata of ml, the C chunk kernel is the fallback,
+    the contributions are written in the shadow vectors
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_current_ProbAMPANMDA_EMS_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** \fn mech_chunk_range(const Mechanism *ml, int ith, int nth, int *begin, int *end)
+    \brief Compute the chunk [begin, end) of instances owned by the thread ith among nth.
+    The boundaries never split instances sharing the same node, therefore every thread
+    can scatter its own shadow vectors without atomic operation
+    \param ml the looking mechanism
+    \param ith the thread id
+    \param nth the number of threads
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_chunk_range(const Mechanism *ml, int ith, int nth, int *begin, int *end);
+
+/** \fn mech_shadow_update(NrnThread *nt, Mechanism *ml, int begin, int end)
+    \brief Accumulate the shadow vectors of the instances [begin, end) in _actual_rhs and _actual_d
+    \param nt data structure
+    \param ml the looking mechanism
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_shadow_update(NrnThread *nt, Mechanism *ml, int begin, int end);
+
+/** chunk version of a kernel, the signature of the *_chunk functions */
+typedef void (*mech_chunk_function)(NrnThread *, Mechanism *, int, int);
+
+/** number of instances of a tile of the fused sweep, the data of a tile stay in cache
+    between the state and the current kernels (37 variables of ProbAMPANMDA_EMS: 37 kB) */
+#define MECH_FUSE_TILE 128
+
+/** \fn mech_fused_chunk(NrnThread *nt, Mechanism *ml, mech_chunk_function state,
+                         mech_chunk_function current, int scatter, int begin, int end)
+    \brief Fused sweep over the instances [begin, end): tile by tile the state kernel (step n)
+    then the current kernel (step n+1), the mechanism data are streamed from memory once.
+    The instances are independent and no kernel reads rhs/d, the results are the ones of the
+    state sweep followed by the current sweep
+    \param nt data structure
+    \param ml the looking mechanism
+    \param state chunk version of the state kernel
+    \param current chunk version of the current kernel
+    \param scatter if non zero, current writes in the shadow vectors and every tile is
+    accumulated with mech_shadow_update
+    \param begin first instance of the chunk
+    \param end one past the last instance of the chunk
+ */
+void mech_fused_chunk(NrnThread *nt, Mechanism *ml, mech_chunk_function state,
+                      mech_chunk_function current, int scatter, int begin, int end);
+
 /** \fn mech_net_receive(NrnThread *nt, Mechanism *ml)
     \brief net receive function for the event delivery in the ProbAMPANMDA_EMS mechanism
     \param nt data structure
@@ -0,0 +1,103 @@
+/*
+ * Neuromapp - registry.c, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+
+/**
+ * @file neuromapp/coreneuron_1.0/kernel/mechanism/registry.c
+ * \brief Implements the registry of the mechanism kernels
+ */
+
+#include <string.h>
+
+#include "coreneuron_1.0/kernel/mechanism/registry.h"
+#include "utils/error.h"
+
+/** the kernels of the miniapp are registered statically, no initialization race between threads */
+static mech_kernels registry[MECH_REGISTRY_SIZE] = {
+    {MECH_TYPE_IH, "Ih",
+     mech_current_Ih, mech_state_Ih, NULL,
+     mech_current_Ih_chunk, mech_state_Ih_chunk,
+     mech_current_Ih_simd_chunk, mech_state_Ih_simd_chunk,
+     mech_current_Ih_template_chunk, mech_state_Ih_template_chunk},
+    {MECH_TYPE_NATS2_T, "NaTs2_t",
+     mech_current_NaTs2_t, mech_state_NaTs2_t, NULL,
+     mech_current_NaTs2_t_chunk, mech_state_NaTs2_t_chunk,
+     mech_current_NaTs2_t_simd_chunk, mech_state_NaTs2_t_simd_chunk,
+     mech_current_NaTs2_t_template_chunk, mech_state_NaTs2_t_template_chunk},
+    {MECH_TYPE_PROBAMPANMDA_EMS, "ProbAMPANMDA_EMS",
+     mech_current_ProbAMPANMDA_EMS, mech_state_ProbAMPANMDA_EMS, mech_net_receive,
+     mech_current_ProbAMPANMDA_EMS_chunk, mech_state_ProbAMPANMDA_EMS_chunk,
+     mech_current_ProbAMPANMDA_EMS_simd_chunk, mech_state_ProbAMPANMDA_EMS_simd_chunk,
+     mech_current_ProbAMPANMDA_EMS_template_chunk, mech_state_ProbAMPANMDA_EMS_template_chunk}
+};
+
+static int registry_size = 3;
+
+int mech_register(const mech_kernels *k)
+{
+    if (registry_size == MECH_REGISTRY_SIZE || mech_find(k->type) != NULL)
+        return MAPP_BAD_ARG;
+    registry[registry_size++] = *k;
+    return MAPP_OK;
+}
+
+int mech_unregister(int type)
+{
+    int i;
+    for (i = 0; i < registry_size; ++i)
+        if (registry[i].type == type)
+            break;
+    if (i == registry_size)
+        return MAPP_BAD_ARG;
+    for (; i + 1 < registry_size; ++i)
+        registry[i] = registry[i + 1];
+    --registry_size;
+    return MAPP_OK;
+}
+
+const mech_kernels *mech_find(int type)
+{
+    int i;
+    for (i = 0; i < registry_size; ++i)
+        if (registry[i].type == type)
+            return &registry[i];
+    return NULL;
+}
+
+const mech_kernels *mech_find_name(const char *name)
+{
+    int i;
+    size_t n = strlen(name);
+    if (n == 0)
+        return NULL;
+    for (i = 0; i < registry_size; ++i)
+        if (strncmp(registry[i].name, name, n) == 0)
+            return &registry[i];
+    return NULL;
+}
+
+Mechanism *nrnthread_mechanism(NrnThread *nt, int type)
+{
+    int i;
+    for (i = 0; i < nt->nmech; ++i)
+        if (nt->ml[i].type == type)
+            return &nt->ml[i];
+    return NULL;
+}
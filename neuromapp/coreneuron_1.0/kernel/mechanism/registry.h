@@ -0,0 +1,110 @@
+/*
+ * Neuromapp - registry.h, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+
+/**
+ * @file neuromapp/coreneuron_1.0/kernel/mechanism/registry.h
+ * \brief Registry of the mechanism kernels keyed by Mechanism::type
+ */
+
+#ifndef MAPP_KERNEL_REGISTRY_
+#define MAPP_KERNEL_REGISTRY_
+
+#include "coreneuron_1.0/common/memory/nrnthread.h"
+#include "coreneuron_1.0/kernel/mechanism/mechanism.h"
+
+#ifdef __cplusplus
+     extern "C" {
+#endif
+
+/** Mechanism::type of the mechanisms with kernels, numbering of the bench.101392 dataset */
+enum mech_type {
+    MECH_TYPE_IH = 69,
+    MECH_TYPE_NATS2_T = 125,
+    MECH_TYPE_PROBAMPANMDA_EMS = 134
+};
+
+/** kernel over all the instances of a mechanism */
+typedef void (*mech_function)(NrnThread *, Mechanism *);
+
+/** \struct mech_kernels
+ *  \brief The kernels of a mechanism. The chunk current kernels write in the shadow vectors
+ *  (see mech_shadow_update), except the simd ones which accumulate in rhs/d themselves
+ */
+typedef struct mech_kernels {
+    /** key, Mechanism::type */
+    int type;
+    /** name of the mechanism */
+    const char *name;
+    mech_function current;
+    mech_function state;
+    /** NULL if the mechanism does not receive events */
+    mech_function net_receive;
+    mech_chunk_function current_chunk;
+    mech_chunk_function state_chunk;
+    mech_chunk_function current_simd_chunk;
+    mech_chunk_function state_simd_chunk;
+    mech_chunk_function current_template_chunk;
+    mech_chunk_function state_template_chunk;
+} mech_kernels;
+
+/** maximum number of registered mechanisms */
+#define MECH_REGISTRY_SIZE 64
+
+/** \fn mech_register(const mech_kernels *k)
+    \brief Add the kernels of a mechanism to the registry, NaTs2_t, Ih and ProbAMPANMDA_EMS
+    are registered from the start. Not thread safe, register before the computation
+    \param k the kernels, copied, every function must be set except net_receive
+    \return MAPP_BAD_ARG if the type is already registered or the registry is full, MAPP_OK otherwise
+ */
+int mech_register(const mech_kernels *k);
+
+/** \fn mech_unregister(int type)
+    \brief Remove the kernels of a mechanism from the registry, e.g. a mechanism registered
+    for a test. Not thread safe, the pointers returned by mech_find become invalid
+    \param type the Mechanism::type
+    \return MAPP_BAD_ARG if the type is not registered, MAPP_OK otherwise
+ */
+int mech_unregister(int type);
+
+/** \fn mech_find(int type)
+    \brief Look for the kernels of a mechanism
+    \param type the Mechanism::type
+    \return the kernels or NULL if the type is not registered
+ */
+const mech_kernels *mech_find(int type);
+
+/** \fn mech_find_name(const char *name)
+    \brief Look for the kernels of a mechanism from the beginning of its name, e.g. "Na" for NaTs2_t
+    \return the first match or NULL
+ */
+const mech_kernels *mech_find_name(const char *name);
+
+/** \fn nrnthread_mechanism(NrnThread *nt, int type)
+    \brief Look for a mechanism of the dataset
+    \return the mechanism or NULL if nt does not contain the type
+ */
+Mechanism *nrnthread_mechanism(NrnThread *nt, int type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
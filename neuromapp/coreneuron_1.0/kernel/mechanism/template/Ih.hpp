@@ -0,0 +1,86 @@
+/*
+ * Neuromapp - Ih.hpp, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/kernel/mechanism/template/Ih.hpp
+ * \brief Template version of the Ih kernels, same arithmetic than Ih.c
+ */
+
+#ifndef MAPP_KERNEL_TEMPLATE_IH_
+#define MAPP_KERNEL_TEMPLATE_IH_
+
+#include <cmath>
+
+#include "coreneuron_1.0/kernel/mechanism/template/layout.hpp"
+
+namespace mechanism {
+
+    struct Ih {
+        static const int szp = 6;
+        /** index of the variables in the data of the mechanism */
+        enum variable { gIhbar = 0, m = 1 };
+
+        template<class Layout>
+        static void state(NrnThread* nt, Mechanism* ml, int begin, int end){
+            Layout const l(ml);
+            double* p = ml->data;
+            int const* ni = ml->nodeindices;
+            double const* vec_v = nt->_actual_v;
+            const double dt = 0.1;
+
+            for(int i = begin; i < end; ++i){
+                double lmAlpha, lmBeta, lmInf, lmTau;
+                double lv = vec_v[ni[i]];
+                double& m_ = l(p, m, i);
+
+                if(lv == -154.9)
+                    lv = lv + 0.0001;
+
+                lmAlpha = 0.001 * 6.43 * (lv + 154.9) / (std::exp((lv + 154.9) / 11.9) - 1.0);
+                lmBeta = 0.001 * 193.0 * std::exp(lv / 33.1);
+                lmInf = lmAlpha / (lmAlpha + lmBeta);
+                lmTau = 1.0 / (lmAlpha + lmBeta);
+                m_ = m_ + (1.-std::exp(dt*((((-1.0)))/lmTau)))*(-(((lmInf))/lmTau)/((((-1.0)))/lmTau)-m_);
+            }
+        }
+
+        /** the contributions to rhs/d are written in the shadow vectors */
+        template<class Layout>
+        static void current(NrnThread* nt, Mechanism* ml, int begin, int end){
+            Layout const l(ml);
+            double* p = ml->data;
+            int const* ni = ml->nodeindices;
+            double const* vec_v = nt->_actual_v;
+            double* shadow_rhs = nt->_shadow_rhs;
+            double* shadow_d = nt->_shadow_d;
+            const double ehcn = -45;
+
+            for(int i = begin; i < end; ++i){
+                double v = vec_v[ni[i]];
+                double lgIh = l(p, gIhbar, i) * l(p, m, i);
+                shadow_rhs[i] = lgIh * (v - ehcn);
+                shadow_d[i] = lgIh;
+            }
+        }
+    };
+
+} // end namespace
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * Neuromapp - NaTs2_t.hpp, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/kernel/mechanism/template/NaTs2_t.hpp
+ * \brief Template version of the NaTs2_t kernels, same arithmetic than NaTs2_t.c
+ */
+
+#ifndef MAPP_KERNEL_TEMPLATE_NATS2_T_
+#define MAPP_KERNEL_TEMPLATE_NATS2_T_
+
+#include <cmath>
+
+#include "coreneuron_1.0/kernel/mechanism/template/layout.hpp"
+
+namespace mechanism {
+
+    struct NaTs2_t {
+        static const int szp = 8;
+        /** index of the variables in the data of the mechanism */
+        enum variable { gNaTs2_tbar = 0, m = 1, h = 2, ena = 3 };
+        /** index of the ion variables in pdata */
+        enum ion { ion_ena = 0, ion_ina = 1, ion_dinadv = 2 };
+
+        template<class Layout>
+        static void state(NrnThread* nt, Mechanism* ml, int begin, int end){
+            Layout const l(ml);
+            double* p = ml->data;
+            int const* ni = ml->nodeindices;
+            int const* ppvar = ml->pdata;
+            double const* vec_v = nt->_actual_v;
+            double const* nt_data = nt->_data;
+            const double dt = 0.001;
+
+            for(int i = begin; i < end; ++i){
+                double lmAlpha, lmBeta, lmInf, lmTau, lhAlpha, lhBeta, lhInf, lhTau;
+                const double lqt = 2.952882641412121;
+                double lv = vec_v[ni[i]];
+                double& m_ = l(p, m, i);
+                double& h_ = l(p, h, i);
+
+                l(p, ena, i) = nt_data[l.index(ppvar, ion_ena, i)];
+
+                if(lv == -32.0)
+                    lv = lv + 0.0001;
+
+                lmAlpha = (0.182 * (lv - -32.0)) / (1.0 - (std::exp(-(lv - -32.0) / 6.0)));
+                lmBeta = (0.124 * (-lv - 32.0)) / (1.0 - (std::exp(-(-lv - 32.0) / 6.0)));
+                lmInf = lmAlpha / (lmAlpha + lmBeta);
+                lmTau = (1.0 / (lmAlpha + lmBeta)) / lqt;
+                m_ = m_ + (1. - std::exp(dt*(((-1.0)) / lmTau)))*(-(((lmInf)) / lmTau)
+                                                                  / ((((-1.0))) / lmTau) - m_);
+
+                if(lv == -60.0)
+                    lv = lv + 0.0001;
+
+                lhAlpha = (-0.015 * (lv - -60.0)) / (1.0 - (std::exp((lv - -60.0) / 6.0)));
+                lhBeta = (-0.015 * (-lv - 60.0)) / (1.0 - (std::exp((-lv - 60.0) / 6.0)));
+                lhInf = lhAlpha / (lhAlpha + lhBeta);
+                lhTau = (1.0 / (lhAlpha + lhBeta)) / lqt;
+                h_ = h_ + (1. - std::exp(dt*(((-1.0)) / lhTau)))*(-(((lhInf)) / lhTau)
+                                                                  / ((((-1.0))) / lhTau) - h_);
+            }
+        }
+
+        /** the contributions to rhs/d are written in the shadow vectors */
+        template<class Layout>
+        static void current(NrnThread* nt, Mechanism* ml, int begin, int end){
+            Layout const l(ml);
+            double* p = ml->data;
+            int const* ni = ml->nodeindices;
+            int const* ppvar = ml->pdata;
+            double const* vec_v = nt->_actual_v;
+            double* nt_data = nt->_data;
+            double* shadow_rhs = nt->_shadow_rhs;
+            double* shadow_d = nt->_shadow_d;
+
+            for(int i = begin; i < end; ++i){
+                double v = vec_v[ni[i]];
+                double& ena_ = l(p, ena, i);
+                ena_ = nt_data[l.index(ppvar, ion_ena, i)];
+                double m_ = l(p, m, i);
+                double lgNaTs2_t = l(p, gNaTs2_tbar, i) * m_ * m_ * m_ * l(p, h, i);
+                double lina = lgNaTs2_t * (v - ena_);
+                nt_data[l.index(ppvar, ion_dinadv, i)] += lgNaTs2_t;
+                nt_data[l.index(ppvar, ion_ina, i)] += lina;
+                shadow_rhs[i] = lina;
+                shadow_d[i] = lgNaTs2_t;
+            }
+        }
+    };
+
+} // end namespace
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * Neuromapp - ProbAMPANMDA_EMS.hpp, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/kernel/mechanism/template/ProbAMPANMDA_EMS.hpp
+ * \brief Template version of the ProbAMPANMDA_EMS kernels, same arithmetic than ProbAMPANMDA_EMS.c
+ */
+
+#ifndef MAPP_KERNEL_TEMPLATE_PROBAMPANMDA_EMS_
+#define MAPP_KERNEL_TEMPLATE_PROBAMPANMDA_EMS_
+
+#include <cmath>
+
+#include "coreneuron_1.0/kernel/mechanism/template/layout.hpp"
+
+namespace mechanism {
+
+    struct ProbAMPANMDA_EMS {
+        static const int szp = 37;
+        /** index of the variables in the data of the mechanism, only the ones used by the kernels */
+        enum variable { e = 7, mg = 8,
+                        A_AMPA_step = 13, B_AMPA_step = 14, A_NMDA_step = 15, B_NMDA_step = 16,
+                        A_AMPA = 20, B_AMPA = 21, A_NMDA = 22, B_NMDA = 23 };
+        /** index of the area in pdata */
+        enum index { nd_area = 0 };
+
+        template<class Layout>
+        static void state(NrnThread* nt, Mechanism* ml, int begin, int end){
+            Layout const l(ml);
+            double* p = ml->data;
+
+            for(int i = begin; i < end; ++i){
+                l(p, A_AMPA, i) = l(p, A_AMPA, i) * l(p, A_AMPA_step, i);
+                l(p, B_AMPA, i) = l(p, B_AMPA, i) * l(p, B_AMPA_step, i);
+                l(p, A_NMDA, i) = l(p, A_NMDA, i) * l(p, A_NMDA_step, i);
+                l(p, B_NMDA, i) = l(p, B_NMDA, i) * l(p, B_NMDA_step, i);
+            }
+        }
+
+        /** the contributions to rhs/d are written in the shadow vectors, as in the C kernel
+            the conductance is never accumulated */
+        template<class Layout>
+        static void current(NrnThread* nt, Mechanism* ml, int begin, int end){
+            Layout const l(ml);
+            double* p = ml->data;
+            int const* ni = ml->nodeindices;
+            int const* ppvar = ml->pdata;
+            double const* vec_v = nt->_actual_v;
+            double const* nt_data = nt->_data;
+            double* shadow_rhs = nt->_shadow_rhs;
+            double* shadow_d = nt->_shadow_d;
+            const double gmax = 0.001;
+
+            for(int i = begin; i < end; ++i){
+                double mfact = 1.e2/(nt_data[l.index(ppvar, nd_area, i)]);
+                double lvv = vec_v[ni[i]];
+                double lmggate = 1.0 / (1.0 + std::exp(0.062 * -(lvv)) * (l(p, mg, i) / 3.57));
+                double lg_AMPA = gmax * (l(p, B_AMPA, i) - l(p, A_AMPA, i));
+                double lg_NMDA = gmax * (l(p, B_NMDA, i) - l(p, A_NMDA, i)) * lmggate;
+                double lvve = (lvv - l(p, e, i));
+                double li = lg_AMPA * lvve + lg_NMDA * lvve;
+                shadow_rhs[i] = li * mfact;
+                shadow_d[i] = 0.0;
+            }
+        }
+    };
+
+} // end namespace
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * Neuromapp - dispatch.cpp, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/kernel/mechanism/template/dispatch.cpp
+ * \brief Runtime dispatch from the Mechanism metadata to the template kernels
+ */
+
+#include "coreneuron_1.0/kernel/mechanism/mechanism.h"
+#include "coreneuron_1.0/kernel/mechanism/template/layout.hpp"
+#include "coreneuron_1.0/kernel/mechanism/template/NaTs2_t.hpp"
+#include "coreneuron_1.0/kernel/mechanism/template/Ih.hpp"
+#include "coreneuron_1.0/kernel/mechanism/template/ProbAMPANMDA_EMS.hpp"
+
+namespace mechanism {
+
+    /** signature of the C chunk kernels, used when no instantiation matches the metadata */
+    typedef void (*chunk_function)(NrnThread*, Mechanism*, int, int);
+
+    /** kernel of the mechanism M for the layout L */
+    template<class M, class L>
+    struct state_kernel {
+        static void run(NrnThread* nt, Mechanism* ml, int begin, int end){
+            M::template state<L>(nt, ml, begin, end);
+        }
+    };
+
+    template<class M, class L>
+    struct current_kernel {
+        static void run(NrnThread* nt, Mechanism* ml, int begin, int end){
+            M::template current<L>(nt, ml, begin, end);
+        }
+    };
+
+    /** select the instantiation from the layout of ml, the C kernels only know the SoA layout */
+    template<class M, template<class, class> class K>
+    void dispatch(NrnThread* nt, Mechanism* ml, int begin, int end, chunk_function reference){
+        if(ml->szp != M::szp){
+            if(ml->block == 0)
+                reference(nt, ml, begin, end);
+            else
+                K<M, aosoa_dynamic>::run(nt, ml, begin, end);
+            return;
+        }
+
+        switch(ml->block){
+            case 0:
+                K<M, soa<M::szp> >::run(nt, ml, begin, end);
+                break;
+            case 4:
+                K<M, aosoa<4, M::szp> >::run(nt, ml, begin, end);
+                break;
+            case 8:
+                K<M, aosoa<8, M::szp> >::run(nt, ml, begin, end);
+                break;
+            case 16:
+                K<M, aosoa<16, M::szp> >::run(nt, ml, begin, end);
+                break;
+            default:
+                K<M, aosoa_dynamic>::run(nt, ml, begin, end);
+                break;
+        }
+    }
+
+} // end namespace
+
+extern "C" {
+
+void mech_state_NaTs2_t_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end){
+    mechanism::dispatch<mechanism::NaTs2_t, mechanism::state_kernel>(nt, ml, begin, end, mech_state_NaTs2_t_chunk);
+}
+
+void mech_current_NaTs2_t_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end){
+    mechanism::dispatch<mechanism::NaTs2_t, mechanism::current_kernel>(nt, ml, begin, end, mech_current_NaTs2_t_chunk);
+}
+
+void mech_state_Ih_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end){
+    mechanism::dispatch<mechanism::Ih, mechanism::state_kernel>(nt, ml, begin, end, mech_state_Ih_chunk);
+}
+
+void mech_current_Ih_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end){
+    mechanism::dispatch<mechanism::Ih, mechanism::current_kernel>(nt, ml, begin, end, mech_current_Ih_chunk);
+}
+
+void mech_state_ProbAMPANMDA_EMS_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end){
+    mechanism::dispatch<mechanism::ProbAMPANMDA_EMS, mechanism::state_kernel>(nt, ml, begin, end, mech_state_ProbAMPANMDA_EMS_chunk);
+}
+
+void mech_current_ProbAMPANMDA_EMS_template_chunk(NrnThread *nt, Mechanism *ml, int begin, int end){
+    mechanism::dispatch<mechanism::ProbAMPANMDA_EMS, mechanism::current_kernel>(nt, ml, begin, end, mech_current_ProbAMPANMDA_EMS_chunk);
+}
+
+} // extern "C"
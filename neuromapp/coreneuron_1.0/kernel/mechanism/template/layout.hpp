@@ -0,0 +1,103 @@
+/*
+ * Neuromapp - layout.hpp, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/kernel/mechanism/template/layout.hpp
+ * \brief Layout policies of the mechanism data for the template kernels
+ */
+
+#ifndef MAPP_KERNEL_TEMPLATE_LAYOUT_
+#define MAPP_KERNEL_TEMPLATE_LAYOUT_
+
+extern "C" {
+#include "coreneuron_1.0/common/memory/nrnthread.h"
+}
+
+namespace mechanism {
+
+    /** SoA layout, the variables are columns of nodecount doubles (the _STRIDE macro of the
+        C kernels). The number of variables is a template parameter, the kernels are only
+        instantiated for the szp of their mechanism */
+    template<int Szp>
+    class soa {
+    public:
+        static const int szp = Szp;
+
+        explicit soa(Mechanism const* ml):stride_(ml->nodecount){}
+
+        /** variable var of the instance i, var is a constant in the kernels */
+        inline double& operator()(double* p, int var, int i) const {
+            return p[var*stride_ + i];
+        }
+
+        /** ion/area index var of the instance i, pdata is always SoA */
+        inline int index(int const* ppvar, int var, int i) const {
+            return ppvar[var*stride_ + i];
+        }
+
+    private:
+        int stride_;
+    };
+
+    /** AoSoA layout, blocks of Block consecutive instances store the Szp variables one
+        after the other (NRN_AOSOA_INDEX), the block size and the number of variables are
+        known at compile time so the division/modulo are shifts/masks */
+    template<int Block, int Szp>
+    class aosoa {
+    public:
+        static const int szp = Szp;
+        static const int block = Block;
+
+        explicit aosoa(Mechanism const* ml):stride_(ml->nodecount){}
+
+        inline double& operator()(double* p, int var, int i) const {
+            return p[(i/Block)*(Block*Szp) + var*Block + i%Block];
+        }
+
+        inline int index(int const* ppvar, int var, int i) const {
+            return ppvar[var*stride_ + i];
+        }
+
+    private:
+        int stride_;
+    };
+
+    /** AoSoA layout known only at runtime, used when no instantiation matches the metadata */
+    class aosoa_dynamic {
+    public:
+        explicit aosoa_dynamic(Mechanism const* ml):stride_(ml->nodecount),block_(ml->block),szp_(ml->szp){}
+
+        inline double& operator()(double* p, int var, int i) const {
+            return p[NRN_AOSOA_INDEX(var, i, block_, szp_)];
+        }
+
+        inline int index(int const* ppvar, int var, int i) const {
+            return ppvar[var*stride_ + i];
+        }
+
+    private:
+        int stride_;
+        int block_;
+        int szp_;
+    };
+
+} // end namespace
+
+#endif
@@ -24,6 +24,9 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <list>
+#include <map>
+#include <iterator>
 
 #include "utils/error.h"
 
@@ -33,6 +36,7 @@
 #include "coreneuron_1.0/queue/tool/priority_queue.hpp"
 #include "coreneuron_1.0/queue/trait.h"
 #include "coreneuron_1.0/queue/serial_benchmark.h"
+#include "coreneuron_1.0/queue/parallel_benchmark.h"
 
 /** namespace alias for boost::program_options **/
 namespace po = boost::program_options;
@@ -48,8 +52,10 @@ int queue_help(int argc, char* const argv[], po::variables_map& vm){
     po::options_description desc("Allowed options");
     desc.add_options()
     ("help", "produce help message")
-    ("benchmark", po::value<std::string>()->default_value("push"), "push, pop, push_one, mh_bench or all")
+    ("benchmark", po::value<std::string>()->default_value("push"), "push, pop, push_one, mh_bench, all or hold")
     ("size", po::value<int>()->default_value(10), "bench = 2^size")
+    ("threads", po::value<int>()->default_value(1), "hold: number of OpenMP threads, one queue per thread")
+    ("distribution", po::value<std::string>()->default_value("uniform"), "hold: delays uniform, exponential, bounded or bursty")
     ("io", po::value<bool>()->default_value(false), "save $benchmark results IO i.e. pop.csv");
 
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -63,31 +69,97 @@ int queue_help(int argc, char* const argv[], po::variables_map& vm){
     return mapp::MAPP_OK;
 }
 
+/** \fn write_csv(const std::list<std::string>& res, const std::string& name, bool io)
+ \brief print the csv lines on the screen, and in name.csv if io
+ */
+void write_csv(const std::list<std::string>& res, const std::string& name, bool io){
+    std::copy(res.begin(),res.end(), std::ostream_iterator<std::string>(std::cout)); //screen
+    if(io){
+        std::string name_file = name + ".csv";
+        std::ofstream out(name_file.c_str());
+        std::copy(res.begin(),res.end(), std::ostream_iterator<std::string>(out));
+    }
+}
+
+/** header of the csv, the columns of every queue of trait.h */
+const char queue_columns[] = "std::priority_queue,sptq_queue,pooled_sptq_queue,bin_queue,"
+    "boost::binomial_heap,boost::fibonacci_heap,boost::pairing_heap,boost::skew_heap,boost::d_ary_heap";
+
 template<class T>
 void benchmark(int iteration, bool io){
     int size(1);
     std::list<std::string> res;
-    res.push_back("#elements,std::priority_queue,sptq_queue,bin_queue,boost::binomial_heap,boost::fibonacci_heap,boost::skew_heap,boost::pairing_heap \n");
+    res.push_back(std::string("#elements,") + queue_columns + "\n");
 
     for(int i=1; i< iteration; ++i){
         std::string bench = boost::lexical_cast<std::string>(size) + ",";
-        bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<priority_queue> >(size));
+        bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<priority_queue> >(size)) + ",";
         bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<sptq_queue> >(size)) + ",";
+        bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<pooled_sptq_queue> >(size)) + ",";
         bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<bin_queue> >(size)) + ",";
         bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<binomial_heap> >(size)) + ",";
         bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<fibonacci_heap> >(size)) + ",";
+        bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<pairing_heap> >(size)) + ",";
         bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<skew_heap> >(size)) + ",";
         bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<d_ary_heap> >(size)) + "\n";
         res.push_back(bench);
         size<<=1; // 1,2,4,8 ....
     }
 
-    if(io){
-        std::fstream out;
-        std::string name_file = boost::lexical_cast<std::string>(T::name) + ".csv";
-        out.open(name_file.c_str(),std::fstream::out);
-        std::copy(res.begin(),res.end(), std::ostream_iterator<std::string>(std::cout, " ")); //screen
+    write_csv(res, T::name, io);
+}
+
+/** \fn hold(int size, int nthreads, queue::distributions law, std::list<std::string>& histograms)
+ \brief runs the hold model on the queue T, appends the latency histograms of its push and pop
+ \return the cycles of the hold model
+ */
+template<container q>
+std::string hold(int size, int nthreads, queue::distributions law, std::list<std::string>& histograms){
+    queue::latency_histogram push, pop;
+    double time = queue::hold_helper::benchmark<helper_type<q> >(size, nthreads, law, push, pop);
+
+    std::string prefix = boost::lexical_cast<std::string>(size) + "," + helper_type<q>::name;
+    std::string push_line = prefix + ",push," + boost::lexical_cast<std::string>(push.mean());
+    std::string pop_line = prefix + ",pop," + boost::lexical_cast<std::string>(pop.mean());
+    for(int b = 0; b < queue::latency_histogram::nbuckets; ++b){
+        push_line += "," + boost::lexical_cast<std::string>(push[b]);
+        pop_line += "," + boost::lexical_cast<std::string>(pop[b]);
+    }
+    histograms.push_back(push_line + "\n");
+    histograms.push_back(pop_line + "\n");
+    return boost::lexical_cast<std::string>(time);
+}
+
+/** \fn hold_benchmark(int iteration, bool io, int nthreads, queue::distributions law)
+ \brief the hold model for every queue, the cycles in hold.csv and the latency histograms
+ of the operations (bucket b: [2^b, 2^(b+1)) cycles) in hold_histogram.csv
+ */
+void hold_benchmark(int iteration, bool io, int nthreads, queue::distributions law){
+    int size(1);
+    std::list<std::string> res, histograms;
+    res.push_back(std::string("#elements,") + queue_columns + "\n");
+    std::string header("#elements,queue,operation,mean");
+    for(int b = 0; b < queue::latency_histogram::nbuckets; ++b)
+        header += "," + boost::lexical_cast<std::string>(1ULL << b);
+    histograms.push_back(header + "\n");
+
+    for(int i=1; i< iteration; ++i){
+        std::string bench = boost::lexical_cast<std::string>(size) + ",";
+        bench += hold<priority_queue>(size, nthreads, law, histograms) + ",";
+        bench += hold<sptq_queue>(size, nthreads, law, histograms) + ",";
+        bench += hold<pooled_sptq_queue>(size, nthreads, law, histograms) + ",";
+        bench += hold<bin_queue>(size, nthreads, law, histograms) + ",";
+        bench += hold<binomial_heap>(size, nthreads, law, histograms) + ",";
+        bench += hold<fibonacci_heap>(size, nthreads, law, histograms) + ",";
+        bench += hold<pairing_heap>(size, nthreads, law, histograms) + ",";
+        bench += hold<skew_heap>(size, nthreads, law, histograms) + ",";
+        bench += hold<d_ary_heap>(size, nthreads, law, histograms) + "\n";
+        res.push_back(bench);
+        size<<=1; // 1,2,4,8 ....
     }
+
+    write_csv(res, "hold", io);
+    write_csv(histograms, "hold_histogram", io);
 }
 
 
@@ -111,6 +183,20 @@ int queue_content(po::variables_map const& vm){
     m.insert(std::make_pair("push_one",queue::push_one));
     m.insert(std::make_pair("mh_bench",queue::mh_bench));
     m.insert(std::make_pair("all",queue::all));
+    m.insert(std::make_pair("hold",queue::hold));
+
+    int nthreads = vm["threads"].as<int>();
+    if(nthreads < 1)
+        return mapp::MAPP_BAD_ARG;
+
+    std::map<std::string,queue::distributions> d;
+    d.insert(std::make_pair("uniform",queue::uniform));
+    d.insert(std::make_pair("exponential",queue::exponential));
+    d.insert(std::make_pair("bounded",queue::bounded));
+    d.insert(std::make_pair("bursty",queue::bursty));
+    queue::distributions law = d[vm["distribution"].as<std::string>()];
+    if(!law)
+        return mapp::MAPP_BAD_ARG;
 
     switch(m[bench]){
         case queue::push :
@@ -131,6 +217,9 @@ int queue_content(po::variables_map const& vm){
             benchmark<queue::push_one_helper>(iteration,io);
             benchmark<queue::mhines_bench_helper>(iteration,io);
             break;
+        case queue::hold :
+            hold_benchmark(iteration,io,nthreads,law);
+            break;
         default:
             return mapp::MAPP_BAD_ARG;
     }
@@ -0,0 +1,224 @@
+/*
+ * Neuromapp - parallel_benchmark.h, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/queue/parallel_benchmark.h
+ * \brief multi-threaded hold model benchmark of the queues
+ */
+
+#ifndef parallel_benchmark_h
+#define parallel_benchmark_h
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/exponential_distribution.hpp>
+
+#include <vector>
+#include <algorithm>
+
+#include "coreneuron_1.0/queue/timer_asm.h"
+#include "utils/omp/compatibility.h"
+
+namespace queue{
+
+    enum distributions {uniform=1,exponential,bounded,bursty}; // for the main and switch
+
+    /** \class delay_generator
+     *  \brief draws the delay between the delivery of an event and the time of the event it
+     *  generates:
+     *  - uniform: [0,1), the draws of the serial benchmarks
+     *  - exponential: exponential inter-arrival, mean 1 (Poisson process)
+     *  - bounded: [min_delay, max_delay), the synaptic delays of a network
+     *  - bursty: exponential, but with the probability burst_probability the delay is shared
+     *    by burst_size consecutive events (a cell with a large fan-out spiking)
+     */
+    class delay_generator{
+    public:
+        explicit delay_generator(distributions law = uniform, unsigned int seed = 1,
+                                 double min_delay = 1.0, double max_delay = 5.0,
+                                 double burst_probability = 0.01, int burst_size = 64)
+        :law_(law),generator_(seed),min_delay_(min_delay),max_delay_(max_delay),
+         burst_probability_(burst_probability),burst_size_(burst_size),burst_(0),last_(0.){}
+
+        double operator()(){
+            switch(law_){
+                case exponential :
+                    return exponential_(generator_);
+                case bounded :
+                    return min_delay_ + (max_delay_ - min_delay_)*uniform_(generator_);
+                case bursty :
+                    if(burst_ > 0){
+                        --burst_;
+                        return last_;
+                    }
+                    if(uniform_(generator_) < burst_probability_)
+                        burst_ = burst_size_ - 1;
+                    last_ = exponential_(generator_);
+                    return last_;
+                default :
+                    return uniform_(generator_);
+            }
+        }
+
+    private:
+        distributions law_;
+        boost::random::mt19937 generator_;
+        boost::random::uniform_real_distribution<double> uniform_;
+        boost::random::exponential_distribution<double> exponential_;
+        double min_delay_;
+        double max_delay_;
+        double burst_probability_;
+        int burst_size_;
+        int burst_;
+        double last_;
+    };
+
+    /** \class latency_histogram
+     *  \brief histogram of the cycles of single operations, the bucket b counts the
+     *  operations of [2^b, 2^(b+1)) cycles (the rdtsc overhead included)
+     */
+    class latency_histogram{
+    public:
+        static const int nbuckets = 32;
+
+        latency_histogram():counts_(nbuckets,0),total_(0),cycles_(0){}
+
+        inline void add(unsigned long long int cycles){
+            int b = 0;
+            while(b < nbuckets-1 && (cycles >> (b+1)))
+                ++b;
+            ++counts_[b];
+            ++total_;
+            cycles_ += cycles;
+        }
+
+        void merge(const latency_histogram& h){
+            for(int b = 0; b < nbuckets; ++b)
+                counts_[b] += h.counts_[b];
+            total_ += h.total_;
+            cycles_ += h.cycles_;
+        }
+
+        /** number of operations of the bucket b */
+        unsigned long long int operator[](int b) const{
+            return counts_[b];
+        }
+
+        /** number of operations */
+        unsigned long long int count() const{
+            return total_;
+        }
+
+        /** mean cycles per operation */
+        double mean() const{
+            return (total_ == 0) ? 0. : cycles_/static_cast<double>(total_);
+        }
+
+        /** upper bound (cycles) of the bucket holding the fraction p of the operations */
+        unsigned long long int percentile(double p) const{
+            unsigned long long int sum(0);
+            for(int b = 0; b < nbuckets; ++b){
+                sum += counts_[b];
+                if(sum > 0 && sum >= p*total_)
+                    return 2ULL << b;
+            }
+            return 0;
+        }
+
+    private:
+        std::vector<unsigned long long int> counts_;
+        unsigned long long int total_;
+        unsigned long long int cycles_;
+    };
+
+    /** \struct hold_helper
+     *  \brief hold model: every thread owns a queue of size events. Every step dt, a thread
+     *  pops the events due and sends, for each of them, a new event (its time plus a delay)
+     *  to a random thread. After a barrier, the threads push the events received. The number
+     *  of events is constant, the queues are in their steady state.
+     */
+    struct hold_helper{
+        template<class T>
+        static double benchmark(int size, int nthreads, distributions law,
+                                latency_histogram& push_histogram, latency_histogram& pop_histogram){
+            typedef typename T::value_type value_type;
+            const double dt = 0.025;
+            const int nsteps = 400;
+
+            // outboxes[s*nthreads + d] the events from the thread s to the thread d
+            std::vector<std::vector<double> > outboxes(nthreads*nthreads);
+            std::vector<latency_histogram> pushes(nthreads), pops(nthreads);
+            std::vector<unsigned long long int> times(nthreads,0);
+
+            #pragma omp parallel num_threads(nthreads)
+            {
+                const int id = omp_get_thread_num();
+                const int n = omp_get_num_threads();
+                delay_generator delay(law, id+1);
+                boost::random::mt19937 generator(id+1);
+                boost::random::uniform_int_distribution<int> target(0, n-1);
+                value_type queue;
+
+                for(int i = 0; i < size; ++i)
+                    queue.push(delay());
+
+                #pragma omp barrier
+                unsigned long long int t1(rdtsc()),c(0);
+
+                for(int step = 1; step <= nsteps; ++step){
+                    const double t = step*dt;
+                    for(;;){
+                        c = rdtsc();
+                        if(queue.empty() || queue.top() > t)
+                            break;
+                        const double e = queue.top();
+                        queue.pop();
+                        pops[id].add(rdtsc() - c);
+                        outboxes[id*nthreads + target(generator)].push_back(e + delay());
+                    }
+
+                    #pragma omp barrier
+                    for(int s = 0; s < n; ++s){
+                        std::vector<double>& in = outboxes[s*nthreads + id];
+                        for(std::vector<double>::iterator it = in.begin(); it != in.end(); ++it){
+                            c = rdtsc();
+                            queue.push(*it);
+                            pushes[id].add(rdtsc() - c);
+                        }
+                        in.clear();
+                    }
+                    #pragma omp barrier
+                }
+
+                times[id] = rdtsc() - t1;
+            }
+
+            for(int i = 0; i < nthreads; ++i){
+                push_histogram.merge(pushes[i]);
+                pop_histogram.merge(pops[i]);
+            }
+            return *std::max_element(times.begin(), times.end());
+        }
+    };
+
+} //end namespace
+
+#endif /* parallel_benchmark_h */
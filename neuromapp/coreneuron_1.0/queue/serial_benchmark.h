@@ -12,12 +12,39 @@
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_real_distribution.hpp>
 
+#include <vector>
+
 #include "coreneuron_1.0/queue/timer_asm.h"
+#include "coreneuron_1.0/queue/tool/sptq_queue.hpp"
 
 
 namespace queue{
 
-    enum benchs {push=1,pop,push_one,mh_bench,all}; // for the main and switch
+    /** push the values of [first, last), a loop of push for the queues without batch */
+    template<class Q, class Iterator>
+    inline void push_range(Q& queue, Iterator first, Iterator last){
+        for(; first != last; ++first)
+            queue.push(*first);
+    }
+
+    template<class T, class Compare, class Allocator, class Iterator>
+    inline void push_range(tool::sptq_queue<T,Compare,Allocator>& queue, Iterator first, Iterator last){
+        queue.push_range(first, last);
+    }
+
+    /** pop the values up to t included, a loop of top/pop for the queues without batch */
+    template<class Q>
+    inline void pop_until(Q& queue, double t){
+        while(!queue.empty() && queue.top() <= t)
+            queue.pop();
+    }
+
+    template<class T, class Compare, class Allocator>
+    inline void pop_until(tool::sptq_queue<T,Compare,Allocator>& queue, double t){
+        queue.pop_until(t);
+    }
+
+    enum benchs {push=1,pop,push_one,mh_bench,all,hold}; // for the main and switch
 
     struct push_helper{
         template<class T>
@@ -116,16 +143,17 @@ namespace queue{
             const double dt = 0.025;
             const double max_time = 50.0;
 
+            std::vector<double> values(size);
             for(int j=0; j<repetition; ++j){
                 value_type queue;
                 t1 = rdtsc();
 
                 for(double t=0.0; t < max_time; t += dt){
                     for(int i = 0; i < size ; ++i)
-                        queue.push((t + distribution(generator)));
-
-                    while (queue.top() <= t)
-                        queue.pop();
+                        values[i] = t + distribution(generator);
+                    // batched for the sptq queues
+                    push_range(queue, values.begin(), values.end());
+                    pop_until(queue, t);
 
                     t += dt;
                 }
@@ -2,10 +2,21 @@
 #ifndef bin_queue_hpp_
 #define bin_queue_hpp_
 
+#include <vector>
+#include <cassert>
+#include <cstddef>
+
 #include "coreneuron_1.0/queue/tool/bin_queue.hpp"
 
 namespace tool {
 
+    /** time of an element, the key of the "hash function". Overload it in the namespace of
+        a structured element (found by ADL) */
+    template<class T>
+    inline double time_of(const T& t){
+        return t;
+    }
+
 /** the bin queue is a a kind of priority_queue using a ring concept, elements are sorted through
     bin from smallest to largest, into a bin there is NO specific order*. The determination
     of the bin is choosen by a kind of hash function (the hash give the bin "bucket").
@@ -34,7 +45,7 @@ namespace tool {
         typedef std::size_t size_type;
         typedef bin_node<value_type> node_type;
 
-        inline explicit bin_queue(double dt = 0.025, value_type t0 = 0.):size_(0),qpt_(0),dt_(dt),tt_(t0)
+        inline explicit bin_queue(double dt = 0.025, double t0 = 0.):size_(0),qpt_(0),dt_(dt),tt_(t0)
                                                                              ,bins_(1024){}
 
         ~bin_queue();
@@ -69,11 +80,11 @@ namespace tool {
             return r;
         }
 
-        inline size_type size(){
+        inline size_type size() const{
             return size_;
         }
 
-        inline bool empty(){
+        inline bool empty() const{
             return !bool(size_); // is it true on Power?
         }
         
@@ -83,6 +94,29 @@ namespace tool {
             return n;
         }
 
+        /** detach the whole first non empty bin, the nodes are chained by their left_ link
+            (no specific order) and belong to the caller, 0 if the queue is empty */
+        inline node_type* pop_bin(){
+            node_type* q = first();
+            if(q){
+                bins_[q->cnt_] = 0;
+                for(node_type* n = q; n; n = n->left_)
+                    size_--;
+            }
+            return q;
+        }
+
+        /** move the origin tt_ to the bin of t, or to the first non empty bin if it is
+            before: the bins before it are dropped, an element pushed before the origin
+            afterwards goes in the first bin. The nodes are renumbered, so the bins are only
+            shifted when the origin moves by half of them, the vector keeps the size of the
+            pending span */
+        inline void advance(double t);
+
+        inline size_type nbins() const{
+            return bins_.size();
+        }
+
     private:
         /** original API */
         inline void enqueue(value_type tt, tool::bin_node<value_type>*);
@@ -93,9 +127,9 @@ namespace tool {
         void remove(node_type*);
     
         size_type size_;
-        int qpt_; // unused here
+        int qpt_; // first non empty bin, a lower bound
         double dt_; // step times
-        value_type tt_; // time at beginning of qpt_ interval
+        double tt_; // time at beginning of qpt_ interval
         std::vector<node_type*> bins_; // for correct resize
     };
 }
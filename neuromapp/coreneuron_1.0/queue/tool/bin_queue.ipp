@@ -20,10 +20,11 @@ namespace tool{
     void bin_queue<T>::enqueue(T td, node_type* q) {
 
         int rev_dt = 1/dt_;
-        int idt = (int)((td - tt_)*rev_dt + 1.e-10);
+        int idt = (int)((time_of(td) - tt_)*rev_dt + 1.e-10);
+        if(idt < 0)
+            idt = 0; // before the origin, see advance
         if(idt >= bins_.size())
             bins_.resize(idt<<1); //double the size
-        assert(idt >= 0);
         if(idt < qpt_)
             qpt_ = idt; // keep track of the first bin
         q->cnt_ = idt; // only for iteration
@@ -31,6 +32,24 @@ namespace tool{
         bins_[idt] = q;
     }
 
+    template<class T>
+    void bin_queue<T>::advance(double t) {
+        int rev_dt = 1/dt_;
+        int shift = (int)((t - tt_)*rev_dt + 1.e-10);
+        node_type* q = first();
+        if(q && q->cnt_ < shift)
+            shift = q->cnt_;
+        if(2*shift < (int)bins_.size())
+            return;
+        bins_.erase(bins_.begin(), bins_.begin() + shift);
+        bins_.resize(bins_.size() + shift);
+        for (int i = 0; i < bins_.size(); ++i)
+            for (node_type* n = bins_[i]; n; n = n->left_)
+                n->cnt_ = i;
+        tt_ += (double)shift/rev_dt;
+        qpt_ = (qpt_ > shift) ? qpt_ - shift : 0;
+    }
+
     template<class T>
     typename bin_queue<T>::node_type* bin_queue<T>::first() {
         for (int i = qpt_; i < bins_.size(); ++i) {
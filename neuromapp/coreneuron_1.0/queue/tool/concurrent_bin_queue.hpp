@@ -0,0 +1,239 @@
+
+#ifndef concurrent_bin_queue_hpp_
+#define concurrent_bin_queue_hpp_
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+#include "coreneuron_1.0/queue/tool/bin_queue.hpp" // time_of
+
+namespace tool {
+
+/** the concurrent bin queue is the ring of bins of the bin_queue for the events bounded in the
+    future: any thread may push, a single owner pops. The bin of an event is its step
+    (time - t0)/dt, modulo the number of bins, every bin knows the step it holds.
+
+    - push (any thread): locks the bin of the step (a spin lock per bin, one cache line per
+      bin, the ring is aligned on a cache line), links the node if the bin holds its step.
+      A late event (its bin is already drained) goes to the late list, an event beyond the
+      ring to the overflow list.
+
+    - pop_until (owner): the late events in time order, then the bins of the steps up to
+      til whole, each bin now holds its step + nbins, then the events linked late meanwhile.
+      The overflow is put back in the ring every turn of the ring.
+
+    An event pushed during a pop_until may wait the next one, like the inbox of the event
+    passing. Into a bin there is NO specific order, the times are exact for times multiple
+    of dt. nbins*dt should cover the maximum delay, the overflow is walked at every turn.
+ */
+    template<class T>
+    class concurrent_bin_queue {
+    public:
+        typedef T value_type;
+        typedef std::size_t size_type;
+
+        inline explicit concurrent_bin_queue(double dt = 0.025, int nbins = 1024, double t0 = 0.)
+        :dt_(dt),t0_(t0),current_(0),size_(0),nbins_(nbins),bins_(0){
+            init();
+        }
+
+        /** the events are not copied, the copy is an empty queue with the same ring */
+        inline concurrent_bin_queue(const concurrent_bin_queue& other)
+        :dt_(other.dt_),t0_(other.t0_),current_(0),size_(0),nbins_(other.nbins_),bins_(0){
+            init();
+        }
+
+        /** the events are not copied, the queue keeps its own events */
+        inline concurrent_bin_queue& operator=(const concurrent_bin_queue&){
+            return *this;
+        }
+
+        ~concurrent_bin_queue(){
+            for(int i = 0; i < nbins_; ++i)
+                clear(bins_[i].head_);
+            clear(late_.head_);
+            clear(overflow_.head_);
+        }
+
+        /** adds an element, may be called concurrently by any number of threads */
+        inline void push(const value_type& t){
+            node_type* n = new node_type;
+            n->t_ = t;
+            __sync_fetch_and_add(&size_, 1);
+            link(n, step_of(time_of(t)));
+        }
+
+        /** moves the elements of the steps up to til to out, owner only. The times must not
+            decrease from one call to the other */
+        template<class OutputIterator>
+        size_type pop_until(double til, OutputIterator out){
+            const long last = step_of(til);
+
+            // the late events are older than the bins
+            size_type count = pop_late(out);
+
+            node_type* n;
+            for(; current_ <= last; ++current_){
+                if(current_ % nbins_ == 0)
+                    redistribute();
+                bin& b = bins_[current_ % nbins_];
+                lock(b);
+                n = b.head_;
+                b.head_ = 0;
+                b.step_ = current_ + nbins_;
+                unlock(b);
+                while(n){
+                    node_type* next = n->next_;
+                    *out++ = n->t_;
+                    delete n;
+                    ++count;
+                    n = next;
+                }
+            }
+
+            // the events linked late during the drain (redistributed or pushed), all due
+            count += pop_late(out);
+
+            __sync_fetch_and_sub(&size_, count);
+            return count;
+        }
+
+        /** number of elements, exact when no push is in progress */
+        inline size_type size() const{
+            return size_;
+        }
+
+        inline bool empty() const{
+            return size_ == 0;
+        }
+
+        inline size_type nbins() const{
+            return nbins_;
+        }
+
+    private:
+        struct node_type {
+            value_type t_;
+            node_type* next_;
+        };
+
+        struct bin {
+            bin():head_(0),step_(0),lock_(0){}
+            node_type* head_;
+            long step_; // the step of the events of head_
+            volatile int lock_;
+            char pad_[64 - sizeof(node_type*) - sizeof(long) - sizeof(int)]; // one cache line
+        };
+
+        inline void init(){
+            assert(nbins_ > 0);
+            assert(sizeof(bin) == 64);
+            // one more bin to align the ring on a cache line
+            storage_.resize((nbins_ + 1)*sizeof(bin));
+            const std::size_t offset = reinterpret_cast<std::size_t>(&storage_[0]) % sizeof(bin);
+            bins_ = reinterpret_cast<bin*>(&storage_[0] + (offset == 0 ? 0 : sizeof(bin) - offset));
+            for(int i = 0; i < nbins_; ++i){
+                new(&bins_[i]) bin();
+                bins_[i].step_ = i;
+            }
+        }
+
+        inline long step_of(double time) const{
+            const long s = static_cast<long>((time - t0_)/dt_ + 1.e-10);
+            return (s < 0) ? 0 : s;
+        }
+
+        static bool earlier(const node_type* a, const node_type* b){
+            return time_of(a->t_) < time_of(b->t_);
+        }
+
+        static inline void lock(bin& b){
+            while(__sync_lock_test_and_set(&b.lock_, 1))
+                while(b.lock_)
+                    ;
+        }
+
+        static inline void unlock(bin& b){
+            __sync_lock_release(&b.lock_);
+        }
+
+        /** links n in the bin of the step s, the late or the overflow list */
+        inline void link(node_type* n, long s){
+            bin& b = bins_[s % nbins_];
+            lock(b);
+            if(s == b.step_){
+                n->next_ = b.head_;
+                b.head_ = n;
+                unlock(b);
+                return;
+            }
+            const bool late = s < b.step_;
+            unlock(b);
+            bin& l = late ? late_ : overflow_;
+            lock(l);
+            n->next_ = l.head_;
+            l.head_ = n;
+            unlock(l);
+        }
+
+        /** detaches the list of b */
+        static inline node_type* take(bin& b){
+            lock(b);
+            node_type* n = b.head_;
+            b.head_ = 0;
+            unlock(b);
+            return n;
+        }
+
+        /** moves the late events to out in time order, returns their number */
+        template<class OutputIterator>
+        size_type pop_late(OutputIterator& out){
+            node_type* n = take(late_);
+            if(!n)
+                return 0;
+            late_nodes_.clear();
+            for(; n; n = n->next_)
+                late_nodes_.push_back(n);
+            std::sort(late_nodes_.begin(), late_nodes_.end(), earlier);
+            for(size_type i = 0; i < late_nodes_.size(); ++i){
+                *out++ = late_nodes_[i]->t_;
+                delete late_nodes_[i];
+            }
+            return late_nodes_.size();
+        }
+
+        /** puts the overflow back in the ring, or in the overflow if still too far */
+        void redistribute(){
+            node_type* n = take(overflow_);
+            while(n){
+                node_type* next = n->next_;
+                link(n, step_of(time_of(n->t_)));
+                n = next;
+            }
+        }
+
+        static void clear(node_type* n){
+            while(n){
+                node_type* next = n->next_;
+                delete n;
+                n = next;
+            }
+        }
+
+        double dt_; // step times
+        double t0_; // time of the step 0
+        long current_; // the first step not popped, owner only
+        size_type size_;
+        size_type nbins_;
+        std::vector<char> storage_; // the ring, and the bytes to align it
+        bin* bins_; // in storage_, aligned on a cache line
+        bin late_;
+        bin overflow_;
+        std::vector<node_type*> late_nodes_; // buffer of pop_until
+    };
+}
+
+#endif
@@ -34,6 +34,8 @@ THE POSSIBILITY OF SUCH DAMAGE.
 #include <cstring>
 #include <ostream>
 #include <functional>
+#include <vector>
+#include <new>
 
 #include "coreneuron_1.0/queue/tool/algorithm.h"
 
@@ -80,13 +82,79 @@ sptq_node<T>* sphead(SPTREE<T>*);
 template<class T>
 void spdelete(sptq_node<T>*,SPTREE<T>*);
 
-template<class T = double, class Compare = std::less<T> >
+/** node allocator of the original version, new and delete for every node */
+template<class T>
+struct sptq_heap_allocator {
+    typedef sptq_node<T> node_type;
+
+    inline node_type* allocate(const T& value){
+        return new node_type(value);
+    }
+
+    inline void deallocate(node_type* n){
+        delete n;
+    }
+};
+
+/** slab node allocator: the nodes are carved in slabs of SlabSize nodes, the released
+    nodes are kept in a free list (through parent_) and reused first. The slabs are only
+    freed with the allocator, the nodes stay close in memory and there is no malloc
+    in the steady state of a queue. */
+template<class T, std::size_t SlabSize = 1024>
+class sptq_pool_allocator {
+public:
+    typedef sptq_node<T> node_type;
+
+    sptq_pool_allocator():free_(NULL),next_(SlabSize) {}
+
+    /** the slabs are not shared, the copy is an empty allocator */
+    sptq_pool_allocator(const sptq_pool_allocator&):free_(NULL),next_(SlabSize) {}
+
+    /** the slabs are not shared, the allocator keeps its own nodes */
+    sptq_pool_allocator& operator=(const sptq_pool_allocator&) {return *this;}
+
+    ~sptq_pool_allocator(){
+        for(std::size_t i = 0; i < slabs_.size(); ++i)
+            delete [] slabs_[i];
+    }
+
+    inline node_type* allocate(const T& value){
+        node_type* n;
+        if(free_ != NULL){
+            n = free_;
+            free_ = n->parent_;
+        }
+        else{
+            if(next_ == SlabSize){
+                slabs_.push_back(new node_type[SlabSize]);
+                next_ = 0;
+            }
+            n = &slabs_.back()[next_++];
+        }
+        return new(n) node_type(value);
+    }
+
+    inline void deallocate(node_type* n){
+        n->parent_ = free_;
+        free_ = n;
+    }
+
+private:
+    std::vector<node_type*> slabs_;
+    node_type* free_;
+    std::size_t next_;
+};
+
+/** the splay tree queue, the nodes come from Allocator: sptq_heap_allocator (new/delete,
+    the default) or sptq_pool_allocator */
+template<class T = double, class Compare = std::less<T>, class Allocator = sptq_heap_allocator<T> >
 class sptq_queue {
 public:
     typedef SPTREE<T> container;
     typedef std::size_t size_type;
     typedef T value_type;
     typedef sptq_node<T> node_type;
+    typedef Allocator allocator_type;
 
     inline sptq_queue():size_(0) {
         spinit(&q);
@@ -95,15 +163,24 @@ public:
     inline ~sptq_queue(){
         node_type *n;
         while((n = spdeq(&(&q)->root)) != NULL)
-          delete n;
+          alloc_.deallocate(n);
     }
 
     inline void push(value_type value){
-        node_type *n = new node_type(value);
+        node_type *n = alloc_.allocate(value);
         spenq<T,Compare>(n, &q); // the Comparator is use only here
         size_++;
     }
 
+    /** push every value of [first, last) */
+    template<class InputIterator>
+    inline void push_range(InputIterator first, InputIterator last){
+        for(; first != last; ++first){
+            spenq<T,Compare>(alloc_.allocate(*first), &q);
+            size_++;
+        }
+    }
+
     inline void push(node_type* n){
         spenq<T,Compare>(n, &q);
         size_++;
@@ -112,11 +189,37 @@ public:
     inline void pop(){
         if(!empty()){
             node_type *n = spdeq(&(&q)->root);
-            delete n; // pop remove definitively the element else memory leak
+            alloc_.deallocate(n); // pop remove definitively the element else memory leak
             size_--;
         }
     }
 
+    /** pop the elements up to limit included (not Compare(top, limit)), in the order of the
+        queue, and write them to out. The head splayed by sphead is the root without left
+        child, it is unlinked directly, no second descent as with top() and pop() */
+    template<class OutputIterator>
+    inline size_type pop_until(const value_type& limit, OutputIterator out){
+        size_type n = 0;
+        while(!empty()){
+            node_type *head = sphead<T>(&q);
+            if(Compare()(head->t_, limit))
+                break;
+            *out++ = head->t_;
+            q.root = head->right_;
+            if(q.root != NULL)
+                q.root->parent_ = NULL;
+            alloc_.deallocate(head);
+            size_--;
+            ++n;
+        }
+        return n;
+    }
+
+    /** pop the elements up to limit included, see pop_until(limit, out) */
+    inline size_type pop_until(const value_type& limit){
+        return pop_until(limit, discard_iterator());
+    }
+
     inline value_type top(){
         value_type tmp = value_type();
         if(!empty())
@@ -124,11 +227,11 @@ public:
         return tmp;
     }
 
-    inline size_type size(){
+    inline size_type size() const{
         return size_;
     }
 
-    inline bool empty(){
+    inline bool empty() const{
         return !bool(size_); // is it true on Power?
     }
 
@@ -146,13 +249,21 @@ public:
     }
 
 private:
+    /** output iterator dropping the values */
+    struct discard_iterator {
+        discard_iterator& operator*() {return *this;}
+        discard_iterator& operator++(int) {return *this;}
+        discard_iterator& operator=(const value_type&) {return *this;}
+    };
+
     size_type size_;
     container q;
+    allocator_type alloc_;
 };
 
 // carefull the << delete the queue only for debugging 
-template<class T, class Compare>
-std::ostream& operator<< (std::ostream& os, sptq_queue<T,Compare>& q ){
+template<class T, class Compare, class Allocator>
+std::ostream& operator<< (std::ostream& os, sptq_queue<T,Compare,Allocator>& q ){
     q.print(os);
     return os;
 }
@@ -19,7 +19,7 @@
 #include "coreneuron_1.0/queue/tool/priority_queue.hpp" // MH work
 
 enum container {sptq_queue, bin_queue, priority_queue,binomial_heap,
-                fibonacci_heap,pairing_heap,skew_heap,d_ary_heap};
+                fibonacci_heap,pairing_heap,skew_heap,d_ary_heap,pooled_sptq_queue};
 //serial queue
 template<container q>
 struct helper_type;
@@ -36,6 +36,12 @@ struct helper_type<sptq_queue>{
     const static char name[];
 };
 
+template<>
+struct helper_type<pooled_sptq_queue>{ // the nodes in slabs, see tool::sptq_pool_allocator
+    typedef tool::sptq_queue<double, std::greater<double>, tool::sptq_pool_allocator<double> > value_type;
+    const static char name[];
+};
+
 template<>
 struct helper_type<bin_queue>{ // no comparator great by default
     typedef tool::bin_queue<double> value_type;
@@ -75,6 +81,7 @@ struct helper_type<d_ary_heap>{
 //because no c++11
 const char helper_type<priority_queue>::name[] = "std::priority_queue";
 const char helper_type<sptq_queue>::name[] = "original_sptq_queue";
+const char helper_type<pooled_sptq_queue>::name[] = "pooled_sptq_queue";
 const char helper_type<bin_queue>::name[] = "original_bin_queue";
 const char helper_type<binomial_heap>::name[] = "boost::binomial_heap";
 const char helper_type<fibonacci_heap>::name[] = "boost::fibonacci_heap";
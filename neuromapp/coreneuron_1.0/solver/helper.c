@@ -34,12 +34,16 @@
 #include <unistd.h>
 
 #include "coreneuron_1.0/solver/helper.h"
+#include "coreneuron_1.0/common/memory/permute.h"
 #include "utils/error.h"
 int solver_print_usage() {
-    printf("usage: solver --data [string] --name [string]\n");
+    printf("usage: solver --data [string] --name [string] --permute [string] --cells --numthread [int]\n");
     printf("details: \n");
     printf("                 --data [path to the input] \n");
     printf("                 --name [to internally reference the data, default name coreneuron_1.0_solver_data] \n");
+    printf("                 --permute [none, cell, interleave or lane, renumbering of the compartments, default none] \n");
+    printf("                 --cells [solve the cells independently, groups of cells on the SIMD lanes and the OMP threads] \n");
+    printf("                 --numthread [number of OMP threads with --cells, default 1] \n");
     return MAPP_USAGE;
 }
 
@@ -49,6 +53,9 @@ int solver_help(int argc, char* const argv[], struct input_parameters * p)
 
   p->d = "";
   p->name = "coreneuron_1.0_solver_data";
+  p->permute = NRN_PERMUTE_NONE;
+  p->cells = 0;
+  p->th = 1;
 
   optind = 0;
 
@@ -59,11 +66,14 @@ int solver_help(int argc, char* const argv[], struct input_parameters * p)
           {"help", no_argument, NULL, 'h'},
           {"data", required_argument,     NULL, 'd'},
           {"name", required_argument,     NULL, 'n'},
+          {"permute", required_argument,  NULL, 'r'},
+          {"cells", no_argument,          NULL, 'c'},
+          {"numthread", required_argument, NULL, 't'},
           {NULL, 0, NULL, 0}
       };
       /* getopt_long stores the option index here. */
       int option_index = 0;
-      c = getopt_long (argc, argv, "d:n:",
+      c = getopt_long (argc, argv, "d:n:r:ct:",
                        long_options, &option_index);
       /* Detect the end of the options. */
       if (c == -1)
@@ -78,6 +88,19 @@ int solver_help(int argc, char* const argv[], struct input_parameters * p)
               break;
           case 'n': p->name = optarg;
               break;
+          case 'r':
+              p->permute = nrnthread_permute_kind(optarg);
+              if(p->permute < 0)
+                  return MAPP_BAD_ARG;
+              break;
+          case 'c':
+              p->cells = 1;
+              break;
+          case 't':
+              p->th = atoi(optarg);
+              if(p->th < 1)
+                  return MAPP_BAD_ARG;
+              break;
           case 'h':
               return solver_print_usage();
               break;
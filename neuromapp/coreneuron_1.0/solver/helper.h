@@ -38,6 +38,18 @@ struct input_parameters{
     char * d;
     /** key for the storage */
     char * name;
+    /** renumbering of the compartments (nrn_permutation)
+     \warning The default value is NRN_PERMUTE_NONE, the original numbering
+     */
+    int permute;
+    /** solve the cells independently, see nrn_solve_cells
+     \warning The default value is 0, the cells are solved in a single loop
+     */
+    int cells;
+    /** number of OMP thread for --cells
+     \warning The default value is 1 OMP thread
+     */
+    int th;
 };
 
 /** \fn cstep_print_usage()
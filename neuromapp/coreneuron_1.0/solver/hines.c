@@ -26,9 +26,13 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include "coreneuron_1.0/solver/hines.h"
+#include "coreneuron_1.0/common/memory/permute.h"
+#include "utils/error.h"
 
 #define VEC_A(i) (_nt->_actual_a[(i)])
 #define VEC_B(i) (_nt->_actual_b[(i)])
@@ -71,6 +75,105 @@ void bksub(NrnThread* _nt) {
 	}
 }
 
+int nrn_schedule_build(const NrnThread* _nt, int width, HinesSchedule* s) {
+	int i, c, g, j, r;
+	int *cell, *order, *first, *pos, *nodes;
+
+	if (width < 1)
+		return MAPP_BAD_ARG;
+
+	cell = (int*)malloc(sizeof(int) * _nt->end);
+	order = (int*)malloc(sizeof(int) * _nt->ncell);
+	first = (int*)calloc(_nt->ncell + 1, sizeof(int));
+	pos = (int*)malloc(sizeof(int) * _nt->ncell);
+	nodes = (int*)malloc(sizeof(int) * _nt->end);
+
+	nrnthread_cells(_nt, cell, order);
+
+	/* compartments of every cell in increasing index, the root first */
+	for (i = 0; i < _nt->end; ++i)
+		first[cell[i]+1]++;
+	for (c = 0; c < _nt->ncell; ++c)
+		first[c+1] += first[c];
+	memcpy(pos, first, sizeof(int) * _nt->ncell);
+	for (i = 0; i < _nt->end; ++i)
+		nodes[pos[cell[i]]++] = i;
+
+	/* the first cell of a group is the largest one */
+	s->width = width;
+	s->ngroup = (_nt->ncell + width - 1) / width;
+	s->offset = (int*)malloc(sizeof(int) * (s->ngroup + 1));
+	s->offset[0] = 0;
+	for (g = 0; g < s->ngroup; ++g)
+		s->offset[g+1] = s->offset[g] + first[order[g*width]+1] - first[order[g*width]];
+
+	s->index = (int*)malloc(sizeof(int) * s->offset[s->ngroup] * width);
+	for (i = 0; i < s->offset[s->ngroup] * width; ++i)
+		s->index[i] = -1;
+	for (g = 0; g < s->ngroup; ++g)
+		for (j = 0; j < width && g*width + j < _nt->ncell; ++j) {
+			c = order[g*width + j];
+			for (r = 0; r < first[c+1] - first[c]; ++r)
+				s->index[(s->offset[g] + r)*width + j] = nodes[first[c] + r];
+		}
+
+	free(nodes);
+	free(pos);
+	free(first);
+	free(order);
+	free(cell);
+	return MAPP_OK;
+}
+
+void nrn_schedule_free(HinesSchedule* s) {
+	free(s->offset);
+	s->offset = NULL;
+	free(s->index);
+	s->index = NULL;
+	s->ngroup = 0;
+}
+
+void nrn_solve_cells(NrnThread* _nt, const HinesSchedule* s) {
+	int g;
+	#pragma omp parallel for schedule(dynamic)
+	for (g = 0; g < s->ngroup; ++g) {
+		int r, j, w = s->width;
+		const int *row;
+		const int *parent = _nt->_v_parent_index;
+
+		/* triangularization, the lanes are different cells, no conflict on the parents */
+		for (r = s->offset[g+1] - 1; r > s->offset[g]; --r) {
+			row = s->index + r*w;
+			#pragma omp simd
+			for (j = 0; j < w; ++j) {
+				int i = row[j];
+				if (i >= 0) {
+					double p = VEC_A(i) / VEC_D(i);
+					VEC_D(parent[i]) -= p * VEC_B(i);
+					VEC_RHS(parent[i]) -= p * VEC_RHS(i);
+				}
+			}
+		}
+
+		/* back substitution, the roots first */
+		row = s->index + s->offset[g]*w;
+		for (j = 0; j < w; ++j)
+			if (row[j] >= 0)
+				VEC_RHS(row[j]) /= VEC_D(row[j]);
+		for (r = s->offset[g] + 1; r < s->offset[g+1]; ++r) {
+			row = s->index + r*w;
+			#pragma omp simd
+			for (j = 0; j < w; ++j) {
+				int i = row[j];
+				if (i >= 0) {
+					VEC_RHS(i) -= VEC_B(i) * VEC_RHS(parent[i]);
+					VEC_RHS(i) /= VEC_D(i);
+				}
+			}
+		}
+	}
+}
+
 #undef VEC_A
 #undef VEC_B
 #undef VEC_D
@@ -30,6 +30,21 @@
 
 #include "coreneuron_1.0/common/memory/nrnthread.h"
 
+/** \struct HinesSchedule
+ *  \brief The cells are independent systems, they are solved by groups of width cells, one
+ *  cell per SIMD lane, the groups are shared between the OMP threads
+ */
+typedef struct HinesSchedule {
+    /** number of cells of a group, one per lane */
+    int width;
+    /** number of groups */
+    int ngroup;
+    /** rows of the group g in [offset[g], offset[g+1]), the first row holds the roots */
+    int *offset;
+    /** compartment of the lane j in the row r at index[r*width + j], -1 when the cell is too short */
+    int *index;
+} HinesSchedule;
+
 #ifdef __cplusplus
     extern "C" {
         /** \fn void nrn_solve_minimal(NrnThread* _nt)
@@ -49,6 +64,28 @@
             \param NrnThread the data structure for access to the matrix data
          */
         void bksub(NrnThread*);
+
+        /** \fn int nrn_schedule_build(const NrnThread* _nt, int width, HinesSchedule* s)
+            \brief group the cells by decreasing size (see nrnthread_cells), width cells per group
+            \param NrnThread the data structure, the schedule must be rebuilt after a nrnthread_permute
+            \param width the number of cells solved together, typically MAPP_SIMD_WIDTH
+            \return MAPP_BAD_ARG if width < 1, MAPP_OK otherwise
+         */
+        int nrn_schedule_build(const NrnThread* _nt, int width, HinesSchedule* s);
+
+        /** \fn void nrn_schedule_free(HinesSchedule* s)
+            \brief release the memory of the schedule
+         */
+        void nrn_schedule_free(HinesSchedule* s);
+
+        /** \fn void nrn_solve_cells(NrnThread* _nt, const HinesSchedule* s)
+            \brief solve the matrix equation cell by cell, the groups of cells are shared between
+            the OMP threads and the cells of a group between the SIMD lanes. The compartments of a
+            cell are eliminated in the same order than nrn_solve_minimal, the results are identical
+            \param NrnThread the data structure for access to the matrix data
+            \param s the schedule built by nrn_schedule_build
+         */
+        void nrn_solve_cells(NrnThread* _nt, const HinesSchedule* s);
     }
 #else
     /** \fn void nrn_solve_minimal(NrnThread* _nt)
@@ -68,6 +105,28 @@
         \param NrnThread the data structure for access to the matrix data
      */
     void bksub(NrnThread*);
+
+    /** \fn int nrn_schedule_build(const NrnThread* _nt, int width, HinesSchedule* s)
+        \brief group the cells by decreasing size (see nrnthread_cells), width cells per group
+        \param NrnThread the data structure, the schedule must be rebuilt after a nrnthread_permute
+        \param width the number of cells solved together, typically MAPP_SIMD_WIDTH
+        \return MAPP_BAD_ARG if width < 1, MAPP_OK otherwise
+     */
+    int nrn_schedule_build(const NrnThread* _nt, int width, HinesSchedule* s);
+
+    /** \fn void nrn_schedule_free(HinesSchedule* s)
+        \brief release the memory of the schedule
+     */
+    void nrn_schedule_free(HinesSchedule* s);
+
+    /** \fn void nrn_solve_cells(NrnThread* _nt, const HinesSchedule* s)
+        \brief solve the matrix equation cell by cell, the groups of cells are shared between
+        the OMP threads and the cells of a group between the SIMD lanes. The compartments of a
+        cell are eliminated in the same order than nrn_solve_minimal, the results are identical
+        \param NrnThread the data structure for access to the matrix data
+        \param s the schedule built by nrn_schedule_build
+     */
+    void nrn_solve_cells(NrnThread* _nt, const HinesSchedule* s);
 #endif
 
 #endif
\ No newline at end of file
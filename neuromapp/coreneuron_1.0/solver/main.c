@@ -36,8 +36,11 @@
 #include "coreneuron_1.0/solver/hines.h"
 #include "coreneuron_1.0/solver/solver.h"
 #include "coreneuron_1.0/common/memory/nrnthread.h"
+#include "coreneuron_1.0/common/memory/permute.h"
 #include "coreneuron_1.0/common/util/nrnthread_handler.h"
 #include "coreneuron_1.0/common/util/timer.h"
+#include "coreneuron_1.0/common/util/simd.h"
+#include "utils/omp/compatibility.h"
 
 int coreneuron10_solver_execute(int argc, char * const argv[])
 {
@@ -53,9 +56,27 @@ int coreneuron10_solver_execute(int argc, char * const argv[])
         storage_clear(p.name);
         return MAPP_BAD_DATA;
     }
-    gettimeofday(&tvBegin, NULL);
-    nrn_solve_minimal(nt);
-    gettimeofday(&tvEnd, NULL);
+    /* the renumbering and the schedule are not timed, they are done once in a simulation */
+    nrnthread_permute(nt, p.permute);
+
+    if(p.cells){
+        HinesSchedule s;
+        omp_set_num_threads(p.th);
+        nrn_schedule_build(nt, MAPP_SIMD_WIDTH, &s);
+
+        gettimeofday(&tvBegin, NULL);
+        nrn_solve_cells(nt, &s);
+        gettimeofday(&tvEnd, NULL);
+
+        printf("\n %d groups of %d cells, %d threads", s.ngroup, s.width, p.th);
+        nrn_schedule_free(&s);
+    }else{
+        gettimeofday(&tvBegin, NULL);
+        nrn_solve_minimal(nt);
+        gettimeofday(&tvEnd, NULL);
+    }
+
+    nrnthread_unpermute(nt);
 
     timeval_subtract(&tvDiff, &tvEnd, &tvBegin);
     printf("\n Time For Hines Solver : %ld [s] %ld [us]", tvDiff.tv_sec, (long) tvDiff.tv_usec);
@@ -32,12 +32,19 @@
 #else
 // Otherwise, define dummy functions so that the mini-apps work properly
 #include <stdio.h>
+#include <sys/time.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 inline int omp_get_num_threads() { return 1; }
+inline int omp_get_max_threads() { return 1; }
 inline int omp_get_thread_num() { return 0; }
+static inline double omp_get_wtime(){
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec*1e-6;
+}
 static inline void omp_set_num_threads (int threads){
     if (threads != 1)
         printf("Setting the number of OMP threads, but OMP is not available. Execution may be wrong!\n");
@@ -26,6 +26,7 @@
 
 #define BOOST_TEST_MODULE KernelTest
 #include <vector>
+#include <cmath>
 
 #include <boost/test/unit_test.hpp>
 #include <boost/test/test_case_template.hpp>
@@ -37,6 +38,7 @@ extern "C" {
 #include "utils/storage/storage.h"
 #include "coreneuron_1.0/common/util/nrnthread_handler.h"
 #include "coreneuron_1.0/common/memory/nrnthread.h"
+#include "coreneuron_1.0/kernel/mechanism/registry.h"
 }
 
 #include "coreneuron_1.0/cstep/cstep.h" // signature kernel application
@@ -95,3 +97,240 @@ BOOST_AUTO_TEST_CASE(cstep_reference_solution_test){
     BOOST_CHECK(num==0);
     mapp::helper_check(command_v[4],"cstep",mapp::data_test());
 }
+
+BOOST_AUTO_TEST_CASE(cstep_simd_reference_solution_test){
+    bfs::path p(mapp::data_test());
+    bool b = bfs::exists(p);
+    BOOST_CHECK(b); //data ready, live or die
+
+    //preparing the command line
+    std::vector<std::string> command_v;
+    command_v.push_back("coreneuron10_cstep");
+    command_v.push_back("--data");
+    command_v.push_back(mapp::data_test());
+    command_v.push_back("--name");
+    command_v.push_back("coreneuron10_cstep_simd");
+    command_v.push_back("--simd");
+
+    int num = mapp::execute(command_v,coreneuron10_cstep_execute);
+    BOOST_CHECK(num==0);
+    mapp::helper_check(command_v[4],"cstep",mapp::data_test());
+}
+
+BOOST_AUTO_TEST_CASE(cstep_template_reference_solution_test){
+    bfs::path p(mapp::data_test());
+    bool b = bfs::exists(p);
+    BOOST_CHECK(b); //data ready, live or die
+
+    //preparing the command line
+    std::vector<std::string> command_v;
+    command_v.push_back("coreneuron10_cstep");
+    command_v.push_back("--data");
+    command_v.push_back(mapp::data_test());
+    command_v.push_back("--name");
+    command_v.push_back("coreneuron10_cstep_template");
+    command_v.push_back("--template");
+
+    int num = mapp::execute(command_v,coreneuron10_cstep_execute);
+    BOOST_CHECK(num==0);
+    mapp::helper_check(command_v[4],"cstep",mapp::data_test());
+}
+
+BOOST_AUTO_TEST_CASE(cstep_permute_reference_solution_test){
+    bfs::path p(mapp::data_test());
+    bool b = bfs::exists(p);
+    BOOST_CHECK(b); //data ready, live or die
+
+    const char* kinds[2] = {"cell", "interleave"};
+    for(int k=0; k < 2; ++k){
+        //preparing the command line
+        std::vector<std::string> command_v;
+        command_v.push_back("coreneuron10_cstep");
+        command_v.push_back("--data");
+        command_v.push_back(mapp::data_test());
+        command_v.push_back("--name");
+        command_v.push_back(std::string("coreneuron10_cstep_permute_") + kinds[k]);
+        command_v.push_back("--permute");
+        command_v.push_back(kinds[k]);
+
+        int num = mapp::execute(command_v,coreneuron10_cstep_execute);
+        BOOST_CHECK(num==0);
+        mapp::helper_check(command_v[4],"cstep",mapp::data_test());
+    }
+
+    //unknown renumbering
+    std::vector<std::string> command_v;
+    command_v.push_back("coreneuron10_cstep");
+    command_v.push_back("--data");
+    command_v.push_back(mapp::data_test());
+    command_v.push_back("--permute");
+    command_v.push_back("random");
+    BOOST_CHECK(mapp::execute(command_v,coreneuron10_cstep_execute)==mapp::MAPP_BAD_ARG);
+}
+
+BOOST_AUTO_TEST_CASE(cstep_cells_reference_solution_test){
+    bfs::path p(mapp::data_test());
+    bool b = bfs::exists(p);
+    BOOST_CHECK(b); //data ready, live or die
+
+    //preparing the command line
+    std::vector<std::string> command_v;
+    command_v.push_back("coreneuron10_cstep");
+    command_v.push_back("--data");
+    command_v.push_back(mapp::data_test());
+    command_v.push_back("--name");
+    command_v.push_back("coreneuron10_cstep_cells");
+    command_v.push_back("--cells");
+    command_v.push_back("--numthread");
+    command_v.push_back("2");
+    command_v.push_back("--permute");
+    command_v.push_back("lane");
+
+    int num = mapp::execute(command_v,coreneuron10_cstep_execute);
+    BOOST_CHECK(num==0);
+    mapp::helper_check(command_v[4],"cstep",mapp::data_test());
+}
+
+BOOST_AUTO_TEST_CASE(cstep_steps_test){
+    //preparing the command line
+    std::vector<std::string> command_v;
+    command_v.push_back("coreneuron10_cstep");
+    command_v.push_back("--data");
+    command_v.push_back(mapp::data_test());
+    command_v.push_back("--name");
+    command_v.push_back("coreneuron10_cstep_steps");
+    command_v.push_back("--steps");
+    command_v.push_back("5");
+    command_v.push_back("--warmup");
+    command_v.push_back("2");
+
+    NrnThread* ref = (NrnThread*) make_nrnthread((void*)mapp::data_test().c_str());
+    BOOST_REQUIRE(ref != NULL);
+
+    int num = mapp::execute(command_v,coreneuron10_cstep_execute);
+    BOOST_CHECK(num==0);
+
+    // the time advanced by the warm-up and the timed steps
+    NrnThread* nt = (NrnThread*) storage_get(command_v[4].c_str(), make_nrnthread,
+                                             (void*)mapp::data_test().c_str(), free_nrnthread);
+    BOOST_REQUIRE(nt != NULL);
+    BOOST_CHECK_CLOSE(nt->_t, ref->_t + 7*ref->_dt, 1e-10);
+    free_nrnthread(ref);
+
+    //no step
+    command_v[6] = "0";
+    BOOST_CHECK(mapp::execute(command_v,coreneuron10_cstep_execute)==mapp::MAPP_BAD_ARG);
+
+    //negative warm-up
+    command_v[6] = "1";
+    command_v[8] = "-1";
+    BOOST_CHECK(mapp::execute(command_v,coreneuron10_cstep_execute)==mapp::MAPP_BAD_ARG);
+}
+
+BOOST_AUTO_TEST_CASE(cstep_fused_test){
+    //a single step, the reference solution
+    std::vector<std::string> command_v;
+    command_v.push_back("coreneuron10_cstep");
+    command_v.push_back("--data");
+    command_v.push_back(mapp::data_test());
+    command_v.push_back("--name");
+    command_v.push_back("coreneuron10_cstep_fused");
+    command_v.push_back("--fused");
+
+    int num = mapp::execute(command_v,coreneuron10_cstep_execute);
+    BOOST_CHECK(num==0);
+    mapp::helper_check(command_v[4],"cstep",mapp::data_test());
+
+    //several steps, same data than the separate sweeps
+    const char* modes[3] = {"--fused", "--simd", "--template"};
+    for(int k=0; k < 3; ++k){
+        std::vector<std::string> separate;
+        separate.push_back("coreneuron10_cstep");
+        separate.push_back("--data");
+        separate.push_back(mapp::data_test());
+        separate.push_back("--name");
+        separate.push_back(std::string("coreneuron10_cstep_separate_") + modes[k]);
+        separate.push_back("--steps");
+        separate.push_back("3");
+        separate.push_back("--warmup");
+        separate.push_back("1");
+        std::vector<std::string> fused(separate);
+        fused[4] = std::string("coreneuron10_cstep_fused_") + modes[k];
+        fused.push_back("--fused");
+        if(k > 0){
+            separate.push_back(modes[k]);
+            fused.push_back(modes[k]);
+        }
+        BOOST_CHECK(mapp::execute(separate,coreneuron10_cstep_execute)==0);
+        BOOST_CHECK(mapp::execute(fused,coreneuron10_cstep_execute)==0);
+
+        NrnThread* a = (NrnThread*) storage_get(separate[4].c_str(), make_nrnthread, NULL, free_nrnthread);
+        NrnThread* b = (NrnThread*) storage_get(fused[4].c_str(), make_nrnthread, NULL, free_nrnthread);
+        BOOST_REQUIRE(a != NULL && b != NULL);
+        for(int i=0; i < a->_ndata; ++i)
+            BOOST_REQUIRE_EQUAL(a->_data[i], b->_data[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(cstep_bounded_test){
+    //rhs and d after a single step and after many, the currents do not accumulate
+    std::vector<std::string> one;
+    one.push_back("coreneuron10_cstep");
+    one.push_back("--data");
+    one.push_back(mapp::data_test());
+    one.push_back("--name");
+    one.push_back("coreneuron10_cstep_bounded_one");
+    std::vector<std::string> many(one);
+    many[4] = "coreneuron10_cstep_bounded_many";
+    many.push_back("--steps");
+    many.push_back("200");
+
+    BOOST_CHECK(mapp::execute(one,coreneuron10_cstep_execute)==0);
+    BOOST_CHECK(mapp::execute(many,coreneuron10_cstep_execute)==0);
+
+    NrnThread* a = (NrnThread*) storage_get(one[4].c_str(), make_nrnthread, NULL, free_nrnthread);
+    NrnThread* b = (NrnThread*) storage_get(many[4].c_str(), make_nrnthread, NULL, free_nrnthread);
+    BOOST_REQUIRE(a != NULL && b != NULL);
+    //the states evolve over the steps, the magnitudes stay (false for a nan)
+    for(int i=0; i < a->end; ++i){
+        BOOST_CHECK(std::fabs(b->_actual_d[i]) <= 2.*std::fabs(a->_actual_d[i]) + 1e-12);
+        BOOST_CHECK(std::fabs(b->_actual_rhs[i]) <= 2.*std::fabs(a->_actual_rhs[i]) + 1e-12);
+    }
+}
+
+/** kernels counting their calls, registered for the capacitance (type 3) */
+namespace {
+    int ncurrent = 0;
+    int nstate = 0;
+    void counting_current(NrnThread*, Mechanism*){ ++ncurrent; }
+    void counting_state(NrnThread*, Mechanism*){ ++nstate; }
+    void counting_chunk(NrnThread*, Mechanism*, int, int){}
+}
+
+BOOST_AUTO_TEST_CASE(cstep_registry_test){
+    mech_kernels k = {3, "capacitance", counting_current, counting_state, NULL,
+                      counting_chunk, counting_chunk, counting_chunk, counting_chunk,
+                      counting_chunk, counting_chunk};
+    BOOST_REQUIRE(mech_register(&k) == mapp::MAPP_OK);
+    BOOST_CHECK(mech_register(&k) == mapp::MAPP_BAD_ARG);
+
+    std::vector<std::string> command_v;
+    command_v.push_back("coreneuron10_cstep");
+    command_v.push_back("--data");
+    command_v.push_back(mapp::data_test());
+    command_v.push_back("--name");
+    command_v.push_back("coreneuron10_cstep_registry");
+    command_v.push_back("--steps");
+    command_v.push_back("3");
+
+    // the driver runs every registered mechanism of the dataset, without change
+    BOOST_CHECK(mapp::execute(command_v,coreneuron10_cstep_execute)==0);
+    BOOST_CHECK_EQUAL(ncurrent, 3);
+    BOOST_CHECK_EQUAL(nstate, 3);
+
+    // back to the kernels of the miniapp for the other tests
+    BOOST_CHECK(mech_unregister(3) == mapp::MAPP_OK);
+    BOOST_CHECK(mech_find(3) == NULL);
+    BOOST_CHECK(mech_unregister(3) == mapp::MAPP_BAD_ARG);
+    BOOST_CHECK(mech_find(MECH_TYPE_PROBAMPANMDA_EMS) != NULL);
+}
@@ -30,10 +30,21 @@
 #include <stdlib.h>
 #include <time.h>
 #include <ctime>
+#include <map>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <boost/filesystem.hpp>
 
 #include "coreneuron_1.0/event_passing/environment/generator.h"
 #include "coreneuron_1.0/event_passing/environment/event_generators.hpp"
 #include "coreneuron_1.0/event_passing/environment/presyn_maker.h"
+#include "coreneuron_1.0/event_passing/environment/trace.h"
+#include "utils/error.h"
+
+namespace bfs = ::boost::filesystem;
 
 /**
  * Test the constructor of presyn_maker class
@@ -94,6 +105,42 @@ BOOST_AUTO_TEST_CASE(presyns_functor_test){
     BOOST_CHECK(valid_input);
 }
 
+/**
+ * Test the lookups of presyn_table, an arithmetic progression of gids and
+ * sparse gids (hash table), and its copy
+ */
+BOOST_AUTO_TEST_CASE(presyn_table_test){
+    std::map<int, std::vector<int> > progression, sparse;
+    for(int gid = 3; gid < 300; gid += 7)
+        progression[gid].assign(gid % 5, gid);
+    for(int i = 0; i < 100; ++i)
+        sparse[(i*i*31) % 10007].push_back(i);
+
+    environment::presyn_table t1, t2;
+    t1.build(progression);
+    t2.build(sparse);
+    environment::presyn_table copy(t2);
+
+    for(int gid = -10; gid < 10100; ++gid){
+        std::map<int, std::vector<int> >::const_iterator it = progression.find(gid);
+        const environment::presyn* p = t1.find(gid);
+        BOOST_REQUIRE_EQUAL(p != NULL, it != progression.end());
+        if(p != NULL)
+            BOOST_REQUIRE(std::vector<int>(p->begin(), p->end()) == it->second);
+
+        it = sparse.find(gid);
+        p = copy.find(gid);
+        BOOST_REQUIRE_EQUAL(p != NULL, it != sparse.end());
+        if(p != NULL)
+            BOOST_REQUIRE(std::vector<int>(p->begin(), p->end()) == it->second);
+    }
+    BOOST_CHECK_EQUAL(t2.gids().size(), sparse.size());
+
+    environment::presyn_table empty;
+    empty.build(std::map<int, std::vector<int> >());
+    BOOST_CHECK(empty.find(0) == NULL);
+}
+
 /**
  * For a graph with max number of input presyns, test that
  * all gid's that are not in the range [rank, rank + num out) are input presyns.
@@ -381,3 +428,271 @@ BOOST_AUTO_TEST_CASE(generator_compare_top_lte){
     BOOST_CHECK(greater_than_min);
     BOOST_CHECK(less_than_max);
 }
+
+/**
+ * Test a trace written then read gives the same events and the seed of the
+ * connectivity, the replayed presyns are the recorded ones
+ */
+BOOST_AUTO_TEST_CASE(trace_record_replay){
+    int ncells = 20;
+    int nprocs = 1;
+    int ngroups = 4;
+    int simtime = 100;
+    int rank = 0;
+    unsigned seed = 1234;
+
+    environment::continousdistribution neuro_dist(nprocs, rank, ncells);
+    environment::event_generator generator(ngroups);
+    environment::generate_events_kai(generator.begin(),
+                             simtime, ngroups, rank, nprocs, 0.05, &neuro_dist);
+
+    BOOST_CHECK_EQUAL(environment::trace_name("events", rank), "events.0");
+    const std::string prefix((bfs::temp_directory_path() / bfs::unique_path()).string());
+    const std::string file = environment::trace_name(prefix, rank);
+    BOOST_CHECK_EQUAL(environment::write_trace(file, generator, seed), mapp::MAPP_OK);
+
+    environment::event_generator replay(ngroups);
+    unsigned replay_seed = 0;
+    BOOST_CHECK_EQUAL(environment::read_trace(file, replay, replay_seed), mapp::MAPP_OK);
+    BOOST_CHECK_EQUAL(replay_seed, seed);
+    for(int i = 0; i < ngroups; ++i){
+        BOOST_CHECK_EQUAL(replay.get_size(i), generator.get_size(i));
+        while(!generator.empty(i) && !replay.empty(i)){
+            environment::gen_event a = generator.pop(i);
+            environment::gen_event b = replay.pop(i);
+            BOOST_CHECK_EQUAL(a.first, b.first);
+            BOOST_CHECK_EQUAL(a.second, b.second);
+        }
+    }
+
+    //same seed, same connectivity
+    environment::presyn_maker recorded(5);
+    recorded(rank, &neuro_dist, seed);
+    environment::presyn_maker replayed(5);
+    replayed(rank, &neuro_dist, replay_seed);
+    BOOST_REQUIRE(recorded.output_gids() == replayed.output_gids());
+    for(int i = 0; i < recorded.output_gids().size(); ++i){
+        const environment::presyn* a = recorded.find_output(recorded.output_gids()[i]);
+        const environment::presyn* b = replayed.find_output(recorded.output_gids()[i]);
+        BOOST_REQUIRE(a != NULL && b != NULL);
+        BOOST_REQUIRE_EQUAL(a->size(), b->size());
+        for(int j = 0; j < a->size(); ++j)
+            BOOST_CHECK_EQUAL((*a)[j], (*b)[j]);
+    }
+
+    //the number of cell groups must match
+    environment::event_generator other(ngroups + 1);
+    BOOST_CHECK_EQUAL(environment::read_trace(file, other, replay_seed), mapp::MAPP_BAD_DATA);
+    bfs::remove(file);
+
+    BOOST_CHECK_EQUAL(environment::read_trace(file, replay, replay_seed), mapp::MAPP_BAD_ARG);
+}
+
+/**
+ * Test a trace with sizes beyond the file is rejected before any allocation
+ */
+BOOST_AUTO_TEST_CASE(trace_foreign_sizes){
+    const std::string file((bfs::temp_directory_path() / bfs::unique_path()).string());
+    const unsigned char header[] = {'N', 'M', 'T', 'R', 2, 0, 0, 0, 1, 0, 0, 0, 7, 0, 0, 0};
+    //2^60 events in 4 bytes, then 4 events in 2^60 bytes
+    const unsigned char sizes[2][16] = {{0, 0, 0, 0, 0, 0, 0, 16, 4, 0, 0, 0, 0, 0, 0, 0},
+                                        {4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16}};
+    for(int i = 0; i < 2; ++i){
+        {
+            std::ofstream out(file.c_str(), std::ios::binary);
+            out.write(reinterpret_cast<const char*>(header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(sizes[i]), sizeof(sizes[i]));
+            out.write("\1\1\1\1", 4);
+        }
+        environment::event_generator generator(1);
+        unsigned seed = 0;
+        BOOST_CHECK_EQUAL(environment::read_trace(file, generator, seed), mapp::MAPP_BAD_DATA);
+        BOOST_CHECK_EQUAL(generator.get_size(0), 0);
+    }
+    bfs::remove(file);
+}
+
+/**
+ * Test the import of a text spike train
+ */
+BOOST_AUTO_TEST_CASE(trace_import_spikes){
+    int ncells = 10;
+    int nprocs = 2;
+    int ngroups = 2;
+    int rank = 0;
+
+    //rank 0 holds the gids 0 to 4
+    environment::continousdistribution neuro_dist(nprocs, rank, ncells);
+    const std::string file((bfs::temp_directory_path() / bfs::unique_path()).string());
+    {
+        std::ofstream out(file.c_str());
+        out << "# time gid" << std::endl;
+        out << "0.5 3" << std::endl;
+        out << "0.1,2" << std::endl;
+        out << "0.2 7" << std::endl;
+        out << "0.3 1" << std::endl;
+    }
+
+    environment::event_generator generator(ngroups);
+    BOOST_CHECK_EQUAL(environment::import_spikes(file, false, 0.1, neuro_dist, generator),
+                      mapp::MAPP_OK);
+    //group 0: gid 2 at step 1; group 1: gid 1 at step 3, gid 3 at step 5, gid 7 is remote
+    BOOST_CHECK_EQUAL(generator.get_size(0), 1);
+    BOOST_CHECK_EQUAL(generator.get_size(1), 2);
+    environment::gen_event ev = generator.pop(0);
+    BOOST_CHECK_EQUAL(ev.first, 2);
+    BOOST_CHECK_EQUAL(ev.second, 1.);
+    ev = generator.pop(1);
+    BOOST_CHECK_EQUAL(ev.first, 1);
+    BOOST_CHECK_EQUAL(ev.second, 3.);
+    ev = generator.pop(1);
+    BOOST_CHECK_EQUAL(ev.first, 3);
+    BOOST_CHECK_EQUAL(ev.second, 5.);
+
+    {
+        std::ofstream out(file.c_str());
+        out << "0.5 three" << std::endl;
+    }
+    BOOST_CHECK_EQUAL(environment::import_spikes(file, false, 0.1, neuro_dist, generator),
+                      mapp::MAPP_BAD_DATA);
+    bfs::remove(file);
+}
+
+/** appends a binary spike record, float64 time and int32 gid (little endian) */
+static void put_spike(std::vector<unsigned char>& out, double t, int gid){
+    uint64_t time_bits;
+    std::memcpy(&time_bits, &t, sizeof(t));
+    for(int i = 0; i < 8; ++i)
+        out.push_back(static_cast<unsigned char>(time_bits >> (8*i)));
+    for(int i = 0; i < 4; ++i)
+        out.push_back(static_cast<unsigned char>(static_cast<uint32_t>(gid) >> (8*i)));
+}
+
+/**
+ * Test the import of a binary spike train, same events as the text one
+ */
+BOOST_AUTO_TEST_CASE(trace_import_binary_spikes){
+    int ncells = 10;
+    int nprocs = 2;
+    int ngroups = 2;
+    int rank = 0;
+
+    //rank 0 holds the gids 0 to 4
+    environment::continousdistribution neuro_dist(nprocs, rank, ncells);
+    const std::string file((bfs::temp_directory_path() / bfs::unique_path()).string());
+    std::vector<unsigned char> records;
+    put_spike(records, 0.5, 3);
+    put_spike(records, 0.1, 2);
+    put_spike(records, 0.2, 7);
+    put_spike(records, 0.3, 1);
+    {
+        std::ofstream out(file.c_str(), std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&records[0]), records.size());
+    }
+
+    environment::event_generator generator(ngroups);
+    BOOST_CHECK_EQUAL(environment::import_spikes(file, true, 0.1, neuro_dist, generator),
+                      mapp::MAPP_OK);
+    //group 0: gid 2 at step 1; group 1: gid 1 at step 3, gid 3 at step 5, gid 7 is remote
+    BOOST_CHECK_EQUAL(generator.get_size(0), 1);
+    BOOST_CHECK_EQUAL(generator.get_size(1), 2);
+    environment::gen_event ev = generator.pop(0);
+    BOOST_CHECK_EQUAL(ev.first, 2);
+    BOOST_CHECK_EQUAL(ev.second, 1.);
+    ev = generator.pop(1);
+    BOOST_CHECK_EQUAL(ev.first, 1);
+    BOOST_CHECK_EQUAL(ev.second, 3.);
+    ev = generator.pop(1);
+    BOOST_CHECK_EQUAL(ev.first, 3);
+    BOOST_CHECK_EQUAL(ev.second, 5.);
+
+    //a truncated record, a negative gid
+    {
+        std::ofstream out(file.c_str(), std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&records[0]), 12 + 8);
+    }
+    BOOST_CHECK_EQUAL(environment::import_spikes(file, true, 0.1, neuro_dist, generator),
+                      mapp::MAPP_BAD_DATA);
+    records.clear();
+    put_spike(records, 0.5, -3);
+    {
+        std::ofstream out(file.c_str(), std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&records[0]), records.size());
+    }
+    BOOST_CHECK_EQUAL(environment::import_spikes(file, true, 0.1, neuro_dist, generator),
+                      mapp::MAPP_BAD_DATA);
+    bfs::remove(file);
+
+    BOOST_CHECK_EQUAL(environment::import_spikes(file, true, 0.1, neuro_dist, generator),
+                      mapp::MAPP_BAD_ARG);
+}
+
+/**
+ * Test the event_pool of a cell group: time order, stable for equal times
+ */
+BOOST_AUTO_TEST_CASE(generator_event_pool){
+    environment::event_pool pool;
+    pool.reserve(8);
+    BOOST_CHECK(pool.empty());
+
+    pool.push(environment::gen_event(1, 2.));
+    pool.push(environment::gen_event(2, 5.));
+    pool.push(environment::gen_event(3, 1.));
+    pool.push(environment::gen_event(4, 5.));
+    pool.push(environment::gen_event(5, 2.));
+    BOOST_CHECK_EQUAL(pool.size(), 5);
+
+    BOOST_CHECK_EQUAL(pool.front().first, 3);
+    pool.pop();
+    //an event pushed after pops is sorted with the pending ones
+    pool.push(environment::gen_event(6, 3.));
+    const int after[] = {1, 5, 6, 2, 4};
+    for(int i = 0; i < 5; ++i){
+        BOOST_CHECK_EQUAL(pool.front().first, after[i]);
+        pool.pop();
+    }
+    BOOST_CHECK(pool.empty());
+
+    //the generator reads the pools through compare_top_lte/pop
+    environment::event_generator generator(2);
+    environment::event_generator::iterator it = generator.begin();
+    it->push(environment::gen_event(7, 4.));
+    it->push(environment::gen_event(8, 3.));
+    BOOST_CHECK(!generator.compare_top_lte(0, 2.));
+    BOOST_CHECK(generator.compare_top_lte(0, 3.));
+    BOOST_CHECK_EQUAL(generator.pop(0).first, 8);
+    BOOST_CHECK_EQUAL(generator.pop(0).first, 7);
+    BOOST_CHECK(generator.empty(0));
+    BOOST_CHECK(!generator.compare_top_lte(1, 100.));
+}
+
+/**
+ * Test the owner of the gids: the group storing them, for the contiguous and
+ * round-robin distributions, with empty groups and for a subset distribution
+ */
+BOOST_AUTO_TEST_CASE(distribution_owner){
+    const int ngroups = 4;
+    const int cells[] = {2, 13, 16};
+    for(int c = 0; c < 3; ++c){
+        for(int g = 0; g < ngroups; ++g){
+            environment::continousdistribution cont(ngroups, g, cells[c]);
+            for(int i = 0; i < cont.getlocalcells(); ++i)
+                BOOST_CHECK_EQUAL(cont.owner(cont.local2global(i)), g);
+
+            environment::nestdistribution nest(ngroups, g, cells[c]);
+            for(int i = 0; i < nest.getlocalcells(); ++i)
+                BOOST_CHECK_EQUAL(nest.owner(nest.local2global(i)), g);
+
+            //split the cells of the group g between 3 threads
+            for(int t = 0; t < 3; ++t){
+                environment::continousdistribution sub_cont(3, t, &cont);
+                for(int i = 0; i < sub_cont.getlocalcells(); ++i)
+                    BOOST_CHECK_EQUAL(sub_cont.owner(sub_cont.local2global(i)), t);
+
+                environment::nestdistribution sub_nest(3, t, &nest);
+                for(int i = 0; i < sub_nest.getlocalcells(); ++i)
+                    BOOST_CHECK_EQUAL(sub_nest.owner(sub_nest.local2global(i)), t);
+            }
+        }
+    }
+}
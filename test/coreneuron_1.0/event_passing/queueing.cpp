@@ -26,8 +26,10 @@
 #define IMPL T::impl
 
 #include <boost/test/unit_test.hpp>
+#include <boost/mpl/list.hpp>
 #include <boost/filesystem.hpp>
 #include <vector>
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <iostream>
@@ -41,6 +43,7 @@
 #include "coreneuron_1.0/event_passing/environment/presyn_maker.h"
 #include "coreneuron_1.0/event_passing/spike/spike_interface.h"
 #include "utils/error.h"
+#include "utils/omp/compatibility.h"
 #include "utils/storage/neuromapp_data.h"
 #include "coreneuron_1.0/common/data/helper.h"
 
@@ -122,6 +125,201 @@ BOOST_AUTO_TEST_CASE(thread_enqueue){
     BOOST_CHECK(nt.enqueued_ == (m + n));
 }
 
+/**
+ * Unit test for the lock-free inter thread sends
+ *
+ *    - same counters than the locked version
+ *    - the events are enqueued in their sending order
+ */
+BOOST_AUTO_TEST_CASE(thread_inter_send_lock_free){
+    queueing::nrn_thread_data nt(true);
+    int n = 10;
+
+    for(int i = 0; i < n; ++i){
+        nt.inter_thread_send(i, (double)(n - i));
+    }
+    BOOST_CHECK(nt.inter_thread_size() == n);
+    BOOST_CHECK(nt.ite_received_ == n);
+
+    std::vector<queueing::event> v;
+    queueing::inbox box;
+    for(int i = 0; i < n; ++i){
+        box.push(queueing::event(i, 0.));
+    }
+    BOOST_CHECK(box.drain(v) == n);
+    BOOST_CHECK(box.size() == 0);
+    for(int i = 0; i < n; ++i){
+        BOOST_CHECK_EQUAL(v[i].data_, i);
+    }
+
+    nt.enqueue_my_events();
+    BOOST_CHECK(nt.inter_thread_size() == 0);
+    BOOST_CHECK(nt.pq_size() == n);
+    BOOST_CHECK(nt.enqueued_ == n);
+}
+
+/**
+ * Unit test for the lock-free inter thread sends with concurrent senders,
+ * the owner enqueues while the other threads publish their batches
+ *
+ *    - every event of every producer enqueued once
+ *    - the events of a sender keep their order
+ */
+BOOST_AUTO_TEST_CASE(thread_inter_send_lock_free_concurrent){
+    queueing::nrn_thread_data nt(true);
+    queueing::inbox box;
+    const int n = 10000;
+    const size_t batch = 100;
+    int done = 0;
+    int nproducers = 0;
+    std::vector<queueing::event> drained;
+
+    #pragma omp parallel num_threads(4)
+    {
+        const int id = omp_get_thread_num();
+        if(id == 0){
+            while(__sync_fetch_and_add(&done, 0) < omp_get_num_threads() - 1){
+                nt.enqueue_my_events();
+                box.drain(drained);
+            }
+            nproducers = omp_get_num_threads() - 1;
+        }
+        else{
+            std::vector<queueing::event> events;
+            for(int i = 0; i < n; ++i){
+                events.push_back(queueing::event(id*n + i, (double)i));
+                if(events.size() == batch || i == n - 1){
+                    nt.inter_thread_publish(events);
+                    box.push(events.begin(), events.end());
+                    events.clear();
+                }
+            }
+            __sync_fetch_and_add(&done, 1);
+        }
+    }
+    nt.enqueue_my_events();
+    box.drain(drained);
+
+    BOOST_REQUIRE(nproducers > 1);
+    BOOST_CHECK_EQUAL(nt.ite_received_, nproducers*n);
+    BOOST_CHECK_EQUAL(nt.enqueued_, nproducers*n);
+    BOOST_CHECK_EQUAL(nt.pq_size(), nproducers*n);
+    BOOST_CHECK(nt.inter_thread_size() == 0);
+
+    BOOST_REQUIRE_EQUAL(drained.size(), nproducers*n);
+    BOOST_CHECK(box.size() == 0);
+    std::vector<int> next(nproducers + 1, 0);
+    for(size_t i = 0; i < drained.size(); ++i){
+        const int sender = drained[i].data_ / n;
+        BOOST_REQUIRE_EQUAL(drained[i].data_ % n, next[sender]++);
+    }
+}
+
+/**
+ * Unit test for the inter thread sends to a concurrent container,
+ * the events go in the bins while the owner delivers
+ *
+ *    - nothing in the inter thread events
+ *    - every event delivered once
+ */
+BOOST_AUTO_TEST_CASE(thread_inter_send_concurrent){
+    queueing::basic_nrn_thread_data<queueing::concurrent_bin_queue> nt;
+    const int n = 10000;
+    int done = 0;
+    int nproducers = 0;
+
+    #pragma omp parallel num_threads(4)
+    {
+        if(omp_get_thread_num() == 0){
+            while(__sync_fetch_and_add(&done, 0) < omp_get_num_threads() - 1){
+                nt.enqueue_my_events();
+                nt.deliver_batch();
+                nt.increment_time();
+            }
+            nproducers = omp_get_num_threads() - 1;
+        }
+        else{
+            for(int i = 0; i < n; ++i){
+                nt.inter_thread_send(i, (double)(i % 100));
+            }
+            __sync_fetch_and_add(&done, 1);
+        }
+    }
+    BOOST_CHECK(nt.inter_thread_size() == 0);
+    for(int t = 0; t < 100; ++t){
+        nt.deliver_batch();
+        nt.increment_time();
+    }
+
+    BOOST_REQUIRE(nproducers > 1);
+    BOOST_CHECK_EQUAL(nt.ite_received_, nproducers*n);
+    BOOST_CHECK_EQUAL(nt.enqueued_, nproducers*n);
+    BOOST_CHECK_EQUAL(nt.delivered_, nproducers*n);
+    BOOST_CHECK(nt.pq_size() == 0);
+}
+
+typedef boost::mpl::list<queueing::queue,
+                         queueing::sptq_queue,
+                         queueing::bin_queue,
+                         queueing::concurrent_bin_queue> container_types;
+
+/**
+ * Unit test for the event containers
+ *
+ *    - batch_dq pops every event with time <= til, in time order
+ *    - atomic_dq pops them one by one
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE(container_batch_dq, T, container_types){
+    T q;
+    const int n = 1000;
+    srand(1);
+    for(int i = 0; i < n; ++i){
+        q.insert((double)(rand() % 100), i);
+    }
+    BOOST_CHECK(q.size() == n);
+
+    std::vector<queueing::event> v;
+    size_t popped = q.batch_dq(49., v);
+    BOOST_CHECK(popped == v.size());
+    BOOST_CHECK(q.size() == n - popped);
+    for(size_t i = 0; i < v.size(); ++i){
+        BOOST_CHECK(v[i].t_ <= 49.);
+        if(i > 0)
+            BOOST_CHECK(v[i-1].t_ <= v[i].t_);
+    }
+
+    queueing::event e;
+    BOOST_CHECK(q.atomic_dq(49., e) == false);
+    size_t count = 0;
+    double last = 50.;
+    while(q.atomic_dq(99., e)){
+        BOOST_CHECK(e.t_ >= last);
+        last = e.t_;
+        ++count;
+    }
+    BOOST_CHECK(count + popped == n);
+    BOOST_CHECK(q.size() == 0);
+}
+
+/**
+ * Unit test for nrn_thread_data::deliver_batch function, same deliveries
+ * than deliver
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE(thread_deliver_batch, T, container_types){
+    queueing::basic_nrn_thread_data<T> nt;
+    const int n = 100;
+    for(int i = 0; i < n; ++i){
+        nt.self_send(i, (double)(i % 10));
+    }
+    for(int t = 0; t < 5; ++t){
+        nt.increment_time();
+    }
+    BOOST_CHECK_EQUAL(nt.deliver_batch(), 60);
+    BOOST_CHECK(nt.deliver() == false);
+    BOOST_CHECK(nt.pq_size() == 40);
+    BOOST_CHECK_EQUAL(nt.delivered_, 60);
+}
+
 /*
  * Unit test for nrn_thread_data::deliver function
  *
@@ -190,6 +388,51 @@ BOOST_AUTO_TEST_CASE(net_receive){
     mapp::helper_check(name, "net_receive", mapp::data_test());
 }
 
+/**
+ * Unit test for nrn_thread_data::l_algebra in fused mode
+ *
+ * the states of the mechanisms after n steps are the same with and
+ * without the fused sweeps
+ */
+BOOST_AUTO_TEST_CASE(thread_l_algebra_fused){
+    char name[] = "coreneuron_1.0_queueing_data";
+    const int steps = 4;
+    const int mechs[3] = {17, 10, 18};
+
+    storage_clear(name);
+    queueing::nrn_thread_data separate;
+    for(int i = 0; i <= steps; ++i)
+        separate.l_algebra(false);
+    NrnThread* ref = (NrnThread*) storage_get(name, make_nrnthread, NULL, free_nrnthread);
+    std::vector<std::vector<double> > states(3);
+    for(int k = 0; k < 3; ++k){
+        Mechanism* ml = &ref->ml[mechs[k]];
+        states[k].assign(ml->data, ml->data + ml->szp*ml->nodecount);
+    }
+    std::vector<double> rhs(ref->_actual_rhs, ref->_actual_rhs + ref->end);
+    std::vector<double> d(ref->_actual_d, ref->_actual_d + ref->end);
+
+    // a fresh dataset for the second run, the last step back to the separate sweeps
+    // consumes the current precomputed by the last fused sweep
+    storage_clear(name);
+    queueing::nrn_thread_data fused;
+    for(int i = 0; i < steps; ++i)
+        fused.l_algebra(true);
+    fused.l_algebra(false);
+    NrnThread* nt = (NrnThread*) storage_get(name, make_nrnthread, NULL, free_nrnthread);
+
+    for(int k = 0; k < 3; ++k){
+        Mechanism* ml = &nt->ml[mechs[k]];
+        for(int i = 0; i < ml->szp*ml->nodecount; ++i)
+            BOOST_REQUIRE_EQUAL(ml->data[i], states[k][i]);
+    }
+    for(int i = 0; i < nt->end; ++i){
+        BOOST_REQUIRE_CLOSE(nt->_actual_rhs[i], rhs[i], 1e-8);
+        BOOST_REQUIRE_CLOSE(nt->_actual_d[i], d[i], 1e-8);
+    }
+
+    storage_clear(name);
+}
 
 //POOL REGRESSION TESTING
 /**
@@ -322,3 +565,277 @@ BOOST_AUTO_TEST_CASE(pool_send_ite){
     //check that every event went to the spikeout_ buffer
     BOOST_CHECK(spike.spikeout_.size() == sum_events);
 }
+
+namespace {
+    /** the events of the gid are in the group gid % ngroups, every group sends */
+    void generate_group_events(environment::event_generator& events, int simtime, int ngroups,
+                               int rank, int nprocs, int nspikes, environment::neurondistribution* dist){
+        double mean = static_cast<double>(simtime) / static_cast<double>(nspikes);
+        double lambda = 1.0 / static_cast<double>(mean * nprocs);
+        environment::generate_events_kai(events.begin(), simtime, ngroups, rank, nprocs, lambda, dist);
+        for(int i = 0; i < ngroups; ++i)
+            BOOST_REQUIRE(!events.empty(i));
+    }
+
+    /** several threads run the cell groups whatever the machine, they send to the same
+     *  groups at once */
+    struct concurrent_groups {
+        concurrent_groups(): nthreads_(omp_get_max_threads()) {
+            omp_set_num_threads(std::max(nthreads_, 4));
+        }
+        ~concurrent_groups() {
+            omp_set_num_threads(nthreads_);
+        }
+        int nthreads_;
+    };
+}
+
+/**
+ * Tests the fixed step function of the pool class with the lock-free inboxes,
+ * same statistics than the locked version, every group sending to the others
+ */
+BOOST_FIXTURE_TEST_CASE(pool_send_ite_lock_free, concurrent_groups){
+    int ncells = 40;
+    int fanin = 5;
+    int nprocs = 4;
+    int ngroups = 8;
+    int nspikes = 1000;
+    int mindelay = 5;
+    int simtime = 100;
+    int rank = 0;
+
+    environment::continousdistribution neuro_dist(nprocs, rank, ncells);
+    environment::presyn_maker presyns(fanin);
+    presyns(rank, &neuro_dist);
+
+    environment::event_generator events(ngroups);
+    generate_group_events(events, simtime, ngroups, rank, nprocs, nspikes, &neuro_dist);
+
+    int ite_stats[2];
+    int local_stats[2];
+    int spikeout[2];
+    int delivered[2];
+    for(int lock_free = 0; lock_free < 2; ++lock_free){
+        spike::spike_interface spike(nprocs);
+        environment::event_generator generator(events);
+
+        queueing::pool pl(false, ngroups, mindelay, rank, spike, false, lock_free);
+        while(pl.get_time() <= simtime){
+            pl.fixed_step(generator, presyns);
+        }
+        pl.accumulate_stats();
+        ite_stats[lock_free] = spike.ite_stats_;
+        local_stats[lock_free] = spike.local_stats_;
+        spikeout[lock_free] = spike.spikeout_.size();
+        delivered[lock_free] = pl.delivered();
+    }
+    BOOST_CHECK(ite_stats[0] > 0);
+    BOOST_CHECK(delivered[0] > 0);
+    BOOST_CHECK_EQUAL(ite_stats[0], ite_stats[1]);
+    BOOST_CHECK_EQUAL(local_stats[0], local_stats[1]);
+    BOOST_CHECK_EQUAL(spikeout[0], spikeout[1]);
+    BOOST_CHECK_EQUAL(delivered[0], delivered[1]);
+}
+
+namespace {
+    /** runs the pool with the container Q, the statistics are in spike */
+    template<class Q>
+    int run_pool(spike::spike_interface& spike, const environment::event_generator& events,
+                 const environment::presyn_maker& presyns, int ngroups, int mindelay, int rank, int simtime){
+        environment::event_generator generator(events);
+        queueing::basic_pool<Q> pl(false, ngroups, mindelay, rank, spike);
+        while(pl.get_time() <= simtime)
+            pl.fixed_step(generator, presyns);
+        pl.accumulate_stats();
+        return pl.delivered();
+    }
+}
+
+/**
+ * Tests the pool with every event container, same statistics than the binary heap,
+ * every group sending to the others
+ */
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(pool_containers, T, container_types, concurrent_groups){
+    int ncells = 40;
+    int fanin = 5;
+    int nprocs = 4;
+    int ngroups = 8;
+    int nspikes = 1000;
+    int mindelay = 5;
+    int simtime = 100;
+    int rank = 0;
+
+    environment::continousdistribution neuro_dist(nprocs, rank, ncells);
+    environment::presyn_maker presyns(fanin);
+    presyns(rank, &neuro_dist);
+
+    environment::event_generator events(ngroups);
+    generate_group_events(events, simtime, ngroups, rank, nprocs, nspikes, &neuro_dist);
+
+    spike::spike_interface heap(nprocs);
+    spike::spike_interface spike(nprocs);
+    int heap_delivered = run_pool<queueing::queue>(heap, events, presyns, ngroups, mindelay, rank, simtime);
+    int delivered = run_pool<T>(spike, events, presyns, ngroups, mindelay, rank, simtime);
+
+    BOOST_CHECK(heap.ite_stats_ > 0);
+    BOOST_CHECK_EQUAL(heap.ite_stats_, spike.ite_stats_);
+    BOOST_CHECK_EQUAL(heap.local_stats_, spike.local_stats_);
+    BOOST_CHECK_EQUAL(heap.spikeout_.size(), spike.spikeout_.size());
+    BOOST_CHECK_EQUAL(heap_delivered, delivered);
+}
+
+/**
+ * Tests the fixed step function of the pool class with the thread local buffers,
+ * same statistics than the direct sends once the buffers of every group are merged
+ */
+BOOST_FIXTURE_TEST_CASE(pool_send_ite_buffered, concurrent_groups){
+    int ncells = 40;
+    int fanin = 5;
+    int nprocs = 4;
+    int ngroups = 8;
+    int nspikes = 1000;
+    int mindelay = 5;
+    int simtime = 100;
+    int rank = 0;
+
+    environment::continousdistribution neuro_dist(nprocs, rank, ncells);
+    environment::presyn_maker presyns(fanin);
+    presyns(rank, &neuro_dist);
+
+    environment::event_generator events(ngroups);
+    generate_group_events(events, simtime, ngroups, rank, nprocs, nspikes, &neuro_dist);
+
+    int ite_stats[2];
+    int local_stats[2];
+    int spike_stats[2];
+    int delivered[2];
+    std::vector<int> spikeout[2];
+    for(int buffered = 0; buffered < 2; ++buffered){
+        spike::spike_interface spike(nprocs);
+        environment::event_generator generator(events);
+
+        queueing::pool pl(false, ngroups, mindelay, rank, spike, false, false, buffered);
+        while(pl.get_time() <= simtime){
+            pl.fixed_step(generator, presyns);
+        }
+        pl.accumulate_stats();
+        ite_stats[buffered] = spike.ite_stats_;
+        local_stats[buffered] = spike.local_stats_;
+        spike_stats[buffered] = spike.spike_stats_;
+        delivered[buffered] = pl.delivered();
+        for(size_t i = 0; i < spike.spikeout_.size(); ++i)
+            spikeout[buffered].push_back(spike.spikeout_[i].data_);
+        // the order of the spikes depends on the merge
+        std::sort(spikeout[buffered].begin(), spikeout[buffered].end());
+    }
+    BOOST_CHECK(ite_stats[0] > 0);
+    BOOST_CHECK(delivered[0] > 0);
+    BOOST_CHECK_EQUAL(ite_stats[0], ite_stats[1]);
+    BOOST_CHECK_EQUAL(local_stats[0], local_stats[1]);
+    BOOST_CHECK_EQUAL(spike_stats[0], spike_stats[1]);
+    BOOST_CHECK_EQUAL(delivered[0], delivered[1]);
+    BOOST_CHECK(spikeout[0] == spikeout[1]);
+}
+
+/**
+ * for queueing::pool
+ * test that the parallel filter sends an event for every target of the
+ * received spikes, whatever the number of threads
+ */
+BOOST_AUTO_TEST_CASE(pool_filter){
+    int ncells = 100;
+    int fanin = 5;
+    int nprocs = 4;
+    int ngroups = 3;
+    int mindelay = 5;
+    int rank = 0;
+
+    environment::continousdistribution neuro_dist(nprocs, rank, ncells);
+    environment::presyn_maker presyns(fanin);
+    presyns(rank, &neuro_dist);
+
+    // every gid spikes twice, the expected counts are from the serial scan
+    std::vector<queueing::event> received;
+    int expected = 0;
+    for(int gid = 0; gid < ncells; ++gid){
+        for(int k = 0; k < 2; ++k)
+            received.push_back(queueing::event(gid, gid + k));
+        const environment::presyn* input = presyns.find_input(gid);
+        if(input != NULL)
+            expected += 2*input->size();
+    }
+    BOOST_REQUIRE(expected > 0);
+
+    spike::spike_interface spike(nprocs);
+    queueing::pool pl(false, ngroups, mindelay, rank, spike);
+    spike.spikein_ = received;
+    spike.spikeout_ = received;
+    pl.filter(presyns);
+    BOOST_CHECK_EQUAL(spike.post_spike_stats_, expected);
+    BOOST_CHECK_EQUAL(spike.received_spike_stats_, received.size());
+    BOOST_CHECK(spike.spikein_.empty());
+    BOOST_CHECK(spike.spikeout_.empty());
+
+    // an empty exchange
+    pl.filter(presyns);
+    BOOST_CHECK_EQUAL(spike.post_spike_stats_, expected);
+}
+
+/**
+ * for queueing::pool
+ * test that the task schedule processes the same events than the static one,
+ * and that the busy and idle times are measured per thread
+ */
+BOOST_AUTO_TEST_CASE(pool_tasks){
+    int ncells = 40;
+    int fanin = 5;
+    int nprocs = 4;
+    int ngroups = 8;
+    int nspikes = 1000;
+    int mindelay = 5;
+    int simtime = 100;
+    int rank = 0;
+
+    environment::continousdistribution neuro_dist(nprocs, rank, ncells);
+    environment::presyn_maker presyns(fanin);
+    presyns(rank, &neuro_dist);
+
+    //the events of the gid are in the group gid % ngroups, the same for both schedules
+    environment::event_generator events(ngroups);
+    double mean = static_cast<double>(simtime) / static_cast<double>(nspikes);
+    double lambda = 1.0 / static_cast<double>(mean * nprocs);
+    environment::generate_events_kai(events.begin(),
+                    simtime, ngroups, rank, nprocs, lambda, &neuro_dist);
+    for(int i = 0; i < ngroups; ++i)
+        BOOST_REQUIRE(!events.empty(i));
+
+    int ite_stats[2];
+    int local_stats[2];
+    int spike_stats[2];
+    for(int tasks = 0; tasks < 2; ++tasks){
+        spike::spike_interface spike(nprocs);
+        environment::event_generator generator(events);
+
+        queueing::pool pl(false, ngroups, mindelay, rank, spike, false, false, false, tasks);
+        while(pl.get_time() <= simtime){
+            pl.fixed_step(generator, presyns);
+        }
+        pl.accumulate_stats();
+        ite_stats[tasks] = spike.ite_stats_;
+        local_stats[tasks] = spike.local_stats_;
+        spike_stats[tasks] = spike.spike_stats_;
+
+        BOOST_REQUIRE_EQUAL(pl.busy_times().size(), omp_get_max_threads());
+        BOOST_REQUIRE_EQUAL(pl.idle_times().size(), omp_get_max_threads());
+        double busy = 0.;
+        for(int i = 0; i < pl.busy_times().size(); ++i){
+            busy += pl.busy_times()[i];
+            BOOST_CHECK(pl.idle_times()[i] >= 0.);
+        }
+        BOOST_CHECK(busy > 0.);
+    }
+    BOOST_CHECK(ite_stats[0] > 0);
+    BOOST_CHECK_EQUAL(ite_stats[0], ite_stats[1]);
+    BOOST_CHECK_EQUAL(local_stats[0], local_stats[1]);
+    BOOST_CHECK_EQUAL(spike_stats[0], spike_stats[1]);
+}
@@ -31,10 +31,17 @@
 #include <time.h>
 #include <stdlib.h>
 #include <numeric>
+#include <vector>
+#include <algorithm>
 #include <iostream>
 
 #include "coreneuron_1.0/common/data/helper.h"
 #include "coreneuron_1.0/event_passing/spike/algos.hpp"
+#include "coreneuron_1.0/event_passing/spike/nonblocking.hpp"
+#include "coreneuron_1.0/event_passing/spike/compressed.hpp"
+#include "coreneuron_1.0/event_passing/spike/distributed.hpp"
+#include "coreneuron_1.0/event_passing/environment/presyn_maker.h"
+#include "coreneuron_1.0/event_passing/environment/neurondistribution.h"
 #include "coreneuron_1.0/event_passing/spike/spike_interface.h"
 #include "utils/error.h"
 namespace bfs = ::boost::filesystem;
@@ -88,6 +95,298 @@ BOOST_AUTO_TEST_CASE(displ_test){
     }
 }
 
+/**
+ * test the non-blocking exchange: the spikes of the interval k are in spikein_
+ * after the call following the interval k+1 (the last interval at the flush),
+ * whether progress() chained them or not,
+ * every rank received the spikes of every interval
+ */
+BOOST_AUTO_TEST_CASE(nonblocking_spike_exchange){
+    int size;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    MPI_Datatype spike = create_spike_type();
+    spike::spike_interface interface(size);
+    const int ninterval = 4;
+    // rank r sends r+1 spikes per interval
+    const int nspikes = size*(size+1)/2;
+    std::vector<int> received;
+    {
+        nonblocking_exchange<spike::spike_interface> exchange(interface, spike, MPI_COMM_WORLD);
+        for(int k = 0; k <= ninterval; ++k){
+            if(k < ninterval){
+                for(int i = 0; i <= rank; ++i)
+                    interface.spikeout_.push_back(spike_item(rank*ninterval + k, k));
+                exchange();
+                BOOST_CHECK(interface.spikeout_.empty());
+                // the spikes are chained at the next call without it
+                if(k % 2)
+                    exchange.progress();
+            }
+            else{
+                exchange.flush();
+            }
+            // the previous interval, and only it
+            BOOST_CHECK_EQUAL(interface.spikein_.size(), k == 0 ? 0u : (size_t)nspikes);
+            for(int i = 0; i < interface.spikein_.size(); ++i){
+                BOOST_CHECK_EQUAL(interface.spikein_[i].t_, k-1);
+                received.push_back(interface.spikein_[i].data_);
+            }
+            interface.spikein_.clear();
+        }
+        BOOST_CHECK(exchange.exposed() >= 0.);
+    }
+
+    std::vector<int> expected;
+    for(int r = 0; r < size; ++r)
+        for(int k = 0; k < ninterval; ++k)
+            for(int i = 0; i <= r; ++i)
+                expected.push_back(r*ninterval + k);
+    std::sort(received.begin(), received.end());
+    BOOST_CHECK(received == expected);
+    MPI_Type_free(&spike);
+}
+
+/**
+ * test the fixed size exchange: the spikes of every rank are received in the
+ * common case as after an overflow, the buffer grows on overflow
+ */
+BOOST_AUTO_TEST_CASE(fixed_spike_exchange){
+    int size;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    MPI_Datatype spike = create_spike_type();
+    spike::spike_interface interface(size);
+    interface.fixed_size_ = 2;
+    const int ninterval = 4;
+    for(int k = 0; k < ninterval; ++k){
+        // rank r sends (k+1)*(r+1) spikes, overflow from k = 2
+        interface.spikeout_.clear();
+        for(int i = 0; i < (k+1)*(rank+1); ++i)
+            interface.spikeout_.push_back(spike_item(rank, k));
+        fixed_spike(interface, spike);
+
+        std::vector<int> received;
+        for(int i = 0; i < interface.spikein_.size(); ++i){
+            BOOST_CHECK_EQUAL(interface.spikein_[i].t_, k);
+            received.push_back(interface.spikein_[i].data_);
+        }
+        std::vector<int> expected;
+        for(int r = 0; r < size; ++r)
+            for(int i = 0; i < (k+1)*(r+1); ++i)
+                expected.push_back(r);
+        std::sort(received.begin(), received.end());
+        BOOST_CHECK(received == expected);
+        BOOST_CHECK(interface.fixed_size_ >= (k+1)*size);
+    }
+    BOOST_CHECK(interface.overflow_stats_ > 0);
+    MPI_Type_free(&spike);
+}
+
+/**
+ * tests the encode/decode kernels of spike_codec in both widths
+ */
+BOOST_AUTO_TEST_CASE(spike_codec_round_trip){
+    // 10 gids (4 bits) and a window of 5 steps (3 bits) in 4 bytes
+    spike_codec small(10, 5.);
+    BOOST_CHECK_EQUAL(small.width(), 4);
+    // 2^30 gids (30 bits) and 5 steps do not fit in 32 bits
+    spike_codec large(1 << 30, 5.);
+    BOOST_CHECK_EQUAL(large.width(), 8);
+
+    const double t0 = 120.;
+    std::vector<spike_item> spikes;
+    for(int i = 0; i <= 5; ++i)
+        spikes.push_back(spike_item(9 - i, t0 + i));
+
+    std::vector<uint32_t> w32;
+    std::vector<spike_item> back;
+    small.encode(spikes, w32, t0);
+    small.decode(w32, back, t0);
+    BOOST_REQUIRE_EQUAL(back.size(), spikes.size());
+    for(int i = 0; i < spikes.size(); ++i){
+        BOOST_CHECK_EQUAL(back[i].data_, spikes[i].data_);
+        BOOST_CHECK_EQUAL(back[i].t_, spikes[i].t_);
+    }
+
+    spikes.push_back(spike_item((1 << 30) - 1, t0 + 2));
+    std::vector<uint64_t> w64;
+    large.encode(spikes, w64, t0);
+    large.decode(w64, back, t0);
+    BOOST_REQUIRE_EQUAL(back.size(), spikes.size());
+    for(int i = 0; i < spikes.size(); ++i){
+        BOOST_CHECK_EQUAL(back[i].data_, spikes[i].data_);
+        BOOST_CHECK_EQUAL(back[i].t_, spikes[i].t_);
+    }
+}
+
+/**
+ * tests that the compressed spike exchange receives the spikes of the blocking one
+ */
+BOOST_AUTO_TEST_CASE(compressed_spike_exchange){
+    int size;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    MPI_Datatype spike = create_spike_type();
+    spike::spike_interface blocking(size);
+    spike::spike_interface compressed(size);
+    const int mindelay = 3;
+    spike_codec codec(100*size, mindelay);
+    for(int t0 = 0; t0 < 4*mindelay; t0 += mindelay){
+        blocking.spikeout_.clear();
+        for(int i = 0; i < rank + t0; ++i)
+            blocking.spikeout_.push_back(spike_item(100*rank + i, t0 + i%mindelay));
+        compressed.spikeout_ = blocking.spikeout_;
+
+        blocking_spike(blocking, spike);
+        compressed_spike(compressed, codec, t0);
+
+        BOOST_REQUIRE_EQUAL(compressed.spikein_.size(), blocking.spikein_.size());
+        for(int i = 0; i < blocking.spikein_.size(); ++i){
+            BOOST_CHECK_EQUAL(compressed.spikein_[i].data_, blocking.spikein_[i].data_);
+            BOOST_CHECK_EQUAL(compressed.spikein_[i].t_, blocking.spikein_[i].t_);
+        }
+    }
+    MPI_Type_free(&spike);
+}
+
+/**
+ * tests that a spike out of the window or off the steps is not packed, its rank sends the
+ * uncompressed spikes and every rank receives the spikes of the blocking exchange
+ */
+BOOST_AUTO_TEST_CASE(compressed_spike_out_of_window){
+    // 10 gids and a window of 5 steps
+    spike_codec small(10, 5.);
+    const double t0 = 120.;
+    std::vector<uint32_t> w32;
+    std::vector<spike_item> spikes(1, spike_item(3, t0 + 5));
+    BOOST_CHECK(small.encode(spikes, w32, t0));
+    // 3 bits of steps, 8 does not fit
+    spikes.push_back(spike_item(3, t0 + 8));
+    BOOST_CHECK(!small.encode(spikes, w32, t0));
+    spikes.back() = spike_item(3, t0 - 1);
+    BOOST_CHECK(!small.encode(spikes, w32, t0));
+    spikes.back() = spike_item(1 << 29, t0);
+    BOOST_CHECK(!small.encode(spikes, w32, t0));
+    // off the steps, it would be rounded
+    spikes.back() = spike_item(3, t0 + 2.25);
+    BOOST_CHECK(!small.encode(spikes, w32, t0));
+    // on a step, up to the rounding error
+    spikes.back() = spike_item(3, t0 + 0.1 + 0.2 + 1.7);
+    BOOST_CHECK(small.encode(spikes, w32, t0));
+
+    int size;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    MPI_Datatype spike = create_spike_type();
+    spike::spike_interface blocking(size);
+    spike::spike_interface compressed(size);
+    const int mindelay = 3;
+    spike_codec codec(100*size, mindelay);
+    for(int t0 = 0; t0 < 3*mindelay; t0 += mindelay){
+        blocking.spikeout_.clear();
+        for(int i = 0; i <= rank; ++i)
+            blocking.spikeout_.push_back(spike_item(100*rank + i, t0 + i%mindelay));
+        // an imported time off the window on rank 0, in the second interval
+        if(rank == 0 && t0 == mindelay)
+            blocking.spikeout_.push_back(spike_item(1, t0 + 10.5));
+        // in the window but off the steps, in the third one
+        if(rank == 0 && t0 == 2*mindelay)
+            blocking.spikeout_.push_back(spike_item(1, t0 + 1.25));
+        compressed.spikeout_ = blocking.spikeout_;
+
+        blocking_spike(blocking, spike);
+        compressed_spike(compressed, codec, t0);
+
+        BOOST_REQUIRE_EQUAL(compressed.spikein_.size(), blocking.spikein_.size());
+        for(int i = 0; i < blocking.spikein_.size(); ++i){
+            BOOST_CHECK_EQUAL(compressed.spikein_[i].data_, blocking.spikein_[i].data_);
+            BOOST_CHECK_EQUAL(compressed.spikein_[i].t_, blocking.spikein_[i].t_);
+        }
+    }
+    BOOST_CHECK_EQUAL(codec.fallbacks(), rank == 0 ? 2 : 0);
+    MPI_Type_free(&spike);
+}
+
+#if MPI_VERSION >= 3
+/**
+ * checks that the distributed graph has an edge from every owner of an input
+ * presyn, and that the out edges match the in edges of the other ranks
+ */
+template<typename D>
+void check_dist_graph(int ncells, int fanin){
+    int size;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    D neuro_dist(size, rank, ncells);
+    environment::presyn_maker presyns(fanin);
+    presyns(rank, &neuro_dist);
+    MPI_Comm neighborhood = create_dist_graph(presyns, neuro_dist);
+
+    std::vector<int> expected_in(size, 0);
+    for(int r = 0; r < size; ++r){
+        D other(size, r, ncells);
+        for(int i = 0; i < other.getlocalcells(); ++i)
+            if(r != rank && presyns.find_input(other.local2global(i)))
+                expected_in[r] = 1;
+    }
+    std::vector<int> expected_out(size, 0);
+    MPI_Alltoall(&expected_in[0], 1, MPI_INT, &expected_out[0], 1, MPI_INT, MPI_COMM_WORLD);
+
+    int nin, nout, weighted;
+    MPI_Dist_graph_neighbors_count(neighborhood, &nin, &nout, &weighted);
+    std::vector<int> in(nin + 1), out(nout + 1);
+    MPI_Dist_graph_neighbors(neighborhood, nin, &in[0], MPI_UNWEIGHTED,
+        nout, &out[0], MPI_UNWEIGHTED);
+    std::vector<int> graph_in(size, 0), graph_out(size, 0);
+    for(int i = 0; i < nin; ++i)
+        graph_in[in[i]] = 1;
+    for(int i = 0; i < nout; ++i)
+        graph_out[out[i]] = 1;
+    BOOST_CHECK(graph_in == expected_in);
+    BOOST_CHECK(graph_out == expected_out);
+    MPI_Comm_free(&neighborhood);
+}
+
+/**
+ * tests the distributed graph of the contiguous distribution
+ */
+BOOST_AUTO_TEST_CASE(create_dist_graph_test){
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    // one more cell on the first ranks
+    check_dist_graph<environment::continousdistribution>(10*size + size/2, 4);
+}
+
+/**
+ * tests the distributed graph when the last rank owns no cell
+ */
+BOOST_AUTO_TEST_CASE(create_dist_graph_empty_rank){
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    check_dist_graph<environment::continousdistribution>(std::max(size - 1, 1), 8);
+}
+
+/**
+ * tests the distributed graph of the round-robin distribution
+ */
+BOOST_AUTO_TEST_CASE(create_dist_graph_round_robin){
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    check_dist_graph<environment::nestdistribution>(10*size + size/2, 4);
+}
+#endif
+
 /**
  * for queueing::pool and spike::environment
  * test that run sim function results in the expected end state
@@ -26,14 +26,18 @@
 
 #define BOOST_TEST_MODULE KernelTest
 #include <vector>
+#include <cmath>
 
 #include <boost/test/unit_test.hpp>
 #include <boost/test/test_case_template.hpp>
 #include <boost/filesystem.hpp>
 
 #include "coreneuron_1.0/kernel/kernel.h" // signature kernel application
+#include "coreneuron_1.0/common/util/simd.h" // vectorized exp
 #include "neuromapp/coreneuron_1.0/common/data/path.h" // this file is generated automatically
 #include "coreneuron_1.0/common/data/helper.h" // common functionalities
+#include "coreneuron_1.0/kernel/mechanism/registry.h"
+#include "coreneuron_1.0/common/util/nrnthread_handler.h"
 #include "utils/error.h"
 
 namespace bfs = ::boost::filesystem;
@@ -86,6 +90,32 @@ BOOST_AUTO_TEST_CASE(helper_solver_test){
     BOOST_CHECK(error==mapp::MAPP_BAD_ARG);
 }
 
+BOOST_AUTO_TEST_CASE(helper_exclusive_options_test){
+    std::vector<std::string> command_v;
+    command_v.push_back("coreneuron10_kernel_execute"); // dummy argument to be compliant with getopt
+    command_v.push_back("--simd");
+    command_v.push_back("--template");
+    int error = mapp::execute(command_v,coreneuron10_kernel_execute);
+    BOOST_CHECK(error==mapp::MAPP_BAD_ARG);
+
+    // the C kernels do not know the AoSoA layout
+    command_v.clear();
+    command_v.push_back("coreneuron10_kernel_execute"); // dummy argument to be compliant with getopt
+    command_v.push_back("--block");
+    command_v.push_back("8");
+    error = mapp::execute(command_v,coreneuron10_kernel_execute);
+    BOOST_CHECK(error==mapp::MAPP_BAD_ARG);
+
+    // unsupported block size
+    command_v.clear();
+    command_v.push_back("coreneuron10_kernel_execute"); // dummy argument to be compliant with getopt
+    command_v.push_back("--template");
+    command_v.push_back("--block");
+    command_v.push_back("5");
+    error = mapp::execute(command_v,coreneuron10_kernel_execute);
+    BOOST_CHECK(error==mapp::MAPP_BAD_ARG);
+}
+
 BOOST_AUTO_TEST_CASE(kernels_test){
     bfs::path p(mapp::data_test());
     bool b = bfs::exists(p);
@@ -172,3 +202,141 @@ BOOST_AUTO_TEST_CASE(kernels_reference_solution_test){
         mapp::helper_check(command_v[8],mechanisms[i],path);
     }
 }
+
+/** run state then current for every mechanism with the extra options and compare to the reference */
+void kernels_reference_solution(std::string const& storage, std::vector<std::string> const& options){
+    bfs::path p(mapp::data_test());
+    bool b = bfs::exists(p);
+    BOOST_CHECK(b); //data ready, live or die
+
+    std::string name("coreneuron_1.0_kernel_data");
+    std::string path(mapp::data_test());
+
+    std::string mechanisms[3] = {"Na","Ih","ProbAMPANMDA"};
+    std::string functors[2] = {"state","current"};
+
+    std::vector<std::string> command_v;
+    command_v.push_back("coreneuron10_kernel_execute");
+    command_v.push_back("--mechanism");
+    command_v.push_back("mechanism");
+    command_v.push_back("--function");
+    command_v.push_back("functor");
+    command_v.push_back("--data");
+    command_v.push_back(path);
+    command_v.push_back("--name");
+    command_v.push_back("dummy");
+    command_v.insert(command_v.end(), options.begin(), options.end());
+
+    int error = mapp::MAPP_OK;
+
+    for(size_t i(0); i < 3 ;++i){
+        command_v[0] = name;
+        command_v[2] = mechanisms[i];
+        command_v[4] = functors[0];
+        command_v[8] = storage+mechanisms[i];
+
+        error = mapp::execute(command_v,coreneuron10_kernel_execute);
+        BOOST_CHECK(error==mapp::MAPP_OK);
+        command_v[4] = functors[1];
+        error = mapp::execute(command_v,coreneuron10_kernel_execute);
+        BOOST_CHECK(error==mapp::MAPP_OK);
+        mapp::helper_check(command_v[8],mechanisms[i],path);
+    }
+}
+
+// the split between the threads must give the same solution than the serial version
+BOOST_AUTO_TEST_CASE(kernels_parallel_reference_solution_test){
+    std::vector<std::string> options;
+    options.push_back("--numthread");
+    options.push_back("4");
+    kernels_reference_solution("internal_parallel_storage_name_", options);
+}
+
+BOOST_AUTO_TEST_CASE(kernels_simd_reference_solution_test){
+    std::vector<std::string> options;
+    options.push_back("--simd");
+    kernels_reference_solution("internal_simd_storage_name_", options);
+}
+
+BOOST_AUTO_TEST_CASE(kernels_parallel_simd_reference_solution_test){
+    std::vector<std::string> options;
+    options.push_back("--simd");
+    options.push_back("--numthread");
+    options.push_back("3");
+    kernels_reference_solution("internal_parallel_simd_storage_name_", options);
+}
+
+BOOST_AUTO_TEST_CASE(kernels_template_reference_solution_test){
+    std::vector<std::string> options;
+    options.push_back("--template");
+    kernels_reference_solution("internal_template_storage_name_", options);
+}
+
+BOOST_AUTO_TEST_CASE(kernels_parallel_template_reference_solution_test){
+    std::vector<std::string> options;
+    options.push_back("--template");
+    options.push_back("--numthread");
+    options.push_back("4");
+    kernels_reference_solution("internal_parallel_template_storage_name_", options);
+}
+
+// the AoSoA layout must give the same data as the SoA layout, the ions included
+BOOST_AUTO_TEST_CASE(kernels_aosoa_reference_solution_test){
+    std::string mechanisms[3] = {"Na","Ih","ProbAMPANMDA"};
+    std::vector<std::string> soa;
+    soa.push_back("--template");
+    soa.push_back("--numthread");
+    soa.push_back("2");
+    kernels_reference_solution("internal_aosoa_soa_storage_name_", soa);
+
+    const char* blocks[3] = {"4", "8", "16"};
+    for(int b=0; b < 3; ++b){
+        std::vector<std::string> options(soa);
+        options.push_back("--block");
+        options.push_back(blocks[b]);
+        std::string storage = std::string("internal_aosoa_storage_name_")+blocks[b];
+        kernels_reference_solution(storage, options);
+        for(int i=0; i < 3; ++i)
+            mapp::helper_check_data(storage+mechanisms[i], "internal_aosoa_soa_storage_name_"+mechanisms[i],
+                                    mapp::data_test());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(simd_exp_test){
+    double x[MAPP_SIMD_WIDTH], y[MAPP_SIMD_WIDTH];
+    for(double v = -700.; v < 700.; v += 0.37){
+        for(int i=0; i < MAPP_SIMD_WIDTH; ++i)
+            x[i] = v + 0.01*i;
+        mapp_simd_store(y, mapp_simd_exp(mapp_simd_load(x)));
+        for(int i=0; i < MAPP_SIMD_WIDTH; ++i)
+            BOOST_CHECK_CLOSE(y[i], std::exp(x[i]), 1e-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(registry_test){
+    const mech_kernels* k = mech_find(MECH_TYPE_IH);
+    BOOST_REQUIRE(k != NULL);
+    BOOST_CHECK_EQUAL(std::string(k->name), "Ih");
+    BOOST_CHECK(k->net_receive == NULL);
+    BOOST_CHECK(k->current_chunk == mech_current_Ih_chunk);
+
+    k = mech_find_name("Na");
+    BOOST_REQUIRE(k != NULL);
+    BOOST_CHECK_EQUAL(k->type, MECH_TYPE_NATS2_T);
+    BOOST_CHECK(mech_find_name("ProbAMPANMDA")->net_receive == mech_net_receive);
+    BOOST_CHECK(mech_find_name("Kv3_1") == NULL);
+    BOOST_CHECK(mech_find(3) == NULL);
+
+    // a type is registered once
+    BOOST_CHECK(mech_register(mech_find(MECH_TYPE_IH)) == mapp::MAPP_BAD_ARG);
+
+    // the dataset has the three mechanisms
+    std::string path(mapp::data_test());
+    NrnThread* nt = (NrnThread*) make_nrnthread((void*)path.c_str());
+    BOOST_REQUIRE(nt != NULL);
+    BOOST_CHECK(nrnthread_mechanism(nt, MECH_TYPE_NATS2_T) == &nt->ml[17]);
+    BOOST_CHECK(nrnthread_mechanism(nt, MECH_TYPE_IH) == &nt->ml[10]);
+    BOOST_CHECK(nrnthread_mechanism(nt, MECH_TYPE_PROBAMPANMDA_EMS) == &nt->ml[18]);
+    BOOST_CHECK(nrnthread_mechanism(nt, 1000) == NULL);
+    free_nrnthread(nt);
+}
@@ -0,0 +1,280 @@
+/*
+ * Neuromapp - nrnthread.cpp, Copyright (c), 2015,
+ * Timothee Ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/test/coreneuron_1.0/nrnthread.cpp
+ *  Test on the NrnThread input formats
+ */
+
+#define BOOST_TEST_MODULE NrnThreadTest
+#include <vector>
+#include <cstdio>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+extern "C" {
+#include "coreneuron_1.0/common/memory/nrnthread.h"
+#include "coreneuron_1.0/common/memory/permute.h"
+#include "coreneuron_1.0/common/util/nrnthread_handler.h"
+}
+
+#include "neuromapp/coreneuron_1.0/common/data/path.h" // this file is generated automatically
+#include "coreneuron_1.0/common/data/helper.h" // common functionalities
+#include "utils/error.h"
+
+namespace bfs = ::boost::filesystem;
+
+/** helper to compare two arrays element by element */
+template<class T>
+void check_array(const T* a, const T* b, int n){
+    for(int i=0; i < n; ++i)
+        BOOST_REQUIRE_EQUAL(a[i], b[i]);
+}
+
+BOOST_AUTO_TEST_CASE(binary_round_trip_test){
+    bfs::path p(mapp::data_test());
+    BOOST_REQUIRE(bfs::exists(p)); //data ready, live or die
+
+    std::string text(mapp::data_test());
+    std::string binary((bfs::temp_directory_path() / bfs::unique_path()).string());
+
+    NrnThread* nt = (NrnThread*) make_nrnthread((void*)text.c_str());
+    BOOST_REQUIRE(nt != NULL);
+
+    FILE* fh = fopen(text.c_str(), "rb");
+    BOOST_CHECK(nrnthread_is_binary(fh) == 0);
+    fclose(fh);
+
+    fh = fopen(binary.c_str(), "wb");
+    BOOST_CHECK(nrnthread_write_binary(fh, nt) == mapp::MAPP_OK);
+    fclose(fh);
+
+    fh = fopen(binary.c_str(), "rb");
+    BOOST_CHECK(nrnthread_is_binary(fh) == 1);
+    fclose(fh);
+
+    // make_nrnthread must detect the format by itself
+    NrnThread* ntb = (NrnThread*) make_nrnthread((void*)binary.c_str());
+    BOOST_REQUIRE(ntb != NULL);
+
+    BOOST_CHECK_EQUAL(nt->_ndata, ntb->_ndata);
+    BOOST_CHECK_EQUAL(nt->end, ntb->end);
+    BOOST_CHECK_EQUAL(nt->end_pad, ntb->end_pad);
+    BOOST_CHECK_EQUAL(nt->ncell, ntb->ncell);
+    BOOST_CHECK_EQUAL(nt->_dt, ntb->_dt);
+    BOOST_CHECK_EQUAL(nt->max_nodecount, ntb->max_nodecount);
+    BOOST_REQUIRE_EQUAL(nt->nmech, ntb->nmech);
+
+    check_array(nt->_data, ntb->_data, nt->_ndata);
+    check_array(nt->_v_parent_index, ntb->_v_parent_index, nt->end_pad);
+
+    for(int i=0; i < nt->nmech; ++i){
+        Mechanism* ml = &nt->ml[i];
+        Mechanism* mlb = &ntb->ml[i];
+        BOOST_CHECK_EQUAL(ml->type, mlb->type);
+        BOOST_CHECK_EQUAL(ml->nodecount, mlb->nodecount);
+        BOOST_CHECK_EQUAL(ml->szp, mlb->szp);
+        BOOST_CHECK(ml->data - nt->_data == mlb->data - ntb->_data);
+        if(!ml->is_art)
+            check_array(ml->nodeindices, mlb->nodeindices, ml->nodecount_pad);
+        if(ml->szdp)
+            check_array(ml->pdata, mlb->pdata, ml->nodecount_pad*ml->szdp);
+    }
+
+    free_nrnthread(nt);
+    free_nrnthread(ntb);
+    bfs::remove(binary);
+}
+
+BOOST_AUTO_TEST_CASE(binary_truncated_test){
+    std::string text(mapp::data_test());
+    std::string binary((bfs::temp_directory_path() / bfs::unique_path()).string());
+
+    NrnThread* nt = (NrnThread*) make_nrnthread((void*)text.c_str());
+    BOOST_REQUIRE(nt != NULL);
+
+    FILE* fh = fopen(binary.c_str(), "wb");
+    BOOST_CHECK(nrnthread_write_binary(fh, nt) == mapp::MAPP_OK);
+    fclose(fh);
+    free_nrnthread(nt);
+
+    // drop the tail of the file, the reader must refuse it
+    bfs::resize_file(binary, bfs::file_size(binary)/2);
+    BOOST_CHECK(make_nrnthread((void*)binary.c_str()) == NULL);
+    bfs::remove(binary);
+}
+
+/** helper overwriting an int of a file at the given byte offset */
+void poke_int(const std::string& path, long offset, int value){
+    FILE* fh = fopen(path.c_str(), "r+b");
+    BOOST_REQUIRE(fh != NULL);
+    fseek(fh, offset, SEEK_SET);
+    fwrite(&value, sizeof(int), 1, fh);
+    fclose(fh);
+}
+
+BOOST_AUTO_TEST_CASE(binary_foreign_sizes_test){
+    std::string text(mapp::data_test());
+    std::string binary((bfs::temp_directory_path() / bfs::unique_path()).string());
+    std::string copy((bfs::temp_directory_path() / bfs::unique_path()).string());
+
+    NrnThread* nt = (NrnThread*) make_nrnthread((void*)text.c_str());
+    BOOST_REQUIRE(nt != NULL);
+    FILE* fh = fopen(binary.c_str(), "wb");
+    BOOST_CHECK(nrnthread_write_binary(fh, nt) == mapp::MAPP_OK);
+    fclose(fh);
+    const int ndata = nt->_ndata;
+    free_nrnthread(nt);
+
+    // header: magic[8], version, _ndata, end, end_pad, nmech, ncell, _dt
+    // then _data and the meta data of the first mechanism {type, is_art, nodecount, nodecount_pad, ...}
+    const long ndata_at = 12, end_at = 16, nmech_at = 24;
+    const long nodecount_pad_at = 40 + ndata*sizeof(double) + 3*sizeof(int);
+    const long fields[4] = {ndata_at, end_at, nmech_at, nodecount_pad_at};
+    const int values[3] = {1 << 30, -1, 1 << 29};
+    for(int f = 0; f < 4; ++f){
+        for(int v = 0; v < 3; ++v){
+            bfs::copy_file(binary, copy, bfs::copy_option::overwrite_if_exists);
+            poke_int(copy, fields[f], values[v]);
+            // an error as the truncated file, no huge allocation
+            BOOST_CHECK(make_nrnthread((void*)copy.c_str()) == NULL);
+        }
+    }
+    bfs::remove(copy);
+    bfs::remove(binary);
+}
+
+BOOST_AUTO_TEST_CASE(aosoa_transposition_test){
+    std::string text(mapp::data_test());
+    NrnThread* nt = (NrnThread*) make_nrnthread((void*)text.c_str());
+    BOOST_REQUIRE(nt != NULL);
+    // a second read, a clone does not place the mechanisms at the same offsets than the reader
+    NrnThread* ref = (NrnThread*) make_nrnthread((void*)text.c_str());
+    BOOST_REQUIRE(ref != NULL);
+
+    BOOST_CHECK(nrnthread_block(nt, 3) == mapp::MAPP_BAD_ARG);
+
+    const int blocks[3] = {4, 8, 16};
+    for(int b=0; b < 3; ++b){
+        BOOST_REQUIRE(nrnthread_block(nt, blocks[b]) == mapp::MAPP_OK);
+        int nsoa = 0;
+        for(int i=0; i < nt->nmech; ++i){
+            Mechanism* ml = &nt->ml[i];
+            Mechanism* mlr = &ref->ml[i];
+            // the ions, written by the other mechanisms through pdata, stay SoA
+            if(ml->block == 0){
+                ++nsoa;
+                BOOST_CHECK(ml->data - nt->_data == mlr->data - ref->_data);
+                check_array(ml->data, mlr->data, ml->szp*ml->nodecount);
+                continue;
+            }
+            BOOST_REQUIRE_EQUAL(ml->block, blocks[b]);
+            for(int k=0; k < ml->szp; ++k)
+                for(int j=0; j < ml->nodecount; ++j)
+                    BOOST_REQUIRE_EQUAL(ml->data[NRN_AOSOA_INDEX(k, j, ml->block, ml->szp)],
+                                        mlr->data[k*mlr->nodecount + j]);
+        }
+        BOOST_CHECK(nsoa > 0);
+        BOOST_CHECK(nsoa < nt->nmech);
+
+        // a clone keeps the layout
+        NrnThread* clone = (NrnThread*) clone_nrnthread(nt);
+        BOOST_CHECK_EQUAL(clone->ml[18].block, blocks[b]);
+        BOOST_CHECK_EQUAL(clone->ml[18].data[NRN_AOSOA_INDEX(20, 5, blocks[b], clone->ml[18].szp)],
+                          ref->ml[18].data[20*ref->ml[18].nodecount + 5]);
+        free_nrnthread(clone);
+
+        // only the SoA layout is serialized
+        FILE* fh = tmpfile();
+        BOOST_CHECK(nrnthread_write_binary(fh, nt) == mapp::MAPP_BAD_DATA);
+        fclose(fh);
+    }
+
+    // back to SoA, nothing changed
+    BOOST_REQUIRE(nrnthread_block(nt, 0) == mapp::MAPP_OK);
+    check_array(nt->_data, ref->_data, nt->_ndata);
+    for(int i=0; i < nt->nmech; ++i){
+        BOOST_CHECK_EQUAL(nt->ml[i].block, 0);
+        BOOST_CHECK(nt->ml[i].data - nt->_data == ref->ml[i].data - ref->_data);
+    }
+
+    free_nrnthread(nt);
+    free_nrnthread(ref);
+}
+
+BOOST_AUTO_TEST_CASE(permutation_test){
+    std::string text(mapp::data_test());
+    NrnThread* nt = (NrnThread*) make_nrnthread((void*)text.c_str());
+    BOOST_REQUIRE(nt != NULL);
+    NrnThread* ref = (NrnThread*) make_nrnthread((void*)text.c_str());
+    BOOST_REQUIRE(ref != NULL);
+
+    BOOST_CHECK(nt->_permute == NULL);
+    BOOST_CHECK(nrnthread_permute(nt, 7) == mapp::MAPP_BAD_ARG);
+    BOOST_CHECK_EQUAL(nrnthread_permute_kind("cell"), NRN_PERMUTE_CELL);
+    BOOST_CHECK_EQUAL(nrnthread_permute_kind("random"), -1);
+
+    const int kinds[3] = {NRN_PERMUTE_CELL, NRN_PERMUTE_INTERLEAVE, NRN_PERMUTE_LANE};
+    for(int k=0; k < 3; ++k){
+        BOOST_REQUIRE(nrnthread_permute(nt, kinds[k]) == mapp::MAPP_OK);
+        const int* perm = nt->_permute;
+        BOOST_REQUIRE(perm != NULL);
+
+        // a bijection, roots fixed, parents first
+        std::vector<int> seen(nt->end, 0);
+        for(int i=0; i < nt->end; ++i)
+            seen[perm[i]]++;
+        for(int i=0; i < nt->end; ++i)
+            BOOST_REQUIRE_EQUAL(seen[i], 1);
+        for(int i=0; i < nt->ncell; ++i)
+            BOOST_REQUIRE_EQUAL(perm[i], i);
+        for(int i=nt->ncell; i < nt->end; ++i){
+            BOOST_REQUIRE(nt->_v_parent_index[i] < i);
+            BOOST_REQUIRE_EQUAL(nt->_v_parent_index[perm[i]], perm[ref->_v_parent_index[i]]);
+            BOOST_REQUIRE_EQUAL(nt->_actual_v[perm[i]], ref->_actual_v[i]);
+        }
+        for(int i=0; i < nt->nmech; ++i)
+            if(!nt->ml[i].is_art)
+                for(int j=0; j < nt->ml[i].nodecount; ++j)
+                    BOOST_REQUIRE_EQUAL(nt->ml[i].nodeindices[j], perm[ref->ml[i].nodeindices[j]]);
+
+        // a clone keeps the permutation
+        NrnThread* clone = (NrnThread*) clone_nrnthread(nt);
+        check_array(clone->_permute, nt->_permute, nt->end);
+        free_nrnthread(clone);
+    }
+
+    // back to the original numbering, nothing changed
+    BOOST_REQUIRE(nrnthread_unpermute(nt) == mapp::MAPP_OK);
+    BOOST_CHECK(nt->_permute == NULL);
+    check_array(nt->_data, ref->_data, nt->_ndata);
+    check_array(nt->_v_parent_index, ref->_v_parent_index, nt->end_pad);
+    for(int i=0; i < nt->nmech; ++i){
+        Mechanism* ml = &nt->ml[i];
+        if(!ml->is_art)
+            check_array(ml->nodeindices, ref->ml[i].nodeindices, ml->nodecount);
+        if(ml->szdp)
+            check_array(ml->pdata, ref->ml[i].pdata, ml->nodecount*ml->szdp);
+    }
+
+    free_nrnthread(nt);
+    free_nrnthread(ref);
+}
@@ -30,6 +30,8 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <vector>
+#include <iterator>
 
 #include <boost/mpl/list.hpp>
 #include <boost/test/unit_test.hpp>
@@ -37,8 +39,11 @@
 
 #include "coreneuron_1.0/queue/queue.h"
 #include "coreneuron_1.0/queue/tool/priority_queue.hpp"
+#include "coreneuron_1.0/queue/parallel_benchmark.h"
+#include "coreneuron_1.0/queue/tool/concurrent_bin_queue.hpp"
 #include "coreneuron_1.0/common/data/helper.h" // common functionalities
 #include "utils/error.h"
+#include "utils/omp/compatibility.h"
 
 //Test only MH, not std or boost, captain obvious
 typedef boost::mpl::list<tool::sptq_queue<int,std::greater<int> >,
@@ -204,3 +209,246 @@ BOOST_AUTO_TEST_CASE(helper_solver_test){
 
 
 
+
+BOOST_AUTO_TEST_CASE(bin_queue_pop_bin) {
+    tool::bin_queue<double> queue(1.);
+    queue.push(3.5);
+    queue.push(1.2);
+    queue.push(1.7);
+    queue.push(2.);
+
+    // the two elements of [1,2), no specific order into a bin
+    tool::bin_queue<double>::node_type* n = queue.pop_bin();
+    BOOST_REQUIRE(n != 0);
+    BOOST_REQUIRE(n->left_ != 0);
+    BOOST_CHECK(n->left_->left_ == 0);
+    BOOST_CHECK_CLOSE(n->t_ + n->left_->t_, 2.9, 1e-10);
+    delete n->left_;
+    delete n;
+
+    BOOST_CHECK_EQUAL(queue.size(), 2);
+    BOOST_CHECK_EQUAL(queue.top(), 2.);
+}
+
+BOOST_AUTO_TEST_CASE(bin_queue_advance) {
+    tool::bin_queue<double> queue(1.);
+    // a hold model: every popped time is pushed back 10 steps later
+    for(int i = 0; i < 10; ++i)
+        queue.push(i);
+    for(int t = 0; t < 100000; ++t) {
+        BOOST_REQUIRE_EQUAL(queue.top(), (double)t);
+        queue.pop();
+        queue.push(t + 10);
+        queue.advance(t);
+    }
+    // the bins follow the origin, they do not grow with the time
+    BOOST_CHECK_EQUAL(queue.nbins(), 1024);
+    BOOST_CHECK_EQUAL(queue.size(), 10);
+
+    // before the origin, in the first bin
+    queue.push(3.);
+    BOOST_CHECK_EQUAL(queue.top(), 3.);
+    queue.pop();
+    BOOST_CHECK_EQUAL(queue.top(), 100000.);
+}
+
+BOOST_AUTO_TEST_CASE(sptq_pool_allocator_test) {
+    typedef tool::sptq_pool_allocator<double, 4> allocator_type;
+    allocator_type alloc;
+    // more nodes than a slab
+    std::vector<allocator_type::node_type*> nodes;
+    for(int i = 0; i < 10; ++i)
+        nodes.push_back(alloc.allocate(i));
+    for(int i = 0; i < 10; ++i)
+        BOOST_CHECK_EQUAL(nodes[i]->t_, i);
+    // a released node is reused first, reset
+    allocator_type::node_type* n = nodes[3];
+    alloc.deallocate(n);
+    allocator_type::node_type* m = alloc.allocate(42.);
+    BOOST_CHECK(m == n);
+    BOOST_CHECK_EQUAL(m->t_, 42.);
+    BOOST_CHECK(m->parent_ == 0 && m->left_ == 0 && m->right_ == 0);
+
+    // the pooled queue sorts as the original one
+    tool::sptq_queue<double, std::greater<double> > original;
+    tool::sptq_queue<double, std::greater<double>, tool::sptq_pool_allocator<double, 8> > pooled;
+    for(int k = 0; k < 3; ++k){
+        for(int i = 0; i < 100; ++i){
+            double value = (i*37) % 101;
+            original.push(value);
+            pooled.push(value);
+        }
+        BOOST_REQUIRE_EQUAL(original.size(), pooled.size());
+        while(!original.empty()){
+            BOOST_REQUIRE_EQUAL(original.top(), pooled.top());
+            original.pop();
+            pooled.pop();
+        }
+        BOOST_CHECK(pooled.empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sptq_push_range_pop_until) {
+    tool::sptq_queue<double, std::greater<double>, tool::sptq_pool_allocator<double> > queue;
+    std::vector<double> values;
+    for(int i = 0; i < 20; ++i)
+        values.push_back((i*7) % 20);
+    queue.push_range(values.begin(), values.end());
+    BOOST_CHECK_EQUAL(queue.size(), 20);
+
+    // the elements up to 4.5, in the order of the queue
+    std::vector<double> out;
+    BOOST_CHECK_EQUAL(queue.pop_until(4.5, std::back_inserter(out)), 5);
+    BOOST_REQUIRE_EQUAL(out.size(), 5);
+    for(int i = 0; i < 5; ++i)
+        BOOST_CHECK_EQUAL(out[i], i);
+    BOOST_CHECK_EQUAL(queue.size(), 15);
+    BOOST_CHECK_EQUAL(queue.top(), 5.);
+
+    // the limit is included
+    BOOST_CHECK_EQUAL(queue.pop_until(7.), 3);
+    BOOST_CHECK_EQUAL(queue.top(), 8.);
+    BOOST_CHECK_EQUAL(queue.pop_until(-1.), 0);
+    BOOST_CHECK_EQUAL(queue.pop_until(100.), 12);
+    BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram_test) {
+    queue::latency_histogram h;
+    h.add(0);
+    h.add(1);
+    h.add(3);
+    h.add(4);
+    h.add(100);
+    BOOST_CHECK_EQUAL(h.count(), 5);
+    BOOST_CHECK_EQUAL(h[0], 2); // [0,2)
+    BOOST_CHECK_EQUAL(h[1], 1); // [2,4)
+    BOOST_CHECK_EQUAL(h[2], 1); // [4,8)
+    BOOST_CHECK_EQUAL(h[6], 1); // [64,128)
+    BOOST_CHECK_CLOSE(h.mean(), 108./5., 1e-10);
+    BOOST_CHECK_EQUAL(h.percentile(0.5), 4);
+    BOOST_CHECK_EQUAL(h.percentile(1.), 128);
+}
+
+struct hold_bin_queue{ // as helper_type of trait.h, defined by the queue library
+    typedef tool::bin_queue<double> value_type;
+};
+
+BOOST_AUTO_TEST_CASE(hold_model_test) {
+    // every event popped generates an event pushed, in the same step
+    for(int law = queue::uniform; law <= queue::bursty; ++law){
+        queue::latency_histogram push, pop;
+        double time = queue::hold_helper::benchmark<hold_bin_queue>(32, 2,
+                          static_cast<queue::distributions>(law), push, pop);
+        BOOST_CHECK(time > 0.);
+        BOOST_CHECK(pop.count() > 0);
+        BOOST_CHECK_EQUAL(push.count(), pop.count());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_bin_queue_test) {
+    // 8 bins of 1 step, the steps 0 to 7 in the ring
+    tool::concurrent_bin_queue<double> queue(1., 8);
+    BOOST_CHECK(queue.empty());
+    queue.push(3.);
+    queue.push(1.);
+    queue.push(20.); // beyond the ring, overflow
+    queue.push(1.);
+    BOOST_CHECK_EQUAL(queue.size(), 4);
+
+    std::vector<double> out;
+    BOOST_CHECK_EQUAL(queue.pop_until(2., std::back_inserter(out)), 2);
+    BOOST_REQUIRE_EQUAL(out.size(), 2);
+    BOOST_CHECK_EQUAL(out[0], 1.);
+    BOOST_CHECK_EQUAL(out[1], 1.);
+
+    // the bins of 0 to 2 are drained, late events
+    queue.push(2.);
+    queue.push(0.);
+    out.clear();
+    BOOST_CHECK_EQUAL(queue.pop_until(3., std::back_inserter(out)), 3);
+    BOOST_REQUIRE_EQUAL(out.size(), 3);
+    BOOST_CHECK_EQUAL(out[0], 0.);
+    BOOST_CHECK_EQUAL(out[1], 2.);
+    BOOST_CHECK_EQUAL(out[2], 3.);
+
+    // the overflow comes back in the ring
+    out.clear();
+    BOOST_CHECK_EQUAL(queue.pop_until(19., std::back_inserter(out)), 0);
+    BOOST_CHECK_EQUAL(queue.pop_until(20., std::back_inserter(out)), 1);
+    BOOST_REQUIRE_EQUAL(out.size(), 1);
+    BOOST_CHECK_EQUAL(out[0], 20.);
+    BOOST_CHECK(queue.empty());
+
+    // a copy is an empty queue with the same ring
+    queue.push(25.);
+    tool::concurrent_bin_queue<double> copy(queue);
+    BOOST_CHECK(copy.empty());
+    BOOST_CHECK_EQUAL(copy.nbins(), 8);
+}
+
+namespace {
+    /** an event whose time is read through a pointer: the time changes between the push
+        and the redistribution of the overflow, as for a push racing with the owner */
+    struct moving_event{
+        const double* time;
+    };
+
+    inline double time_of(const moving_event& e){ // found by ADL
+        return *e.time;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_bin_queue_late_redistribution) {
+    // an overflow event redistributed onto a drained step is popped by the final drain
+    tool::concurrent_bin_queue<moving_event> queue(1., 8);
+    double time = 20.; // beyond the ring, overflow
+    moving_event e = {&time};
+    queue.push(e);
+
+    std::vector<moving_event> out;
+    BOOST_CHECK_EQUAL(queue.pop_until(3., std::back_inserter(out)), 0);
+
+    time = 1.; // the step 1 is drained, the redistribution links the event late
+    BOOST_CHECK_EQUAL(queue.pop_until(1000., std::back_inserter(out)), 1);
+    BOOST_CHECK_EQUAL(out.size(), 1);
+    BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_bin_queue_producers) {
+    // the producers push while the owner pops, every event popped once, when due
+    tool::concurrent_bin_queue<double> queue(1., 16);
+    const int n = 10000;
+    const int delay = 12;
+    int done = 0;
+    int nproducers = 0;
+    long popped = 0;
+    bool late = false;
+
+    #pragma omp parallel num_threads(4)
+    {
+        if(omp_get_thread_num() == 0){
+            std::vector<double> out;
+            double t = 0.;
+            while(__sync_fetch_and_add(&done, 0) < omp_get_num_threads() - 1){
+                out.clear();
+                popped += queue.pop_until(t, std::back_inserter(out));
+                for(size_t i = 0; i < out.size(); ++i)
+                    late = late || out[i] > t;
+                t += 1.;
+            }
+            nproducers = omp_get_num_threads() - 1;
+        }
+        else{
+            for(int i = 0; i < n; ++i)
+                queue.push(static_cast<double>(i % 1000 + i % delay));
+            __sync_fetch_and_add(&done, 1);
+        }
+    }
+    std::vector<double> rest;
+    popped += queue.pop_until(1e6, std::back_inserter(rest));
+
+    BOOST_CHECK(!late);
+    BOOST_CHECK_EQUAL(popped, static_cast<long>(nproducers)*n);
+    BOOST_CHECK(queue.empty());
+}
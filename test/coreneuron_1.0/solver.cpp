@@ -34,6 +34,10 @@
 
 #include "coreneuron_1.0/solver/solver.h" // signature kernel application
 #include "coreneuron_1.0/solver/hines.h" // to call the solver library's API directly
+extern "C" {
+#include "coreneuron_1.0/common/memory/permute.h"
+#include "coreneuron_1.0/common/util/nrnthread_handler.h"
+}
 
 #include "neuromapp/coreneuron_1.0/common/data/path.h" // this file is generated automatically
 #include "coreneuron_1.0/common/data/helper.h" // common functionalities
@@ -89,6 +93,91 @@ BOOST_AUTO_TEST_CASE(solver_test){
     BOOST_CHECK(num==0);
 }
 
+BOOST_AUTO_TEST_CASE(permuted_solver_test){
+    std::string path(mapp::data_test());
+    NrnThread* ref = (NrnThread*) make_nrnthread((void*)path.c_str());
+    BOOST_REQUIRE(ref != NULL);
+    nrn_solve_minimal(ref);
+
+    const int kinds[2] = {NRN_PERMUTE_CELL, NRN_PERMUTE_INTERLEAVE};
+    for(int k=0; k < 2; ++k){
+        NrnThread* nt = (NrnThread*) make_nrnthread((void*)path.c_str());
+        BOOST_REQUIRE(nt != NULL);
+        BOOST_REQUIRE(nrnthread_permute(nt, kinds[k]) == mapp::MAPP_OK);
+        nrn_solve_minimal(nt);
+        nrnthread_unpermute(nt);
+        // the children keep their order, the elimination is the same
+        for(int i=0; i < nt->end; ++i){
+            BOOST_REQUIRE_EQUAL(nt->_actual_rhs[i], ref->_actual_rhs[i]);
+            BOOST_REQUIRE_EQUAL(nt->_actual_d[i], ref->_actual_d[i]);
+        }
+        free_nrnthread(nt);
+    }
+
+    // the miniapp accepts the option
+    std::vector<std::string> command_v;
+    command_v.push_back("coreneuron10_solver_execute");
+    command_v.push_back("--data");
+    command_v.push_back(path);
+    command_v.push_back("--name");
+    command_v.push_back("coreneuron10_solver_permute");
+    command_v.push_back("--permute");
+    command_v.push_back("interleave");
+    BOOST_CHECK(mapp::execute(command_v,coreneuron10_solver_execute)==mapp::MAPP_OK);
+    command_v[6] = "random";
+    BOOST_CHECK(mapp::execute(command_v,coreneuron10_solver_execute)==mapp::MAPP_BAD_ARG);
+
+    free_nrnthread(ref);
+}
+
+BOOST_AUTO_TEST_CASE(cells_solver_test){
+    std::string path(mapp::data_test());
+    NrnThread* ref = (NrnThread*) make_nrnthread((void*)path.c_str());
+    BOOST_REQUIRE(ref != NULL);
+    nrn_solve_minimal(ref);
+
+    HinesSchedule s;
+    BOOST_CHECK(nrn_schedule_build(ref, 0, &s) == mapp::MAPP_BAD_ARG);
+
+    const int widths[4] = {1, 3, 4, 8};
+    const int kinds[2] = {NRN_PERMUTE_NONE, NRN_PERMUTE_LANE};
+    for(int k=0; k < 2; ++k){
+        for(int w=0; w < 4; ++w){
+            NrnThread* nt = (NrnThread*) make_nrnthread((void*)path.c_str());
+            BOOST_REQUIRE(nt != NULL);
+            nrnthread_permute(nt, kinds[k]);
+            BOOST_REQUIRE(nrn_schedule_build(nt, widths[w], &s) == mapp::MAPP_OK);
+            BOOST_CHECK_EQUAL(s.ngroup, (nt->ncell + widths[w] - 1)/widths[w]);
+            BOOST_CHECK_EQUAL(s.offset[s.ngroup]*widths[w] >= nt->end, true);
+            nrn_solve_cells(nt, &s);
+            nrn_schedule_free(&s);
+            nrnthread_unpermute(nt);
+            // the compartments of a cell are eliminated in the same order
+            for(int i=0; i < nt->end; ++i){
+                BOOST_REQUIRE_EQUAL(nt->_actual_rhs[i], ref->_actual_rhs[i]);
+                BOOST_REQUIRE_EQUAL(nt->_actual_d[i], ref->_actual_d[i]);
+            }
+            free_nrnthread(nt);
+        }
+    }
+
+    // the miniapp, several threads
+    std::vector<std::string> command_v;
+    command_v.push_back("coreneuron10_solver_execute");
+    command_v.push_back("--data");
+    command_v.push_back(path);
+    command_v.push_back("--name");
+    command_v.push_back("coreneuron10_solver_cells");
+    command_v.push_back("--cells");
+    command_v.push_back("--numthread");
+    command_v.push_back("4");
+    BOOST_CHECK(mapp::execute(command_v,coreneuron10_solver_execute)==mapp::MAPP_OK);
+    command_v[7] = "0";
+    BOOST_CHECK(mapp::execute(command_v,coreneuron10_solver_execute)==mapp::MAPP_BAD_ARG);
+
+    free_nrnthread(ref);
+}
+
 BOOST_AUTO_TEST_CASE(simple_matrix_solver_test){
     //smallest matrix we can represent is a 3x3
     NrnThread nt;